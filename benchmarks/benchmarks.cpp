@@ -0,0 +1,399 @@
+// Include standard headers
+#include <filesystem>
+#include <fstream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchmark_commit.h"
+#include "figures/cube_instances.h"
+#include "generators.h"
+#include "harness.h"
+#include "io/block_file.h"
+#include "io/blocks.h"
+#include "io/obj.h"
+#include "io/xyz.h"
+#include "render/buffer_arena.h"
+#include "render/chunk_bvh.h"
+#include "render/frustum.h"
+#include "schematic/sponge_schematic.h"
+#include "vboindexer.hpp"
+#include "voxel/block_editor.h"
+#include "voxel/block_palette.h"
+#include "voxel/greedy_mesher.h"
+#include "voxel/hollow.h"
+#include "voxel/lod_octree.h"
+#include "voxel/morton.h"
+#include "voxel/raycast.h"
+#include "voxel/voxel_grid.h"
+#include "voxelizer/mesh_cache.h"
+#include "voxelizer/voxelizer.h"
+
+static const std::filesystem::path PROJECT_DIR(PROJECT_SOURCE_DIR);
+
+namespace {
+
+struct Dataset {
+    std::string name;
+    std::vector<glm::ivec3> blocks;
+};
+
+voxel::VoxelGrid ToGrid(const std::vector<glm::ivec3>& blocks) {
+    voxel::VoxelGrid grid;
+    for (const glm::ivec3& block : blocks) {
+        grid.Set(block);
+    }
+    return grid;
+}
+
+void LoadBenchmarks(bench::Runner& runner, const Dataset& dataset, const std::filesystem::path& scratch) {
+    const std::string prefix = "load/" + dataset.name;
+    if (!runner.Selected(prefix)) {
+        return;
+    }
+    std::filesystem::path text   = scratch / (dataset.name + ".XYZ");
+    std::filesystem::path binary = scratch / (dataset.name + io::kBlockFileExtension);
+    io::WriteXYZ(text, dataset.blocks);
+    io::WriteBlockFile(binary, dataset.blocks);
+
+    std::vector<glm::ivec3> blocks;
+    runner.Run(prefix + "/xyz_parse", dataset.blocks.size(), "blocks", [&] { io::ReadXYZ(text, blocks); });
+    // Voxelizer output with palette indices, read back without them as xyzconvert does
+    std::filesystem::path colored = scratch / (dataset.name + "_colored.XYZ");
+    std::vector<std::uint16_t> colors(dataset.blocks.size());
+    for (std::size_t i = 0; i < colors.size(); i++) {
+        colors[i] = static_cast<std::uint16_t>(i % 16);
+    }
+    io::WriteXYZ(colored, dataset.blocks, colors);
+    runner.Run(prefix + "/xyz_parse_colored", dataset.blocks.size(), "blocks", [&] { io::ReadXYZ(colored, blocks); });
+    if (blocks != dataset.blocks) {
+        std::cout << "ERROR: " << colored << " READ BACK WITH WRONG BLOCKS\n";
+    }
+    voxel::VoxelGrid grid;
+    runner.Run(prefix + "/xyz_to_grid", dataset.blocks.size(), "blocks", [&] { io::LoadBlocks(text, grid); });
+    runner.Run(prefix + "/xyzb_to_grid", dataset.blocks.size(), "blocks", [&] { io::LoadBlocks(binary, grid); });
+    // The loader steps on their own, blocks in generator order
+    runner.Run(prefix + "/fill_grid", dataset.blocks.size(), "blocks",
+               [&] { voxel::FillGrid(grid, dataset.blocks, {}); });
+    runner.Run(prefix + "/morton_sort", dataset.blocks.size(), "blocks", [&] {
+        blocks = dataset.blocks;
+        voxel::SortMorton(blocks);
+    });
+
+    std::filesystem::remove(text);
+    std::filesystem::remove(colored);
+    std::filesystem::remove(binary);
+}
+
+void ObjBenchmarks(bench::Runner& runner, int scale, const std::filesystem::path& scratch) {
+    const std::string positions_name = "load/sphere_mesh/obj_positions";
+    const std::string corners_name   = "load/sphere_mesh/obj_corners";
+    const std::string cache_name     = "load/sphere_mesh/bvh_cache";
+    if (!runner.Selected(positions_name) && !runner.Selected(corners_name) && !runner.Selected(cache_name)) {
+        return;
+    }
+    // The voxelizer sphere written as an .obj with a normal per vertex, every face as v/vt/vn corners
+    const int rings                  = 125 * scale;
+    const voxel::Mesh mesh           = bench::SphereMesh(1.0f, rings, 2 * rings);
+    const std::filesystem::path path = scratch / "sphere_mesh.obj";
+    {
+        std::ofstream file(path);
+        for (const glm::vec3& vertex : mesh.vertices) {
+            file << "v " << vertex.x << ' ' << vertex.y << ' ' << vertex.z << '\n';
+        }
+        file << "vt 0 0\n";
+        for (const glm::vec3& vertex : mesh.vertices) {
+            file << "vn " << vertex.x << ' ' << vertex.y << ' ' << vertex.z << '\n';
+        }
+        for (const glm::uvec3& triangle : mesh.triangles) {
+            file << 'f';
+            for (int corner = 0; corner < 3; corner++) {
+                file << ' ' << triangle[corner] + 1 << "/1/" << triangle[corner] + 1;
+            }
+            file << '\n';
+        }
+    }
+
+    voxel::Mesh loaded;
+    runner.Run(positions_name, mesh.triangles.size(), "triangles", [&] { voxel::LoadObj(path, loaded); });
+    io::ObjData obj;
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    runner.Run(corners_name, mesh.triangles.size(), "triangles", [&] {
+        io::ReadObj(path, obj);
+        io::UnrollCorners(obj, vertices, uvs, normals);
+    });
+    // What voxelize --cache reads instead of the .obj
+    if (runner.Selected(cache_name)) {
+        voxel::WriteMeshCache(path, mesh, voxel::TriangleBvh(mesh));
+        voxel::TriangleBvh bvh;
+        runner.Run(cache_name, mesh.triangles.size(), "triangles", [&] { voxel::ReadMeshCache(path, loaded, bvh); });
+        std::filesystem::remove(voxel::MeshCachePath(path));
+    }
+
+    std::filesystem::remove(path);
+}
+
+void DrawPrepBenchmarks(bench::Runner& runner, const Dataset& dataset) {
+    const std::string prefix = "draw_prep/" + dataset.name;
+    if (!runner.Selected(prefix)) {
+        return;
+    }
+    voxel::VoxelGrid grid = ToGrid(dataset.blocks);
+    runner.Run(prefix + "/instance_offsets", grid.size(), "blocks",
+               [&] { std::vector<glm::vec3> offsets = figure::CubeInstances::Offsets(grid); });
+    runner.Run(prefix + "/greedy_mesh", grid.size(), "blocks",
+               [&] { voxel::BlockMesh mesh = voxel::MeshGrid(grid, voxel::MeshOptions()); });
+
+    runner.Run(prefix + "/lod_build", grid.size(), "blocks", [&] { voxel::LodOctree lod(grid); });
+
+    render::ChunkBvh bvh;
+    runner.Run(prefix + "/chunk_bvh_build", grid.chunks().size(), "chunks", [&] { bvh.Build(grid); });
+    // The viewer's camera placed at the bounding box corner, looking at the center
+    auto [lo, hi]        = grid.Bounds();
+    glm::vec3 center     = (glm::vec3(lo) + glm::vec3(hi)) * 0.5f;
+    glm::mat4 view       = glm::lookAt(glm::vec3(hi) + 4.0f, center, glm::vec3(0, 1, 0));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+    render::Frustum frustum(projection * view);
+    std::vector<std::uint32_t> visible;
+    runner.Run(prefix + "/frustum_cull", bvh.size(), "chunks", [&] { bvh.Cull(frustum, visible); });
+
+    // Vertex ranges of the packed chunk meshes placed in an arena with half of it free, then every chunk
+    // remeshed once: its range freed and a new one taken, as figure::ChunkMeshes does on upload
+    voxel::MeshOptions packed;
+    packed.packed = true;
+    std::vector<std::size_t> sizes;
+    std::size_t total = 0;
+    for (const voxel::BlockMesh& mesh : voxel::MeshEachChunk(grid, bvh.keys(), packed)) {
+        sizes.push_back(mesh.packed.size() + 1);
+        total += sizes.back();
+    }
+    std::vector<std::size_t> offsets(sizes.size());
+    runner.Run(prefix + "/arena_remesh", 2 * sizes.size(), "ranges", [&] {
+        render::RangeAllocator ranges(2 * total);
+        for (std::size_t i = 0; i < sizes.size(); i++) {
+            offsets[i] = ranges.Allocate(sizes[i]);
+        }
+        for (std::size_t i = 0; i < sizes.size(); i++) {
+            const std::size_t offset = ranges.Allocate(sizes[i]);
+            ranges.Free(offsets[i], sizes[i]);
+            offsets[i] = offset;
+        }
+    });
+}
+
+void EditBenchmarks(bench::Runner& runner, const Dataset& dataset) {
+    const std::string prefix = "edit/" + dataset.name;
+    if (!runner.Selected(prefix) || dataset.blocks.empty()) {
+        return;
+    }
+    voxel::VoxelGrid grid = ToGrid(dataset.blocks);
+    render::ChunkBvh bvh(grid);
+    voxel::BlockEditor editor(grid);
+    // Removes and restores one block: the viewer's work for a single edit, minus the upload
+    const glm::ivec3 cell = dataset.blocks[dataset.blocks.size() / 2];
+    runner.Run(prefix + "/single_block", 1, "edits", [&] {
+        if (!editor.Remove(cell)) {
+            editor.Add(cell);
+        }
+        std::vector<glm::ivec3> dirty        = editor.TakeDirtyChunks();
+        std::vector<voxel::BlockMesh> meshes = voxel::MeshEachChunk(grid, dirty, voxel::MeshOptions());
+        bvh.Update(grid, dirty);
+    });
+}
+
+void HollowBenchmarks(bench::Runner& runner, const Dataset& dataset) {
+    const std::string name = "hollow/" + dataset.name;
+    if (!runner.Selected(name) || dataset.blocks.empty()) {
+        return;
+    }
+    voxel::VoxelGrid grid = ToGrid(dataset.blocks);
+    voxel::HollowOptions options;
+    options.thickness = 2;
+    runner.Run(name, dataset.blocks.size(), "blocks", [&] { voxel::VoxelGrid shell = voxel::Hollow(grid, options); });
+}
+
+void PickBenchmarks(bench::Runner& runner, const Dataset& dataset) {
+    const std::string prefix = "pick/" + dataset.name;
+    if (!runner.Selected(prefix) || dataset.blocks.empty()) {
+        return;
+    }
+    voxel::VoxelGrid grid = ToGrid(dataset.blocks);
+    voxel::Raycaster raycaster(grid);
+    // Rays from beyond the bounding box corner towards blocks spread over the dataset, so that most of them
+    // cross empty space and chunks before they hit
+    auto [lo, hi]       = grid.Bounds();
+    const glm::vec3 eye = glm::vec3(hi) + glm::vec3(hi - lo) * 0.25f + 4.0f;
+    std::vector<voxel::Ray> rays;
+    const std::size_t step = std::max<std::size_t>(dataset.blocks.size() / 4096, 1);
+    for (std::size_t i = 0; i < dataset.blocks.size(); i += step) {
+        rays.push_back({eye, glm::vec3(dataset.blocks[i]) - eye});
+    }
+    const float max_distance = glm::length(glm::vec3(hi - lo)) * 2 + 8;
+    runner.Run(prefix + "/single", 1, "rays", [&] {
+        voxel::RayHit hit;
+        raycaster.Cast(rays[rays.size() / 2], max_distance, hit);
+    });
+    runner.Run(prefix + "/batch", rays.size(), "rays",
+               [&] { std::vector<voxel::RayHit> hits = raycaster.CastBatch(rays, max_distance); });
+}
+
+void ExportBenchmarks(bench::Runner& runner, const Dataset& dataset, const std::filesystem::path& scratch) {
+    const std::string prefix = "export/" + dataset.name;
+    if (!runner.Selected(prefix) || dataset.blocks.empty()) {
+        return;
+    }
+    // Sixteen colors in horizontal bands, so the palette and multi-block layers are exercised
+    voxel::VoxelGrid grid;
+    for (const glm::ivec3& block : dataset.blocks) {
+        grid.Set(block, static_cast<std::uint16_t>(block.y / 4 & 15));
+    }
+    const voxel::BlockPalette palette = voxel::BlockPalette::Default();
+    auto [lo, hi]                     = grid.Bounds();
+    const glm::ivec3 size             = hi - lo + 1;
+    const std::size_t cells           = static_cast<std::size_t>(size.x) * size.y * size.z;
+    std::filesystem::path output      = scratch / (dataset.name + ".schem");
+    runner.Run(prefix + "/schem", cells, "cells", [&] { schematic::WriteSpongeSchematic(grid, palette, output); });
+    std::filesystem::remove(output);
+}
+
+void IndexBenchmarks(bench::Runner& runner, const Dataset& dataset) {
+    const std::string prefix = "index/" + dataset.name;
+    if (!runner.Selected(prefix)) {
+        return;
+    }
+    bench::Soup soup = bench::CubeSoup(dataset.blocks);
+    std::vector<unsigned int> indices;
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec3> tangents;
+    std::vector<glm::vec3> bitangents;
+    runner.Run(prefix + "/indexVBO", soup.vertices.size(), "vertices", [&] {
+        indexVBO(soup.vertices, soup.uvs, soup.normals, indices, vertices, uvs, normals);
+    });
+    runner.Run(prefix + "/indexVBO_TBN", soup.vertices.size(), "vertices", [&] {
+        indexVBO_TBN(soup.vertices, soup.uvs, soup.normals, soup.tangents, soup.bitangents, indices, vertices, uvs,
+                     normals, tangents, bitangents);
+    });
+}
+
+void VoxelizeBenchmarks(bench::Runner& runner, int scale) {
+    const std::string name         = "voxelize/sphere_mesh";
+    const std::string solid_name   = "voxelize/sphere_mesh_solid";
+    const std::string colored_name = "voxelize/sphere_mesh_palette";
+    const std::string bvh_name     = "voxelize/sphere_mesh_bvh";
+    if (!runner.Selected(name) && !runner.Selected(solid_name) && !runner.Selected(colored_name) &&
+        !runner.Selected(bvh_name)) {
+        return;
+    }
+    // About a million triangles voxelized on a 512^3 grid at scale 4
+    const int rings    = 125 * scale;
+    voxel::Mesh mesh   = bench::SphereMesh(1.0f, rings, 2 * rings);
+    voxel::VoxelizeOptions options;
+    options.block_size = 2.0f / static_cast<float>(128 * scale);
+    if (runner.Selected(name)) {
+        runner.Run(name, mesh.triangles.size(), "triangles",
+                   [&] { std::vector<glm::ivec3> cells = voxel::Voxelize(mesh, options); });
+    }
+    if (runner.Selected(solid_name)) {
+        voxel::VoxelizeOptions solid = options;
+        solid.solid                  = true;
+        runner.Run(solid_name, mesh.triangles.size(), "triangles",
+                   [&] { std::vector<glm::ivec3> cells = voxel::Voxelize(mesh, solid); });
+    }
+    if (runner.Selected(bvh_name)) {
+        voxel::TriangleBvh bvh;
+        runner.Run(bvh_name + "/build", mesh.triangles.size(), "triangles", [&] { bvh.Build(mesh); });
+        voxel::VoxelizeOptions with_bvh = options;
+        with_bvh.bvh                    = &bvh;
+        runner.Run(bvh_name, mesh.triangles.size(), "triangles",
+                   [&] { std::vector<glm::ivec3> cells = voxel::Voxelize(mesh, with_bvh); });
+        with_bvh.solid = true;
+        runner.Run(bvh_name + "_solid", mesh.triangles.size(), "triangles",
+                   [&] { std::vector<glm::ivec3> cells = voxel::Voxelize(mesh, with_bvh); });
+    }
+    if (!runner.Selected(colored_name)) {
+        return;
+    }
+
+    // Same sphere with a color gradient over its vertices, mapped to dithered concrete blocks
+    for (const glm::vec3& vertex : mesh.vertices) {
+        mesh.vertex_colors.push_back(vertex * 0.5f + 0.5f);
+    }
+    voxel::BlockPalette palette = voxel::BlockPalette::Default();
+    palette.set_dither(0.1f);
+    options.palette = &palette;
+    runner.Run(colored_name, mesh.triangles.size(), "triangles", [&] {
+        std::vector<std::uint16_t> colors;
+        std::vector<glm::ivec3> cells = voxel::Voxelize(mesh, options, &colors);
+    });
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    std::filesystem::path output;
+    int warmup      = 1;
+    int repetitions = 5;
+    int scale       = 4;
+    std::string filter;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag(argv[i]);
+        if (flag == "--out") {
+            output = argv[i + 1];
+        } else if (flag == "--warmup") {
+            warmup = std::stoi(argv[i + 1]);
+        } else if (flag == "--reps") {
+            repetitions = std::stoi(argv[i + 1]);
+        } else if (flag == "--scale") {
+            scale = std::stoi(argv[i + 1]);
+        } else if (flag == "--filter") {
+            filter = argv[i + 1];
+        } else {
+            std::cout << "ERROR: UNKNOWN FLAG " << flag << '\n';
+            return -2;
+        }
+    }
+    if (argc % 2 == 0 || repetitions < 1 || warmup < 0 || scale < 1) {
+        std::cout <<
+            R"(ERROR: Wrong arguments
+usage:
+    benchmarks [--out results.json] [--warmup 1] [--reps 5] [--scale 4] [--filter name_part])";
+        return -2;
+    }
+
+    // Sizes grow linearly with scale along every axis
+    std::vector<Dataset> datasets = {
+        {"solid_cube", bench::SolidCube(32 * scale)},
+        {"hollow_sphere", bench::HollowSphere(48 * scale)},
+        {"noise_terrain", bench::NoiseTerrain(128 * scale, 64, 3)},
+        {"blocks_lattice", bench::TiledPattern(PROJECT_DIR / "src/blocks.XYZ", 10 * scale)},
+    };
+
+    bench::Runner runner(warmup, repetitions, filter);
+    std::filesystem::path scratch = std::filesystem::temp_directory_path();
+    for (const Dataset& dataset : datasets) {
+        LoadBenchmarks(runner, dataset, scratch);
+        DrawPrepBenchmarks(runner, dataset);
+        EditBenchmarks(runner, dataset);
+        HollowBenchmarks(runner, dataset);
+        PickBenchmarks(runner, dataset);
+        ExportBenchmarks(runner, dataset, scratch);
+    }
+    ObjBenchmarks(runner, scale, scratch);
+    // 36 soup vertices per block: keep the indexer inputs at a few million vertices
+    IndexBenchmarks(runner, {"hollow_sphere", bench::HollowSphere(12 * scale)});
+    IndexBenchmarks(runner, {"noise_terrain", bench::NoiseTerrain(16 * scale, 16, 3)});
+    VoxelizeBenchmarks(runner, scale);
+
+    runner.PrintSummary(std::cout);
+    if (!output.empty()) {
+        std::ofstream json(output);
+        runner.WriteJson(json, BENCHMARK_COMMIT);
+        std::cout << "results written to " << output.string() << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,17 @@
+# Writes OUTPUT, a header defining BENCHMARK_COMMIT as the commit checked out in SOURCE_DIR. The file is only
+# rewritten when the commit changed, so an unchanged checkout does not rebuild the benchmarks.
+execute_process(COMMAND git rev-parse --short HEAD
+                WORKING_DIRECTORY ${SOURCE_DIR}
+                OUTPUT_VARIABLE COMMIT
+                OUTPUT_STRIP_TRAILING_WHITESPACE
+                ERROR_QUIET)
+if (NOT COMMIT)
+    set(COMMIT "unknown")
+endif()
+set(CONTENT "#define BENCHMARK_COMMIT \"${COMMIT}\"\n")
+if (EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} OLD_CONTENT)
+endif()
+if (NOT CONTENT STREQUAL OLD_CONTENT)
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
@@ -0,0 +1,182 @@
+#include "generators.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "io/xyz.h"
+
+namespace {
+
+// Integer hash turned into [0, 1); std::uniform_*_distribution are implementation-defined, this is not
+float HashNoise(int x, int z, std::uint32_t seed) {
+    std::uint32_t h = seed ^ static_cast<std::uint32_t>(x) * 0x8da6b343u ^ static_cast<std::uint32_t>(z) * 0xd8163841u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return static_cast<float>(h & 0xffffff) / static_cast<float>(0x1000000);
+}
+
+float ValueNoise(float x, float z, std::uint32_t seed) {
+    int x0   = static_cast<int>(std::floor(x));
+    int z0   = static_cast<int>(std::floor(z));
+    float fx = x - static_cast<float>(x0);
+    float fz = z - static_cast<float>(z0);
+    // Smoothstep between the four lattice values
+    fx       = fx * fx * (3 - 2 * fx);
+    fz       = fz * fz * (3 - 2 * fz);
+    float a  = HashNoise(x0, z0, seed) + (HashNoise(x0 + 1, z0, seed) - HashNoise(x0, z0, seed)) * fx;
+    float b  = HashNoise(x0, z0 + 1, seed) + (HashNoise(x0 + 1, z0 + 1, seed) - HashNoise(x0, z0 + 1, seed)) * fx;
+    return a + (b - a) * fz;
+}
+
+}  // namespace
+
+std::vector<glm::ivec3> bench::SolidCube(int size) {
+    std::vector<glm::ivec3> blocks;
+    blocks.reserve(static_cast<std::size_t>(size) * size * size);
+    for (int z = 0; z < size; z++) {
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                blocks.emplace_back(x, y, z);
+            }
+        }
+    }
+    return blocks;
+}
+
+std::vector<glm::ivec3> bench::HollowSphere(int radius) {
+    std::vector<glm::ivec3> blocks;
+    const long long outer = static_cast<long long>(radius) * radius;
+    const long long inner = static_cast<long long>(radius - 1) * (radius - 1);
+    for (int z = -radius; z <= radius; z++) {
+        for (int y = -radius; y <= radius; y++) {
+            for (int x = -radius; x <= radius; x++) {
+                long long distance = static_cast<long long>(x) * x + static_cast<long long>(y) * y +
+                                     static_cast<long long>(z) * z;
+                if (distance > inner && distance <= outer) {
+                    blocks.emplace_back(x, y, z);
+                }
+            }
+        }
+    }
+    return blocks;
+}
+
+std::vector<glm::ivec3> bench::NoiseTerrain(int size, int height, std::uint32_t seed) {
+    std::vector<glm::ivec3> blocks;
+    for (int z = 0; z < size; z++) {
+        for (int x = 0; x < size; x++) {
+            float value     = 0;
+            float amplitude = 0.5f;
+            float frequency = 1.0f / 64;
+            for (int octave = 0; octave < 4; octave++) {
+                value += amplitude * ValueNoise(static_cast<float>(x) * frequency, static_cast<float>(z) * frequency,
+                                                seed + static_cast<std::uint32_t>(octave));
+                amplitude /= 2;
+                frequency *= 2;
+            }
+            int top = std::max(1, static_cast<int>(value * static_cast<float>(height)));
+            for (int y = 0; y < top; y++) {
+                blocks.emplace_back(x, y, z);
+            }
+        }
+    }
+    return blocks;
+}
+
+std::vector<glm::ivec3> bench::TiledPattern(const std::filesystem::path& pattern, int scale) {
+    std::vector<glm::ivec3> tile;
+    if (!io::ReadXYZ(pattern, tile, 1) || tile.empty()) {
+        return {};
+    }
+    glm::ivec3 lo = tile.front();
+    glm::ivec3 hi = tile.front();
+    for (const glm::ivec3& block : tile) {
+        lo = glm::min(lo, block);
+        hi = glm::max(hi, block);
+    }
+    // Keep the spacing of the pattern between copies: the smallest gap between blocks along x
+    int step = std::numeric_limits<int>::max();
+    for (const glm::ivec3& a : tile) {
+        for (const glm::ivec3& b : tile) {
+            if (b.x > a.x) {
+                step = std::min(step, b.x - a.x);
+            }
+        }
+    }
+    const glm::ivec3 period = hi - lo + (step == std::numeric_limits<int>::max() ? 1 : step);
+
+    std::vector<glm::ivec3> blocks;
+    blocks.reserve(tile.size() * scale * scale * scale);
+    for (int z = 0; z < scale; z++) {
+        for (int y = 0; y < scale; y++) {
+            for (int x = 0; x < scale; x++) {
+                for (const glm::ivec3& block : tile) {
+                    blocks.push_back(block - lo + glm::ivec3(x, y, z) * period);
+                }
+            }
+        }
+    }
+    return blocks;
+}
+
+voxel::Mesh bench::SphereMesh(float radius, int rings, int segments) {
+    constexpr float kPi = 3.14159265358979f;
+    voxel::Mesh mesh;
+    for (int ring = 0; ring <= rings; ring++) {
+        float theta = kPi * static_cast<float>(ring) / static_cast<float>(rings);
+        for (int segment = 0; segment < segments; segment++) {
+            float phi = 2 * kPi * static_cast<float>(segment) / static_cast<float>(segments);
+            mesh.vertices.emplace_back(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta),
+                                       radius * std::sin(theta) * std::sin(phi));
+        }
+    }
+    auto at = [segments](int ring, int segment) {
+        return static_cast<unsigned>(ring * segments + segment % segments);
+    };
+    for (int ring = 0; ring < rings; ring++) {
+        for (int segment = 0; segment < segments; segment++) {
+            if (ring != 0) {
+                mesh.triangles.emplace_back(at(ring, segment), at(ring, segment + 1), at(ring + 1, segment + 1));
+            }
+            if (ring != rings - 1) {
+                mesh.triangles.emplace_back(at(ring, segment), at(ring + 1, segment + 1), at(ring + 1, segment));
+            }
+        }
+    }
+    return mesh;
+}
+
+bench::Soup bench::CubeSoup(const std::vector<glm::ivec3>& blocks) {
+    // Two triangles per face: corners (0,0) (1,0) (1,1) and (0,0) (1,1) (0,1) in face (u, v) coordinates
+    constexpr int kCorners[6][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}};
+    Soup soup;
+    std::size_t count = blocks.size() * 36;
+    soup.vertices.reserve(count);
+    soup.uvs.reserve(count);
+    soup.normals.reserve(count);
+    soup.tangents.reserve(count);
+    soup.bitangents.reserve(count);
+    for (const glm::ivec3& block : blocks) {
+        for (int face = 0; face < 6; face++) {
+            const int d = face / 2;
+            glm::vec3 normal(0);
+            glm::vec3 tangent(0);
+            glm::vec3 bitangent(0);
+            normal[d]               = face % 2 == 0 ? 1.0f : -1.0f;
+            tangent[(d + 1) % 3]    = 1;
+            bitangent[(d + 2) % 3]  = 1;
+            const glm::vec3 corner0 = glm::vec3(block) - 0.5f + glm::max(normal, glm::vec3(0));
+            for (const auto& corner : kCorners) {
+                soup.vertices.push_back(corner0 + tangent * static_cast<float>(corner[0]) +
+                                        bitangent * static_cast<float>(corner[1]));
+                soup.uvs.emplace_back(corner[0], corner[1]);
+                soup.normals.push_back(normal);
+                soup.tangents.push_back(tangent);
+                soup.bitangents.push_back(bitangent);
+            }
+        }
+    }
+    return soup;
+}
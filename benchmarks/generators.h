@@ -0,0 +1,42 @@
+#ifndef BENCHMARKS_GENERATORS
+#define BENCHMARKS_GENERATORS
+
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "voxelizer/mesh.h"
+
+// Deterministic synthetic inputs: the same arguments give the same data on every platform and run
+namespace bench {
+
+// Every cell of [0, size)^3
+std::vector<glm::ivec3> SolidCube(int size);
+
+// One cell thick shell: cells whose center lies within (radius - 1, radius] of the origin
+std::vector<glm::ivec3> HollowSphere(int radius);
+
+// Columns of a size x size heightmap made of a few octaves of hashed value noise, at most `height` tall
+std::vector<glm::ivec3> NoiseTerrain(int size, int height, std::uint32_t seed);
+
+// The block pattern of `pattern` (e.g. src/blocks.XYZ) repeated scale times along every axis
+std::vector<glm::ivec3> TiledPattern(const std::filesystem::path& pattern, int scale);
+
+// UV sphere with rings * segments * 2 triangles (minus the degenerate pole ones)
+voxel::Mesh SphereMesh(float radius, int rings, int segments);
+
+// Non-indexed triangle soup of a unit cube per block, the way figure::Cube submits it, with per-face normals,
+// corner uvs, tangents and bitangents: the input indexVBO and indexVBO_TBN expect
+struct Soup {
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec3> tangents;
+    std::vector<glm::vec3> bitangents;
+};
+Soup CubeSoup(const std::vector<glm::ivec3>& blocks);
+
+}  // namespace bench
+
+#endif
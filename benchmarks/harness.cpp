@@ -0,0 +1,104 @@
+#include "harness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <utility>
+
+namespace {
+
+// Names are plain identifiers, but keep the JSON valid whatever they contain
+std::string JsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+}  // namespace
+
+double bench::Result::Percentile(double p) const {
+    if (seconds.empty()) {
+        return 0;
+    }
+    std::vector<double> sorted = seconds;
+    std::sort(sorted.begin(), sorted.end());
+    auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+double bench::Result::Mean() const {
+    if (seconds.empty()) {
+        return 0;
+    }
+    return std::accumulate(seconds.begin(), seconds.end(), 0.0) / static_cast<double>(seconds.size());
+}
+
+bench::Runner::Runner(int warmup, int repetitions, std::string filter)
+    : warmup_(warmup), repetitions_(repetitions), filter_(std::move(filter)) {}
+
+bool bench::Runner::Selected(const std::string& name) const {
+    return name.find(filter_) != std::string::npos;
+}
+
+void bench::Runner::Run(const std::string& name, std::size_t items, const std::string& item_unit,
+                        const std::function<void()>& body, const std::function<void()>& setup) {
+    if (!Selected(name)) {
+        return;
+    }
+    Result result{name, items, item_unit, {}};
+    for (int i = 0; i < warmup_ + repetitions_; i++) {
+        if (setup) {
+            setup();
+        }
+        auto start = std::chrono::steady_clock::now();
+        body();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (i >= warmup_) {
+            result.seconds.push_back(elapsed);
+        }
+    }
+    Record(std::move(result));
+}
+
+void bench::Runner::Record(Result result) {
+    std::clog << std::left << std::setw(40) << result.name << std::right << std::setw(12) << std::fixed
+              << std::setprecision(3) << result.Percentile(50) * 1000 << " ms p50\n";
+    results_.push_back(std::move(result));
+}
+
+void bench::Runner::PrintSummary(std::ostream& out) const {
+    out << std::left << std::setw(40) << "benchmark" << std::right << std::setw(12) << "p50 ms" << std::setw(12)
+        << "p90 ms" << std::setw(12) << "p99 ms" << std::setw(16) << "items/s" << '\n';
+    for (const Result& result : results_) {
+        double p50 = result.Percentile(50);
+        out << std::left << std::setw(40) << result.name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(12) << p50 * 1000 << std::setw(12) << result.Percentile(90) * 1000 << std::setw(12)
+            << result.Percentile(99) * 1000 << std::setw(16) << std::setprecision(0)
+            << (p50 > 0 ? static_cast<double>(result.items) / p50 : 0) << '\n';
+    }
+}
+
+void bench::Runner::WriteJson(std::ostream& out, const std::string& commit) const {
+    out << std::setprecision(9) << "{\n  \"commit\": " << JsonString(commit) << ",\n  \"warmup\": " << warmup_
+        << ",\n  \"repetitions\": " << repetitions_ << ",\n  \"results\": [";
+    for (std::size_t i = 0; i < results_.size(); i++) {
+        const Result& result = results_[i];
+        double p50           = result.Percentile(50);
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << JsonString(result.name)
+            << ", \"items\": " << result.items << ", \"item_unit\": " << JsonString(result.item_unit)
+            << ", \"samples\": " << result.seconds.size() << ", \"min\": " << result.Percentile(0)
+            << ", \"p50\": " << p50 << ", \"p90\": " << result.Percentile(90)
+            << ", \"p99\": " << result.Percentile(99) << ", \"max\": " << result.Percentile(100)
+            << ", \"mean\": " << result.Mean()
+            << ", \"items_per_second\": " << (p50 > 0 ? static_cast<double>(result.items) / p50 : 0) << "}";
+    }
+    out << "\n  ]\n}\n";
+}
@@ -0,0 +1,55 @@
+#ifndef BENCHMARKS_HARNESS
+#define BENCHMARKS_HARNESS
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct Result {
+    std::string name;
+    // Work items processed by one repetition (blocks, vertices, triangles...), used for throughput
+    std::size_t items;
+    std::string item_unit;
+    // Wall time of every timed repetition in seconds
+    std::vector<double> seconds;
+
+    // Nearest-rank percentile of the samples, p in [0, 100]
+    double Percentile(double p) const;
+    double Mean() const;
+};
+
+class Runner {
+private:
+    int warmup_;
+    int repetitions_;
+    std::string filter_;
+    std::vector<Result> results_;
+
+public:
+    Runner(int warmup, int repetitions, std::string filter);
+
+    // False if the name does not contain the filter string, so expensive inputs can be skipped
+    bool Selected(const std::string& name) const;
+
+    // Runs `setup` (untimed) and `body` (timed) warmup + repetitions times and records the timed samples
+    void Run(const std::string& name, std::size_t items, const std::string& item_unit,
+             const std::function<void()>& body, const std::function<void()>& setup = nullptr);
+
+    // Adds a result measured outside of Run, e.g. a stage timing reported by the code under test
+    void Record(Result result);
+
+    const std::vector<Result>& results() const { return results_; }
+
+    void PrintSummary(std::ostream& out) const;
+    // {"commit": ..., "warmup": ..., "repetitions": ..., "results": [{"name", "items", "item_unit", "samples",
+    //  "min", "p50", "p90", "p99", "max", "mean", "items_per_second"}, ...]}, times in seconds
+    void WriteJson(std::ostream& out, const std::string& commit) const;
+};
+
+}  // namespace bench
+
+#endif
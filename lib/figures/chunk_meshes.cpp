@@ -0,0 +1,96 @@
+#include "chunk_meshes.h"
+
+figure::ChunkMeshes::ChunkMeshes()
+    : vertices_(sizeof(std::uint32_t))
+    , indices_(sizeof(std::uint32_t)) {
+    glGenVertexArrays(1, &VertexArrayID_);
+    BindBuffers();
+}
+
+figure::ChunkMeshes::~ChunkMeshes() {
+    glDeleteVertexArrays(1, &VertexArrayID_);
+}
+
+std::size_t figure::ChunkMeshes::Upload(const glm::ivec3& chunk_key, const voxel::BlockMesh& mesh) {
+    if (mesh.indices.empty() || mesh.packed.empty()) {
+        Erase(chunk_key);
+        return 0;
+    }
+    // The new ranges are taken before the old ones are freed, so the upload never writes over the mesh a frame
+    // in flight may still be drawing
+    Mesh uploaded;
+    uploaded.vertices = vertices_.Allocate(mesh.packed.size());
+    uploaded.indices  = indices_.Allocate(mesh.indices.size());
+    vertices_.Write(uploaded.vertices, mesh.packed.data());
+    indices_.Write(uploaded.indices, mesh.indices.data());
+    Erase(chunk_key);
+    meshes_[chunk_key] = uploaded;
+    BindBuffers();
+    return UploadSize(mesh);
+}
+
+std::size_t figure::ChunkMeshes::UploadSize(const voxel::BlockMesh& mesh) {
+    return (mesh.packed.size() + mesh.indices.size()) * sizeof(std::uint32_t);
+}
+
+void figure::ChunkMeshes::Draw(const glm::ivec3& chunk_key, GLint origin_location) const {
+    auto it = meshes_.find(chunk_key);
+    if (it != meshes_.end()) {
+        glBindVertexArray(VertexArrayID_);
+        DrawMesh(chunk_key, it->second, origin_location);
+        glBindVertexArray(0);
+    }
+}
+
+void figure::ChunkMeshes::Draw(const std::vector<std::uint32_t>& chunks, const std::vector<glm::ivec3>& keys,
+                               GLint origin_location) const {
+    glBindVertexArray(VertexArrayID_);
+    for (std::uint32_t chunk : chunks) {
+        auto it = meshes_.find(keys[chunk]);
+        if (it != meshes_.end()) {
+            DrawMesh(keys[chunk], it->second, origin_location);
+        }
+    }
+    glBindVertexArray(0);
+}
+
+void figure::ChunkMeshes::Defragment() {
+    vertices_.Defragment();
+    indices_.Defragment();
+    BindBuffers();
+}
+
+void figure::ChunkMeshes::Erase(const glm::ivec3& chunk_key) {
+    auto it = meshes_.find(chunk_key);
+    if (it != meshes_.end()) {
+        vertices_.Free(it->second.vertices);
+        indices_.Free(it->second.indices);
+        meshes_.erase(it);
+    }
+}
+
+void figure::ChunkMeshes::BindBuffers() {
+    if (bound_vertices_ == vertices_.buffer() && bound_indices_ == indices_.buffer()) {
+        return;
+    }
+    bound_vertices_ = vertices_.buffer();
+    bound_indices_  = indices_.buffer();
+    glBindVertexArray(VertexArrayID_);
+    // A packed word reaches the shader as an integer
+    glBindBuffer(GL_ARRAY_BUFFER, bound_vertices_);
+    glEnableVertexAttribArray(0);
+    glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, 0, (void*)0);
+    // The element buffer binding is part of the VAO state
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bound_indices_);
+    glBindVertexArray(0);
+}
+
+void figure::ChunkMeshes::DrawMesh(const glm::ivec3& chunk_key, const Mesh& mesh, GLint origin_location) const {
+    if (origin_location != -1) {
+        const glm::vec3 origin(chunk_key * voxel::VoxelGrid::kChunkSize);
+        glUniform3f(origin_location, origin.x, origin.y, origin.z);
+    }
+    const std::size_t first = indices_.offset(mesh.indices) * sizeof(std::uint32_t);
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(indices_.size(mesh.indices)), GL_UNSIGNED_INT,
+                             reinterpret_cast<void*>(first), static_cast<GLint>(vertices_.offset(mesh.vertices)));
+}
@@ -0,0 +1,74 @@
+#ifndef GL_FIGURE_CHUNK_MESHES
+#define GL_FIGURE_CHUNK_MESHES
+
+// Include GLEW
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+#include "render/buffer_arena.h"
+#include "voxel/greedy_mesher.h"
+#include "voxel/voxel_grid.h"
+
+namespace figure {
+
+// The packed meshes of the chunks of a voxel::VoxelGrid, so changed chunks are remeshed and uploaded on their
+// own. Meshes usually come from a voxel::AsyncMesher and are uploaded a few per frame. All meshes share one
+// vertex array and two render::BufferArena buffers, one for vertex words and one for indices, instead of three
+// GL objects each; a chunk is drawn from its ranges with glDrawElementsBaseVertex.
+class ChunkMeshes {
+public:
+    ChunkMeshes();
+    ChunkMeshes(const ChunkMeshes&) = delete;
+    ~ChunkMeshes();
+
+    ChunkMeshes& operator=(const ChunkMeshes&) = delete;
+
+    // Replaces the mesh of one chunk, removing it if the mesh is empty. Meshes must be packed
+    // (voxel::MeshOptions::packed); others are removed too. Returns the bytes uploaded.
+    std::size_t Upload(const glm::ivec3& chunk_key, const voxel::BlockMesh& mesh);
+
+    // Bytes Upload sends to the GPU for the mesh
+    static std::size_t UploadSize(const voxel::BlockMesh& mesh);
+
+    // Draws the mesh of the chunk, if it has one. Vertices are relative to the chunk, whose origin goes to the
+    // vec3 uniform at origin_location (see PackedVertexShader.glsl); -1 leaves the uniforms alone.
+    void Draw(const glm::ivec3& chunk_key, GLint origin_location = -1) const;
+    // Draws the meshes of keys[chunk] for every chunk, binding the buffers once
+    void Draw(const std::vector<std::uint32_t>& chunks, const std::vector<glm::ivec3>& keys,
+              GLint origin_location) const;
+
+    // Moves the meshes to the front of their buffers so that the free space is in one piece
+    void Defragment();
+
+    std::size_t size() const { return meshes_.size(); }
+    render::ArenaStats vertex_stats() const { return vertices_.stats(); }
+    render::ArenaStats index_stats() const { return indices_.stats(); }
+
+private:
+    struct Mesh {
+        render::BufferArena::Handle vertices = render::BufferArena::kNoHandle;
+        render::BufferArena::Handle indices  = render::BufferArena::kNoHandle;
+    };
+
+    void Erase(const glm::ivec3& chunk_key);
+    // Points the vertex array at the arena buffers again after they moved
+    void BindBuffers();
+    void DrawMesh(const glm::ivec3& chunk_key, const Mesh& mesh, GLint origin_location) const;
+
+    GLuint VertexArrayID_;
+    render::BufferArena vertices_;
+    render::BufferArena indices_;
+    // Buffers the vertex array points at
+    GLuint bound_vertices_ = 0;
+    GLuint bound_indices_  = 0;
+    std::unordered_map<glm::ivec3, Mesh, voxel::VoxelGrid::ChunkKeyHash> meshes_;
+};
+
+}  // namespace figure
+
+#endif
@@ -17,7 +17,7 @@
 namespace figure {
 
 class Cube {
-private:
+public:
     // Our vertices. Three consecutive floats give a 3D vertex; Three
     // consecutive vertices give a triangle.
     // A cube has 6 faces with 2 triangles each, so this makes 6*2=12 triangles,
@@ -58,6 +58,10 @@ private:
         0.302f, 0.455f, 0.848f, 0.225f, 0.587f, 0.040f, 0.517f, 0.713f, 0.338f, 0.053f, 0.959f, 0.120f, 0.393f, 0.621f,
         0.362f, 0.673f, 0.211f, 0.457f, 0.820f, 0.883f, 0.371f, 0.982f, 0.099f, 0.879f};
 
+    // Number of vertices in g_vertex_buffer_data
+    static constexpr GLsizei kVertexCount = sizeof(g_vertex_buffer_data) / sizeof(GLfloat) / 3;
+
+private:
     // Vertex Array Object
     GLuint VertexArrayID_;
     GLuint vertexbuffer_;
@@ -0,0 +1,89 @@
+#include "cube_instances.h"
+
+figure::CubeInstances::CubeInstances() {
+    glGenVertexArrays(1, &VertexArrayID_);
+    glBindVertexArray(VertexArrayID_);
+
+    // The unit cube is uploaded once and shared by all instances
+    glGenBuffers(1, &vertexbuffer_);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Cube::g_vertex_buffer_data), Cube::g_vertex_buffer_data, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+    glGenBuffers(1, &colorbuffer_);
+    glBindBuffer(GL_ARRAY_BUFFER, colorbuffer_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Cube::g_color_buffer_data), Cube::g_color_buffer_data, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+    // One offset per instance instead of one per vertex
+    glGenBuffers(1, &offsetbuffer_);
+    glBindBuffer(GL_ARRAY_BUFFER, offsetbuffer_);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glVertexAttribDivisor(2, 1);
+
+    glBindVertexArray(0);
+}
+
+figure::CubeInstances::~CubeInstances() {
+    glDeleteVertexArrays(1, &VertexArrayID_);
+    glDeleteBuffers(1, &vertexbuffer_);
+    glDeleteBuffers(1, &colorbuffer_);
+    glDeleteBuffers(1, &offsetbuffer_);
+}
+
+void figure::CubeInstances::Upload(const std::vector<glm::vec3>& offsets) {
+    glBindBuffer(GL_ARRAY_BUFFER, offsetbuffer_);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(offsets.size() * sizeof(glm::vec3)), offsets.data(),
+                 GL_STATIC_DRAW);
+    instance_count_ = static_cast<GLsizei>(offsets.size());
+}
+
+std::vector<glm::vec3> figure::CubeInstances::Offsets(const voxel::VoxelGrid& blocks) {
+    std::vector<glm::vec3> offsets;
+    offsets.reserve(blocks.size());
+    blocks.ForEach([&](const glm::ivec3& cell, std::uint16_t) { offsets.emplace_back(cell); });
+    return offsets;
+}
+
+std::vector<glm::vec3> figure::CubeInstances::Offsets(const voxel::VoxelGrid& blocks,
+                                                      const std::vector<glm::ivec3>& chunk_keys,
+                                                      std::vector<DrawRange>& ranges) {
+    std::vector<glm::vec3> offsets;
+    offsets.reserve(blocks.size());
+    ranges.assign(chunk_keys.size(), DrawRange());
+    for (std::size_t i = 0; i < chunk_keys.size(); i++) {
+        ranges[i].first = static_cast<GLint>(offsets.size());
+        if (const voxel::VoxelGrid::Chunk* chunk = blocks.FindChunk(chunk_keys[i])) {
+            auto append = [&](const glm::ivec3& cell, std::uint16_t) { offsets.emplace_back(cell); };
+            voxel::VoxelGrid::ForEachInChunk(chunk_keys[i], *chunk, append);
+        }
+        ranges[i].count = static_cast<GLsizei>(offsets.size()) - ranges[i].first;
+    }
+    return offsets;
+}
+
+void figure::CubeInstances::Upload(const voxel::VoxelGrid& blocks) {
+    Upload(Offsets(blocks));
+}
+
+void figure::CubeInstances::Draw() const {
+    glBindVertexArray(VertexArrayID_);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, Cube::kVertexCount, instance_count_);
+    glBindVertexArray(0);
+}
+
+void figure::CubeInstances::Draw(const std::vector<DrawRange>& ranges) const {
+    glBindVertexArray(VertexArrayID_);
+    glBindBuffer(GL_ARRAY_BUFFER, offsetbuffer_);
+    // GL 3.3 has no base instance, so the first instance is selected through the attribute offset
+    for (const DrawRange& range : ranges) {
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0,
+                              reinterpret_cast<void*>(static_cast<std::size_t>(range.first) * sizeof(glm::vec3)));
+        glDrawArraysInstanced(GL_TRIANGLES, 0, Cube::kVertexCount, range.count);
+    }
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    glBindVertexArray(0);
+}
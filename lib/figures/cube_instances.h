@@ -0,0 +1,52 @@
+#ifndef GL_FIGURE_CUBE_INSTANCES
+#define GL_FIGURE_CUBE_INSTANCES
+
+#include <vector>
+
+// Include GLEW
+#include <GL/glew.h>
+
+#include "cube.h"
+#include "draw_range.h"
+#include "voxel/voxel_grid.h"
+
+namespace figure {
+
+// Every block of a scene drawn as an instance of one shared unit cube.
+// Attributes: 0 - cube vertex, 1 - cube vertex color, 2 - per-instance block offset.
+class CubeInstances {
+private:
+    GLuint VertexArrayID_;
+    GLuint vertexbuffer_;
+    GLuint colorbuffer_;
+    GLuint offsetbuffer_;
+    GLsizei instance_count_ = 0;
+
+public:
+    CubeInstances();
+    CubeInstances(const CubeInstances&) = delete;
+    ~CubeInstances();
+
+    CubeInstances& operator=(const CubeInstances&) = delete;
+
+    // Block centers of the grid in instance buffer layout; this is all the CPU work of Upload(blocks)
+    static std::vector<glm::vec3> Offsets(const voxel::VoxelGrid& blocks);
+    // Block centers grouped by chunk in the given order; ranges[i] receives the instances of chunk_keys[i]
+    static std::vector<glm::vec3> Offsets(const voxel::VoxelGrid& blocks, const std::vector<glm::ivec3>& chunk_keys,
+                                          std::vector<DrawRange>& ranges);
+
+    // Replaces the instance buffer with the given block centers
+    void Upload(const std::vector<glm::vec3>& offsets);
+    void Upload(const voxel::VoxelGrid& blocks);
+
+    GLsizei size() const { return instance_count_; }
+
+    // Draws all instances with one glDrawArraysInstanced call
+    void Draw() const;
+    // Draws only the given instance ranges, moving the offset attribute to the start of each range
+    void Draw(const std::vector<DrawRange>& ranges) const;
+};
+
+}  // namespace figure
+
+#endif
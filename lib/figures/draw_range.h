@@ -0,0 +1,17 @@
+#ifndef GL_FIGURE_DRAW_RANGE
+#define GL_FIGURE_DRAW_RANGE
+
+// Include GLEW
+#include <GL/glew.h>
+
+namespace figure {
+
+// Consecutive elements of a buffer drawn together: instances for CubeInstances, indices for MeshModel
+struct DrawRange {
+    GLint first   = 0;
+    GLsizei count = 0;
+};
+
+}  // namespace figure
+
+#endif
@@ -0,0 +1,81 @@
+#include "mesh_model.h"
+
+figure::MeshModel::MeshModel() {
+    glGenVertexArrays(1, &VertexArrayID_);
+    glBindVertexArray(VertexArrayID_);
+
+    glGenBuffers(1, &vertexbuffer_);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer_);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+    glGenBuffers(1, &colorbuffer_);
+    glBindBuffer(GL_ARRAY_BUFFER, colorbuffer_);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+    // The element buffer binding is part of the VAO state
+    glGenBuffers(1, &elementbuffer_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementbuffer_);
+
+    glBindVertexArray(0);
+}
+
+figure::MeshModel::MeshModel(const voxel::BlockMesh& mesh) : MeshModel() {
+    Upload(mesh);
+}
+
+figure::MeshModel::~MeshModel() {
+    glDeleteVertexArrays(1, &VertexArrayID_);
+    glDeleteBuffers(1, &vertexbuffer_);
+    glDeleteBuffers(1, &colorbuffer_);
+    glDeleteBuffers(1, &elementbuffer_);
+}
+
+void figure::MeshModel::Upload(const voxel::BlockMesh& mesh) {
+    // Orphan the old storage before filling the new one, so a frame still drawing from it does not make the
+    // upload wait for the GPU
+    auto upload = [](GLenum target, std::size_t size, const void* data) {
+        glBufferData(target, static_cast<GLsizeiptr>(size), nullptr, GL_STATIC_DRAW);
+        glBufferSubData(target, 0, static_cast<GLsizeiptr>(size), data);
+    };
+    glBindVertexArray(VertexArrayID_);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer_);
+    if (mesh.packed.empty()) {
+        upload(GL_ARRAY_BUFFER, mesh.positions.size() * sizeof(glm::vec3), mesh.positions.data());
+    } else {
+        upload(GL_ARRAY_BUFFER, mesh.packed.size() * sizeof(std::uint32_t), mesh.packed.data());
+    }
+    // The vertex format follows the mesh: a packed word reaches the shader as an integer, with no color
+    if (packed_ != !mesh.packed.empty()) {
+        packed_ = !packed_;
+        if (packed_) {
+            glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, 0, (void*)0);
+            glDisableVertexAttribArray(1);
+        } else {
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+            glEnableVertexAttribArray(1);
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, colorbuffer_);
+    upload(GL_ARRAY_BUFFER, mesh.colors.size() * sizeof(glm::vec3), mesh.colors.data());
+
+    upload(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(std::uint32_t), mesh.indices.data());
+    glBindVertexArray(0);
+    index_count_ = static_cast<GLsizei>(mesh.indices.size());
+}
+
+void figure::MeshModel::Draw() const {
+    glBindVertexArray(VertexArrayID_);
+    glDrawElements(GL_TRIANGLES, index_count_, GL_UNSIGNED_INT, (void*)0);
+    glBindVertexArray(0);
+}
+
+void figure::MeshModel::Draw(const std::vector<DrawRange>& ranges) const {
+    glBindVertexArray(VertexArrayID_);
+    for (const DrawRange& range : ranges) {
+        glDrawElements(GL_TRIANGLES, range.count, GL_UNSIGNED_INT,
+                       reinterpret_cast<void*>(static_cast<std::size_t>(range.first) * sizeof(std::uint32_t)));
+    }
+    glBindVertexArray(0);
+}
@@ -0,0 +1,43 @@
+#ifndef GL_FIGURE_MESH_MODEL
+#define GL_FIGURE_MESH_MODEL
+
+// Include GLEW
+#include <GL/glew.h>
+
+#include <vector>
+
+#include "draw_range.h"
+#include "voxel/greedy_mesher.h"
+
+namespace figure {
+
+// GPU copy of a voxel::BlockMesh drawn with a single indexed draw call
+class MeshModel {
+private:
+    GLuint VertexArrayID_;
+    GLuint vertexbuffer_;
+    GLuint colorbuffer_;
+    GLuint elementbuffer_;
+    GLsizei index_count_ = 0;
+    // Vertices are packed_vertex.h words rather than float positions and colors
+    bool packed_ = false;
+
+public:
+    MeshModel();
+    explicit MeshModel(const voxel::BlockMesh& mesh);
+    MeshModel(const MeshModel&) = delete;
+    ~MeshModel();
+
+    MeshModel& operator=(const MeshModel&) = delete;
+
+    // Replaces the buffer contents with the given mesh, packed or not
+    void Upload(const voxel::BlockMesh& mesh);
+
+    void Draw() const;
+    // Draws only the given index ranges
+    void Draw(const std::vector<DrawRange>& ranges) const;
+};
+
+}  // namespace figure
+
+#endif
@@ -0,0 +1,39 @@
+#include "palette_texture.h"
+
+#include <algorithm>
+
+#include "voxel/packed_vertex.h"
+
+figure::PaletteTexture::PaletteTexture() {
+    glGenTextures(1, &texture_);
+    glBindTexture(GL_TEXTURE_1D, texture_);
+    // texelFetch ignores filtering, but a texture that expects mipmaps it does not have is incomplete
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_1D, 0);
+}
+
+figure::PaletteTexture::PaletteTexture(const std::vector<glm::vec3>& colors) : PaletteTexture() {
+    Upload(colors);
+}
+
+figure::PaletteTexture::~PaletteTexture() {
+    glDeleteTextures(1, &texture_);
+}
+
+void figure::PaletteTexture::Upload(const std::vector<glm::vec3>& colors) {
+    std::vector<glm::vec3> texels(colors.begin(),
+                                  colors.begin() + std::min<std::size_t>(colors.size(), voxel::kPackedColors));
+    if (texels.empty()) {
+        texels.emplace_back(1.0f);
+    }
+    glBindTexture(GL_TEXTURE_1D, texture_);
+    glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB32F, static_cast<GLsizei>(texels.size()), 0, GL_RGB, GL_FLOAT,
+                 texels.data());
+    glBindTexture(GL_TEXTURE_1D, 0);
+}
+
+void figure::PaletteTexture::Bind(GLuint unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_1D, texture_);
+}
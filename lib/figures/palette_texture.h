@@ -0,0 +1,35 @@
+#ifndef GL_FIGURE_PALETTE_TEXTURE
+#define GL_FIGURE_PALETTE_TEXTURE
+
+// Include GLEW
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace figure {
+
+// Colors of the palette indices of packed block meshes as a 1D texture, one texel per index, read by
+// PackedVertexShader.glsl with texelFetch
+class PaletteTexture {
+private:
+    GLuint texture_;
+
+public:
+    PaletteTexture();
+    explicit PaletteTexture(const std::vector<glm::vec3>& colors);
+    PaletteTexture(const PaletteTexture&) = delete;
+    ~PaletteTexture();
+
+    PaletteTexture& operator=(const PaletteTexture&) = delete;
+
+    // Replaces the colors; an empty list becomes a single white texel, like the unpacked mesher uses
+    void Upload(const std::vector<glm::vec3>& colors);
+
+    // Binds the texture to the texture unit
+    void Bind(GLuint unit) const;
+};
+
+}  // namespace figure
+
+#endif
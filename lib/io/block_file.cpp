@@ -0,0 +1,91 @@
+#include "block_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+io::BlockFile::BlockFile(const std::filesystem::path& path) {
+    Open(path);
+}
+
+bool io::BlockFile::Open(const std::filesystem::path& path) {
+    header_ = nullptr;
+    coords_ = nullptr;
+    if (!file_.Open(path)) {
+        return false;
+    }
+    if (file_.size() < sizeof(BlockFileHeader)) {
+        std::cerr << path << " is too short for a block file\n";
+        return false;
+    }
+
+    // mmap returns page aligned memory, so the header and the coordinates that follow it are aligned
+    const auto* header = reinterpret_cast<const BlockFileHeader*>(file_.data());
+    if (std::memcmp(header->magic, kBlockFileMagic, sizeof(kBlockFileMagic)) != 0 || header->version != 1 ||
+        (header->coord_bits != 16 && header->coord_bits != 32)) {
+        std::cerr << path << " is not a version 1 block file\n";
+        return false;
+    }
+    if ((file_.size() - sizeof(BlockFileHeader)) / (3 * header->coord_bits / 8) < header->count) {
+        std::cerr << path << " is truncated: " << header->count << " blocks expected\n";
+        return false;
+    }
+    header_ = header;
+    coords_ = file_.data() + sizeof(BlockFileHeader);
+    return true;
+}
+
+bool io::WriteBlockFile(const std::filesystem::path& path, const std::vector<glm::ivec3>& blocks) {
+    glm::ivec3 lo(0);
+    glm::ivec3 hi(0);
+    if (!blocks.empty()) {
+        lo = hi = blocks.front();
+        for (const glm::ivec3& block : blocks) {
+            lo = glm::min(lo, block);
+            hi = glm::max(hi, block);
+        }
+    }
+    glm::i64vec3 span = glm::i64vec3(hi) - glm::i64vec3(lo);
+    bool narrow       = std::max({span.x, span.y, span.z}) <= std::numeric_limits<std::uint16_t>::max();
+
+    BlockFileHeader header{};
+    std::memcpy(header.magic, kBlockFileMagic, sizeof(kBlockFileMagic));
+    header.version    = 1;
+    header.coord_bits = narrow ? 16 : 32;
+    header.count      = blocks.size();
+    // Center int16 coordinates around zero so the whole span fits into [-32768, 32767]
+    glm::ivec3 origin = narrow ? lo + (1 << 15) : glm::ivec3(0);
+    for (int axis = 0; axis < 3; axis++) {
+        header.origin[axis] = origin[axis];
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Impossible to open " << path << " for writing\n";
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    constexpr std::size_t kBatch = 1 << 16;
+    if (narrow) {
+        std::vector<std::int16_t> packed;
+        packed.reserve(3 * kBatch);
+        for (std::size_t begin = 0; begin < blocks.size(); begin += kBatch) {
+            packed.clear();
+            for (std::size_t i = begin; i < std::min(blocks.size(), begin + kBatch); i++) {
+                for (int axis = 0; axis < 3; axis++) {
+                    packed.push_back(static_cast<std::int16_t>(blocks[i][axis] - origin[axis]));
+                }
+            }
+            file.write(reinterpret_cast<const char*>(packed.data()),
+                       static_cast<std::streamsize>(packed.size() * sizeof(std::int16_t)));
+        }
+    } else {
+        static_assert(sizeof(glm::ivec3) == 3 * sizeof(std::int32_t), "ivec3 is written as three int32");
+        file.write(reinterpret_cast<const char*>(blocks.data()),
+                   static_cast<std::streamsize>(blocks.size() * sizeof(glm::ivec3)));
+    }
+    return static_cast<bool>(file);
+}
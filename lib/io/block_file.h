@@ -0,0 +1,71 @@
+#ifndef IO_BLOCK_FILE
+#define IO_BLOCK_FILE
+
+#include <bit>
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace io {
+
+// Binary sibling of .XYZ: a fixed header followed by `count` packed little-endian (x, y, z) triples
+// of int16 or int32. Stored coordinates are relative to `origin`, which lets int16 files hold any
+// block set no wider than 65536 cells along every axis.
+struct BlockFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t coord_bits;
+    std::uint64_t count;
+    std::int32_t origin[3];
+    std::uint32_t reserved;
+};
+static_assert(sizeof(BlockFileHeader) == 40, "BlockFileHeader is read straight from the mapped file");
+// The header and the coordinates are written and mapped in host order, which is only the documented
+// little-endian one on little-endian hosts
+static_assert(std::endian::native == std::endian::little, "block files are read and written in host byte order");
+
+inline constexpr char kBlockFileMagic[8]  = {'3', 'D', '2', 'M', 'C', 'B', 'L', 'K'};
+inline constexpr char kBlockFileExtension[] = ".XYZB";
+
+// Memory mapped binary block file. Coordinates are decoded from the mapping on access, nothing is copied.
+class BlockFile {
+private:
+    MappedFile file_;
+    const BlockFileHeader* header_ = nullptr;
+    const void* coords_            = nullptr;
+
+public:
+    BlockFile() = default;
+    explicit BlockFile(const std::filesystem::path& path);
+
+    // False if the file is missing, truncated or not a block file
+    bool Open(const std::filesystem::path& path);
+    bool is_open() const { return header_ != nullptr; }
+
+    std::size_t size() const { return header_ == nullptr ? 0 : header_->count; }
+    unsigned coord_bits() const { return header_->coord_bits; }
+    glm::ivec3 origin() const { return glm::ivec3(header_->origin[0], header_->origin[1], header_->origin[2]); }
+
+    // Raw packed coordinates, 3 * size() values of the width given by coord_bits()
+    const std::int16_t* coords16() const { return static_cast<const std::int16_t*>(coords_); }
+    const std::int32_t* coords32() const { return static_cast<const std::int32_t*>(coords_); }
+
+    glm::ivec3 operator[](std::size_t index) const {
+        if (header_->coord_bits == 16) {
+            const std::int16_t* xyz = coords16() + 3 * index;
+            return origin() + glm::ivec3(xyz[0], xyz[1], xyz[2]);
+        }
+        const std::int32_t* xyz = coords32() + 3 * index;
+        return origin() + glm::ivec3(xyz[0], xyz[1], xyz[2]);
+    }
+};
+
+// Writes blocks with int16 coordinates when they fit and int32 otherwise
+bool WriteBlockFile(const std::filesystem::path& path, const std::vector<glm::ivec3>& blocks);
+
+}  // namespace io
+
+#endif
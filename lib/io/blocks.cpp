@@ -0,0 +1,43 @@
+#include "blocks.h"
+
+#include <iostream>
+#include <vector>
+
+#include "block_file.h"
+#include "util/parallel.h"
+#include "voxel/morton.h"
+#include "xyz.h"
+
+bool io::IsBlockList(const std::filesystem::path& path) {
+    return path.extension() == ".XYZ" || path.extension() == kBlockFileExtension;
+}
+
+bool io::LoadBlocks(const std::filesystem::path& path, voxel::VoxelGrid& grid, unsigned threads,
+                    std::size_t* duplicates) {
+    grid.Clear();
+    std::vector<glm::ivec3> blocks;
+    std::vector<std::uint16_t> colors;
+    if (path.extension() == kBlockFileExtension) {
+        BlockFile file;
+        if (!file.Open(path)) {
+            return false;
+        }
+        blocks.resize(file.size());
+        util::ParallelFor(
+            0, blocks.size(),
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) {
+                    blocks[i] = file[i];
+                }
+            },
+            threads, 1 << 16);
+    } else if (!ReadXYZ(path, blocks, colors, threads)) {
+        return false;
+    }
+
+    voxel::FillGrid(grid, blocks, colors, threads);
+    if (duplicates != nullptr) {
+        *duplicates = blocks.size() - grid.size();
+    }
+    return true;
+}
@@ -0,0 +1,22 @@
+#ifndef IO_BLOCKS
+#define IO_BLOCKS
+
+#include <cstddef>
+#include <filesystem>
+
+#include "voxel/voxel_grid.h"
+
+namespace io {
+
+// True for the extensions LoadBlocks understands: .XYZ text lists and .XYZB binary block files
+bool IsBlockList(const std::filesystem::path& path);
+
+// Fills the grid from a .XYZ or .XYZB file. Palette indices of colored .XYZ files become the cell colors;
+// .XYZB blocks all get color 0. voxel::FillGrid groups the blocks by chunk and builds the chunks on all
+// threads; repeated blocks are stored once and counted in duplicates.
+bool LoadBlocks(const std::filesystem::path& path, voxel::VoxelGrid& grid, unsigned threads = 0,
+                std::size_t* duplicates = nullptr);
+
+}  // namespace io
+
+#endif
@@ -0,0 +1,134 @@
+#include "gzip.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <zlib.h>
+
+#include "util/parallel.h"
+
+namespace {
+
+// Input deflated by one task
+constexpr std::size_t kBlockSize = 1 << 20;
+// Deflate window, the most history a block can refer to
+constexpr std::size_t kWindowSize = 32 * 1024;
+
+// Raw deflate of one block. Blocks other than the last end with a sync flush, which aligns them to a byte
+// boundary without marking the stream final, so the outputs can be concatenated.
+bool DeflateBlock(std::string_view input, std::string_view dictionary, int level, bool last, std::string& output) {
+    z_stream stream{};
+    if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    if (!dictionary.empty()) {
+        deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(dictionary.data()),
+                             static_cast<uInt>(dictionary.size()));
+    }
+    // The bound covers a single call with Z_FINISH; a sync flush adds at most an empty stored block
+    output.resize(deflateBound(&stream, static_cast<uLong>(input.size())) + 16);
+    stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in  = static_cast<uInt>(input.size());
+    stream.next_out  = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+    int result       = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    output.resize(output.size() - stream.avail_out);
+    deflateEnd(&stream);
+    return stream.avail_in == 0 && (last ? result == Z_STREAM_END : result == Z_OK);
+}
+
+void AppendLittleEndian(std::string& out, std::uint32_t value) {
+    for (int byte = 0; byte < 4; byte++) {
+        out += static_cast<char>(value >> (8 * byte) & 0xFF);
+    }
+}
+
+}  // namespace
+
+bool io::GzipWriter::Open(const std::filesystem::path& path, int level, unsigned threads) {
+    Close();
+    file_.open(path, std::ios::binary);
+    if (!file_.is_open()) {
+        std::cerr << "Impossible to open " << path << " for writing\n";
+        return false;
+    }
+    level_     = std::clamp(level, 1, 9);
+    threads_   = threads == 0 ? util::HardwareThreads() : threads;
+    crc_       = static_cast<std::uint32_t>(crc32(0, Z_NULL, 0));
+    bytes_in_  = 0;
+    bytes_out_ = 0;
+    failed_    = false;
+    pending_.clear();
+    window_.clear();
+
+    // Deflate, no flags, no modification time, no extra flags, unknown OS
+    const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+    file_.write(header, sizeof(header));
+    bytes_out_ += sizeof(header);
+    return true;
+}
+
+void io::GzipWriter::Write(const void* data, std::size_t size) {
+    pending_.append(static_cast<const char*>(data), size);
+    bytes_in_ += size;
+    if (pending_.size() >= kBlockSize * threads_) {
+        Compress(false);
+    }
+}
+
+void io::GzipWriter::Compress(bool finish) {
+    std::size_t blocks = finish ? std::max<std::size_t>(1, (pending_.size() + kBlockSize - 1) / kBlockSize)
+                                : pending_.size() / kBlockSize;
+    std::vector<std::string> outputs(blocks);
+    std::vector<std::uint32_t> crcs(blocks);
+    std::vector<std::size_t> sizes(blocks);
+    std::vector<char> compressed(blocks, 0);
+    util::ParallelTasks(
+        blocks,
+        [&](std::size_t block, unsigned) {
+            const std::size_t begin = block * kBlockSize;
+            const std::size_t end   = std::min(begin + kBlockSize, pending_.size());
+            std::string_view input  = std::string_view(pending_).substr(begin, end - begin);
+            std::string_view dictionary =
+                block == 0 ? std::string_view(window_)
+                           : std::string_view(pending_).substr(begin - kWindowSize, kWindowSize);
+            const bool last   = finish && block + 1 == blocks;
+            compressed[block] = DeflateBlock(input, dictionary, level_, last, outputs[block]) ? 1 : 0;
+            crcs[block]       = static_cast<std::uint32_t>(
+                crc32(0, reinterpret_cast<const Bytef*>(input.data()), static_cast<uInt>(input.size())));
+            sizes[block]      = input.size();
+        },
+        threads_);
+
+    for (std::size_t block = 0; block < blocks; block++) {
+        failed_ |= compressed[block] == 0;
+        crc_ = static_cast<std::uint32_t>(crc32_combine(crc_, crcs[block], static_cast<z_off_t>(sizes[block])));
+        file_.write(outputs[block].data(), static_cast<std::streamsize>(outputs[block].size()));
+        bytes_out_ += outputs[block].size();
+    }
+
+    // Only whole blocks are consumed before the end, so the next dictionary lies within them
+    const std::size_t consumed = std::min(blocks * kBlockSize, pending_.size());
+    if (consumed > 0) {
+        const std::size_t history = std::min(kWindowSize, consumed);
+        window_.assign(pending_, consumed - history, history);
+    }
+    pending_.erase(0, consumed);
+}
+
+bool io::GzipWriter::Close() {
+    if (!file_.is_open()) {
+        return true;
+    }
+    Compress(true);
+    std::string trailer;
+    AppendLittleEndian(trailer, crc_);
+    AppendLittleEndian(trailer, static_cast<std::uint32_t>(bytes_in_));
+    file_.write(trailer.data(), static_cast<std::streamsize>(trailer.size()));
+    bytes_out_ += trailer.size();
+    bool written = static_cast<bool>(file_) && !failed_;
+    file_.close();
+    pending_.clear();
+    window_.clear();
+    return written;
+}
@@ -0,0 +1,59 @@
+#ifndef IO_GZIP
+#define IO_GZIP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace io {
+
+// Streams a gzip file. Input is cut into 1 MiB blocks that are deflated on `threads` threads at once, each
+// block primed with the 32 KiB of input before it, and joined into one deflate stream (the pigz layout), so
+// at most threads + 1 blocks of input are held in memory and any gzip reader can read the result.
+class GzipWriter {
+public:
+    GzipWriter() = default;
+    // level is a zlib compression level, 1 (fastest) to 9 (smallest); threads 0 means one per hardware thread
+    explicit GzipWriter(const std::filesystem::path& path, int level = 6, unsigned threads = 0) {
+        Open(path, level, threads);
+    }
+    GzipWriter(const GzipWriter&) = delete;
+    ~GzipWriter() { Close(); }
+
+    GzipWriter& operator=(const GzipWriter&) = delete;
+
+    bool Open(const std::filesystem::path& path, int level = 6, unsigned threads = 0);
+    bool is_open() const { return file_.is_open(); }
+
+    void Write(const void* data, std::size_t size);
+    void Write(std::string_view data) { Write(data.data(), data.size()); }
+
+    // Bytes passed to Write and bytes written to the file so far
+    std::uint64_t bytes_in() const { return bytes_in_; }
+    std::uint64_t bytes_out() const { return bytes_out_; }
+
+    // Compresses the rest, writes the gzip trailer and closes the file. False if any write failed.
+    bool Close();
+
+private:
+    // Deflates the complete blocks of pending_, or all of it and ends the stream when finish is set
+    void Compress(bool finish);
+
+    std::ofstream file_;
+    std::string pending_;
+    // Last input already compressed, the dictionary of the next block
+    std::string window_;
+    int level_               = 6;
+    unsigned threads_        = 1;
+    std::uint32_t crc_       = 0;
+    std::uint64_t bytes_in_  = 0;
+    std::uint64_t bytes_out_ = 0;
+    bool failed_             = false;
+};
+
+}  // namespace io
+
+#endif
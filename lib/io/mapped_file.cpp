@@ -0,0 +1,135 @@
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+io::MappedFile::MappedFile(const std::filesystem::path& path, Access access) {
+    Open(path, access);
+}
+
+io::MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+io::MappedFile::~MappedFile() {
+    Close();
+}
+
+io::MappedFile& io::MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        data_          = std::exchange(other.data_, nullptr);
+        size_          = std::exchange(other.size_, 0);
+        is_empty_file_ = std::exchange(other.is_empty_file_, false);
+#ifdef _WIN32
+        file_    = std::exchange(other.file_, nullptr);
+        mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+    }
+    return *this;
+}
+
+bool io::MappedFile::Open(const std::filesystem::path& path, Access access) {
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              access == Access::kSequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Impossible to open " << path << '\n';
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        is_empty_file_ = true;
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view     = mapping == nullptr ? nullptr : MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        std::cerr << "Impossible to map " << path << '\n';
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        return false;
+    }
+    file_    = file;
+    mapping_ = mapping;
+    data_    = static_cast<const char*>(view);
+    size_    = static_cast<std::size_t>(size.QuadPart);
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        std::cerr << "Impossible to open " << path << '\n';
+        return false;
+    }
+    struct stat info {};
+    if (fstat(file, &info) != 0) {
+        close(file);
+        return false;
+    }
+    if (info.st_size == 0) {
+        close(file);
+        is_empty_file_ = true;
+        return true;
+    }
+    void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping keeps its own reference to the file
+    close(file);
+    if (view == MAP_FAILED) {
+        std::cerr << "Impossible to map " << path << '\n';
+        return false;
+    }
+    madvise(view, static_cast<std::size_t>(info.st_size),
+            access == Access::kSequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    data_ = static_cast<const char*>(view);
+    size_ = static_cast<std::size_t>(info.st_size);
+#endif
+    return true;
+}
+
+void io::MappedFile::Close() {
+    if (data_ != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle(mapping_);
+        CloseHandle(file_);
+        mapping_ = nullptr;
+        file_    = nullptr;
+#else
+        munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+    data_          = nullptr;
+    size_          = 0;
+    is_empty_file_ = false;
+}
+
+void io::MappedFile::Release(std::size_t begin, std::size_t end) const {
+#ifndef _WIN32
+    // Only whole pages inside the range can go
+    const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    begin                  = (begin + page - 1) / page * page;
+    end                    = std::min(end, size_) / page * page;
+    if (data_ != nullptr && begin < end) {
+        madvise(const_cast<char*>(data_) + begin, end - begin, MADV_DONTNEED);
+    }
+#else
+    // Clean file pages of a view are trimmed from the working set by the system as needed
+    (void)begin;
+    (void)end;
+#endif
+}
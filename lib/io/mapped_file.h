@@ -0,0 +1,52 @@
+#ifndef IO_MAPPED_FILE
+#define IO_MAPPED_FILE
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+namespace io {
+
+// Read-only memory mapping of a whole file. The mapping lives as long as the object.
+class MappedFile {
+public:
+    // Read-ahead hint for the pages of the mapping
+    enum class Access { kSequential, kRandom };
+
+private:
+    const char* data_   = nullptr;
+    std::size_t size_   = 0;
+    bool is_empty_file_ = false;
+#ifdef _WIN32
+    void* file_    = nullptr;
+    void* mapping_ = nullptr;
+#endif
+
+    void Close();
+
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path, Access access = Access::kSequential);
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    ~MappedFile();
+
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // False if the file could not be opened or mapped. Empty files map to an empty view.
+    bool Open(const std::filesystem::path& path, Access access = Access::kSequential);
+    bool is_open() const { return data_ != nullptr || is_empty_file_; }
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+    // Tells the system that bytes [begin, end) will not be read again, so their pages can be dropped from memory
+    // right away. Reading them later is still valid and faults them in again.
+    void Release(std::size_t begin, std::size_t end) const;
+};
+
+}  // namespace io
+
+#endif
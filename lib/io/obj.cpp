@@ -0,0 +1,383 @@
+#include "obj.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+
+#include "mapped_file.h"
+#include "util/parallel.h"
+
+namespace {
+
+// Pieces the file is cut into; small enough to balance threads, large enough to keep per-piece work negligible
+constexpr std::size_t kPieceSize = std::size_t(4) << 20;
+
+std::string_view TrimLeft(std::string_view text) {
+    std::size_t pos = 0;
+    while (pos < text.size() && io::IsObjBlank(text[pos])) {
+        pos++;
+    }
+    return text.substr(pos);
+}
+
+template <typename T>
+bool ParseNumber(std::string_view& rest, T& value) {
+    rest               = TrimLeft(rest);
+    auto [next, error] = std::from_chars(rest.data(), rest.data() + rest.size(), value);
+    if (error != std::errc()) {
+        return false;
+    }
+    rest.remove_prefix(static_cast<std::size_t>(next - rest.data()));
+    return true;
+}
+
+// One based or negative (relative to the `seen` records before the line) index, checked against the total
+bool ParseIndex(std::string_view& corner, std::size_t seen, std::size_t total, std::uint32_t& index) {
+    long long value    = 0;
+    auto [next, error] = std::from_chars(corner.data(), corner.data() + corner.size(), value);
+    if (error != std::errc()) {
+        return false;
+    }
+    value = value < 0 ? value + static_cast<long long>(seen) : value - 1;
+    if (value < 0 || value >= static_cast<long long>(total)) {
+        return false;
+    }
+    index = static_cast<std::uint32_t>(value);
+    corner.remove_prefix(static_cast<std::size_t>(next - corner.data()));
+    return true;
+}
+
+// A piece of the file made of whole lines, with what the counting pass found in it
+struct Piece {
+    std::size_t begin = 0;
+    std::size_t end   = 0;
+    // Record counts, turned into the offsets of the first record of the piece once every piece is counted
+    std::size_t positions = 0;
+    std::size_t uvs       = 0;
+    std::size_t normals   = 0;
+    std::size_t triangles = 0;
+    std::vector<std::string_view> libraries;
+    std::vector<std::string_view> used_materials;
+    // Material in effect at the start of the piece, set after counting
+    std::uint32_t material = io::ObjData::kNone;
+    bool colored           = false;
+    std::string_view error;
+};
+
+// Kd colors of every `newmtl` in a Wavefront .mtl file; texture maps are ignored
+bool LoadMtl(const std::filesystem::path& path, std::vector<io::ObjMaterial>& materials,
+             std::unordered_map<std::string, std::uint32_t>& ids) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Impossible to open " << path << '\n';
+        return false;
+    }
+    std::string line;
+    std::uint32_t current = io::ObjData::kNone;
+    while (std::getline(file, line)) {
+        std::istringstream record(line);
+        std::string type;
+        record >> type;
+        if (type == "newmtl") {
+            io::ObjMaterial material;
+            record >> material.name;
+            // A later definition of the same name replaces the earlier one
+            auto [it, inserted] = ids.try_emplace(material.name, static_cast<std::uint32_t>(materials.size()));
+            if (inserted) {
+                materials.push_back(material);
+            } else {
+                materials[it->second] = material;
+            }
+            current = it->second;
+        } else if (type == "Kd" && current != io::ObjData::kNone) {
+            glm::vec3 color;
+            if (record >> color.x >> color.y >> color.z) {
+                materials[current].diffuse = color;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+bool io::ParseObjVertex(std::string_view rest, glm::vec3& position, glm::vec3& color, bool& colored) {
+    if (!ParseNumber(rest, position.x) || !ParseNumber(rest, position.y) || !ParseNumber(rest, position.z)) {
+        return false;
+    }
+    glm::vec3 rgb;
+    if (ParseNumber(rest, rgb.x) && ParseNumber(rest, rgb.y) && ParseNumber(rest, rgb.z)) {
+        color   = rgb;
+        colored = true;
+    }
+    return true;
+}
+
+std::size_t io::CountObjTriangles(std::string_view rest) {
+    std::size_t corners = 0;
+    while (!NextObjWord(rest).empty()) {
+        corners++;
+    }
+    return corners > 2 ? corners - 2 : 0;
+}
+
+bool io::ParseObjFace(std::string_view rest, const ObjRecordCounts& seen, const ObjRecordCounts& total,
+                      bool uvs_and_normals, std::vector<glm::uvec3>& polygon) {
+    auto parse_corner = [&](std::string_view corner, glm::uvec3& indices) {
+        indices = glm::uvec3(ObjData::kNone);
+        if (!ParseIndex(corner, seen.positions, total.positions, indices.x)) {
+            return false;
+        }
+        // v, v/vt, v//vn or v/vt/vn
+        if (!uvs_and_normals || corner.empty()) {
+            return true;
+        }
+        if (corner.front() != '/') {
+            return false;
+        }
+        corner.remove_prefix(1);
+        if (!corner.empty() && corner.front() != '/' && !ParseIndex(corner, seen.uvs, total.uvs, indices.y)) {
+            return false;
+        }
+        if (corner.empty()) {
+            return true;
+        }
+        if (corner.front() != '/') {
+            return false;
+        }
+        corner.remove_prefix(1);
+        return ParseIndex(corner, seen.normals, total.normals, indices.z) && corner.empty();
+    };
+    polygon.clear();
+    for (std::string_view corner = NextObjWord(rest); !corner.empty(); corner = NextObjWord(rest)) {
+        polygon.emplace_back();
+        if (!parse_corner(corner, polygon.back())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void io::ObjData::Clear() {
+    positions.clear();
+    colors.clear();
+    uvs.clear();
+    normals.clear();
+    triangles.clear();
+    triangle_uvs.clear();
+    triangle_normals.clear();
+    materials.clear();
+    triangle_materials.clear();
+    material_libraries.clear();
+}
+
+bool io::ReadObj(const std::filesystem::path& path, ObjData& obj, const ObjOptions& options) {
+    MappedFile file(path);
+    if (!file.is_open()) {
+        std::cerr << "Impossible to open " << path << '\n';
+        return false;
+    }
+    obj.Clear();
+    const std::string_view text = file.view();
+
+    // Cut the file after the first line break past every multiple of the piece size
+    std::vector<Piece> pieces;
+    for (std::size_t begin = 0; begin < text.size();) {
+        std::size_t end = std::min(begin + kPieceSize, text.size());
+        end             = end == text.size() ? end : text.find('\n', end);
+        end             = end == std::string_view::npos ? text.size() : end + 1;
+        pieces.push_back(Piece());
+        pieces.back().begin = begin;
+        pieces.back().end   = end;
+        begin               = end;
+    }
+
+    // Counting pass: records per piece, and the material names every piece refers to
+    util::ParallelTasks(
+        pieces.size(),
+        [&](std::size_t task, unsigned) {
+            Piece& piece      = pieces[task];
+            auto count_record = [&](std::string_view type, std::string_view rest) {
+                if (type == "v") {
+                    piece.positions++;
+                } else if (type == "vt") {
+                    piece.uvs++;
+                } else if (type == "vn") {
+                    piece.normals++;
+                } else if (type == "f") {
+                    piece.triangles += CountObjTriangles(rest);
+                } else if (type == "mtllib") {
+                    for (std::string_view name = NextObjWord(rest); !name.empty(); name = NextObjWord(rest)) {
+                        piece.libraries.push_back(name);
+                    }
+                } else if (type == "usemtl") {
+                    piece.used_materials.push_back(NextObjWord(rest));
+                }
+                return true;
+            };
+            ForEachObjRecord(text.substr(piece.begin, piece.end - piece.begin), count_record);
+        },
+        options.threads);
+
+    // Materials, in the order the libraries are named. A missing library leaves the mesh uncolored rather
+    // than failing the load.
+    std::unordered_map<std::string, std::uint32_t> material_ids;
+    for (const Piece& piece : pieces) {
+        for (std::string_view name : piece.libraries) {
+            obj.material_libraries.push_back(path.parent_path() / std::string(name));
+            LoadMtl(obj.material_libraries.back(), obj.materials, material_ids);
+        }
+    }
+    // Counts become the offsets of the first record of every piece
+    std::size_t positions     = 0;
+    std::size_t uvs           = 0;
+    std::size_t normals       = 0;
+    std::size_t triangles     = 0;
+    std::uint32_t material    = ObjData::kNone;
+    bool uses_known_materials = false;
+    auto to_offset            = [](std::size_t& count, std::size_t& total) {
+        const std::size_t offset = total;
+        total += count;
+        count = offset;
+    };
+    for (Piece& piece : pieces) {
+        to_offset(piece.positions, positions);
+        to_offset(piece.uvs, uvs);
+        to_offset(piece.normals, normals);
+        to_offset(piece.triangles, triangles);
+        piece.material = material;
+        for (std::string_view name : piece.used_materials) {
+            auto it  = material_ids.find(std::string(name));
+            material = it == material_ids.end() ? ObjData::kNone : it->second;
+            uses_known_materials |= it != material_ids.end();
+        }
+    }
+
+    const ObjRecordCounts totals = {positions, uvs, normals};
+    const bool with_uvs          = options.uvs_and_normals && uvs != 0;
+    const bool with_normals      = options.uvs_and_normals && normals != 0;
+    obj.positions.resize(positions);
+    obj.colors.resize(positions, glm::vec3(1.0f));
+    obj.uvs.resize(with_uvs ? uvs : 0);
+    obj.normals.resize(with_normals ? normals : 0);
+    obj.triangles.resize(triangles);
+    obj.triangle_uvs.resize(with_uvs ? triangles : 0);
+    obj.triangle_normals.resize(with_normals ? triangles : 0);
+    obj.triangle_materials.resize(uses_known_materials ? triangles : 0);
+
+    // Parsing pass: every piece writes its records from its offsets on, so the pieces need no merging
+    util::ParallelTasks(
+        pieces.size(),
+        [&](std::size_t task, unsigned) {
+            Piece& piece          = pieces[task];
+            std::size_t position  = piece.positions;
+            std::size_t uv        = piece.uvs;
+            std::size_t normal    = piece.normals;
+            std::size_t triangle  = piece.triangles;
+            std::uint32_t current = piece.material;
+            std::vector<glm::uvec3> polygon;
+            auto parse_record = [&](std::string_view type, std::string_view rest) {
+                if (type == "v") {
+                    if (!ParseObjVertex(rest, obj.positions[position], obj.colors[position], piece.colored)) {
+                        return false;
+                    }
+                    position++;
+                } else if (type == "vt") {
+                    glm::vec2 coordinate;
+                    if (!ParseNumber(rest, coordinate.x)) {
+                        return false;
+                    }
+                    // The second coordinate is optional, a third (depth) one is dropped
+                    coordinate.y = 0;
+                    ParseNumber(rest, coordinate.y);
+                    if (with_uvs) {
+                        obj.uvs[uv] = coordinate;
+                    }
+                    uv++;
+                } else if (type == "vn") {
+                    glm::vec3 direction;
+                    if (!ParseNumber(rest, direction.x) || !ParseNumber(rest, direction.y) ||
+                        !ParseNumber(rest, direction.z)) {
+                        return false;
+                    }
+                    if (with_normals) {
+                        obj.normals[normal] = direction;
+                    }
+                    normal++;
+                } else if (type == "f") {
+                    if (!ParseObjFace(rest, {position, uv, normal}, totals, options.uvs_and_normals, polygon)) {
+                        return false;
+                    }
+                    // Fan triangulation, as the counting pass assumed
+                    for (std::size_t i = 2; i < polygon.size(); i++, triangle++) {
+                        obj.triangles[triangle] = glm::uvec3(polygon[0].x, polygon[i - 1].x, polygon[i].x);
+                        if (with_uvs) {
+                            obj.triangle_uvs[triangle] = glm::uvec3(polygon[0].y, polygon[i - 1].y, polygon[i].y);
+                        }
+                        if (with_normals) {
+                            obj.triangle_normals[triangle] = glm::uvec3(polygon[0].z, polygon[i - 1].z, polygon[i].z);
+                        }
+                        if (uses_known_materials) {
+                            obj.triangle_materials[triangle] = current;
+                        }
+                    }
+                } else if (type == "usemtl") {
+                    auto it = material_ids.find(std::string(NextObjWord(rest)));
+                    current = it == material_ids.end() ? ObjData::kNone : it->second;
+                }
+                return true;
+            };
+            piece.error = ForEachObjRecord(text.substr(piece.begin, piece.end - piece.begin), parse_record);
+            // The piece is not read again; its pages need not stay resident
+            file.Release(piece.begin, piece.end);
+        },
+        options.threads);
+
+    bool colored = false;
+    for (const Piece& piece : pieces) {
+        if (!piece.error.empty()) {
+            std::cerr << "Bad record in " << path << ": " << piece.error << '\n';
+            obj.Clear();
+            return false;
+        }
+        colored |= piece.colored;
+    }
+    if (!colored) {
+        obj.colors.clear();
+    }
+    return true;
+}
+
+void io::UnrollCorners(const ObjData& obj, std::vector<glm::vec3>& vertices, std::vector<glm::vec2>& uvs,
+                       std::vector<glm::vec3>& normals, unsigned threads) {
+    vertices.resize(3 * obj.triangles.size());
+    uvs.resize(3 * obj.triangles.size());
+    normals.resize(3 * obj.triangles.size());
+    util::ParallelFor(
+        0, obj.triangles.size(),
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                const glm::uvec3& triangle = obj.triangles[i];
+                const glm::vec3 a          = obj.positions[triangle.x];
+                const glm::vec3 b          = obj.positions[triangle.y];
+                const glm::vec3 c          = obj.positions[triangle.z];
+                const glm::vec3 cross      = glm::cross(b - a, c - a);
+                const float length         = glm::length(cross);
+                const glm::vec3 flat       = length > 0 ? cross / length : glm::vec3(0);
+                for (int corner = 0; corner < 3; corner++) {
+                    const std::size_t out = 3 * i + corner;
+                    vertices[out]         = obj.positions[triangle[corner]];
+                    const std::uint32_t uv = obj.triangle_uvs.empty() ? ObjData::kNone : obj.triangle_uvs[i][corner];
+                    uvs[out]               = uv == ObjData::kNone ? glm::vec2(0) : obj.uvs[uv];
+                    const std::uint32_t normal =
+                        obj.triangle_normals.empty() ? ObjData::kNone : obj.triangle_normals[i][corner];
+                    normals[out] = normal == ObjData::kNone ? flat : obj.normals[normal];
+                }
+            }
+        },
+        threads, 4096);
+}
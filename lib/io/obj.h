@@ -0,0 +1,129 @@
+#ifndef IO_OBJ
+#define IO_OBJ
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace io {
+
+struct ObjMaterial {
+    std::string name;
+    glm::vec3 diffuse{0.8f};
+};
+
+// Contents of a Wavefront .obj file as struct-of-arrays buffers. Polygons are fan-triangulated; every
+// triangle corner refers to a position and, when the face gave them, a texture coordinate and a normal.
+struct ObjData {
+    static constexpr std::uint32_t kNone = std::numeric_limits<std::uint32_t>::max();
+
+    std::vector<glm::vec3> positions;
+    // Color of every position (`v x y z r g b`), empty when no vertex has one
+    std::vector<glm::vec3> colors;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+
+    // Position indices of every triangle
+    std::vector<glm::uvec3> triangles;
+    // Texture coordinate and normal indices of every triangle, kNone for corners without one. Empty when the
+    // file has no vt or vn records, or when they were not asked for.
+    std::vector<glm::uvec3> triangle_uvs;
+    std::vector<glm::uvec3> triangle_normals;
+
+    // Materials of the mtllib files, and the `usemtl` material of every triangle (kNone outside any known
+    // material). triangle_materials is empty when the file uses no known material.
+    std::vector<ObjMaterial> materials;
+    std::vector<std::uint32_t> triangle_materials;
+    // Paths of the mtllib files next to the .obj, in the order they are named, including those that were missing
+    std::vector<std::filesystem::path> material_libraries;
+
+    void Clear();
+};
+
+struct ObjOptions {
+    // Worker threads, 0 means one per hardware thread
+    unsigned threads = 0;
+    // Keep vt and vn records and the face references to them; the voxelizer needs positions only
+    bool uvs_and_normals = true;
+};
+
+// Reads a Wavefront .obj file and the .mtl files it names. The file is memory-mapped and cut into pieces at
+// line boundaries. A first parallel pass counts the records of every piece, so that a second one parses
+// the pieces on all threads with std::from_chars straight into their place in the buffers. Negative
+// (relative) indices are resolved against the whole file. Missing .mtl files only leave materials out.
+bool ReadObj(const std::filesystem::path& path, ObjData& obj, const ObjOptions& options = ObjOptions());
+
+// Record syntax shared by ReadObj and the streaming voxelizer, so that both accept the same files
+
+inline bool IsObjBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Removes and returns the next blank separated word of rest
+inline std::string_view NextObjWord(std::string_view& rest) {
+    std::size_t begin = 0;
+    while (begin < rest.size() && IsObjBlank(rest[begin])) {
+        begin++;
+    }
+    std::size_t end = begin;
+    while (end < rest.size() && !IsObjBlank(rest[end])) {
+        end++;
+    }
+    std::string_view word = rest.substr(begin, end - begin);
+    rest.remove_prefix(end);
+    return word;
+}
+
+// Calls visit(type, rest) for every line of text, where type is the first word. Returns the line visit
+// failed on, or an empty view.
+template <typename Visitor>
+std::string_view ForEachObjRecord(std::string_view text, Visitor&& visit) {
+    for (std::size_t pos = 0; pos < text.size();) {
+        std::size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+        std::string_view line = text.substr(pos, end - pos);
+        std::string_view rest = line;
+        std::string_view type = NextObjWord(rest);
+        if (!visit(type, rest)) {
+            return line;
+        }
+        pos = end + 1;
+    }
+    return std::string_view();
+}
+
+// Records of every kind: before a line, what negative indices count back from, or in the whole file, what
+// indices are checked against
+struct ObjRecordCounts {
+    std::size_t positions = 0;
+    std::size_t uvs       = 0;
+    std::size_t normals   = 0;
+};
+
+// Parses the rest of a v record: x y z, then an optional r g b color that sets colored
+bool ParseObjVertex(std::string_view rest, glm::vec3& position, glm::vec3& color, bool& colored);
+
+// Triangles the fan triangulation makes of the rest of an f record, counted without parsing its corners
+std::size_t CountObjTriangles(std::string_view rest);
+
+// Parses the corners of the rest of an f record into polygon, one (position, uv, normal) index triple per
+// corner, ObjData::kNone where a corner has none. Corners are v, v/vt, v//vn or v/vt/vn, with one based or
+// negative indices. Without uvs_and_normals only the position indices are read and checked.
+bool ParseObjFace(std::string_view rest, const ObjRecordCounts& seen, const ObjRecordCounts& total,
+                  bool uvs_and_normals, std::vector<glm::uvec3>& polygon);
+
+// Unrolls the triangles into one vertex per corner, the input of indexVBO. Corners without a texture
+// coordinate get (0, 0); corners without a normal get the normal of their triangle.
+void UnrollCorners(const ObjData& obj, std::vector<glm::vec3>& vertices, std::vector<glm::vec2>& uvs,
+                   std::vector<glm::vec3>& normals, unsigned threads = 0);
+
+}  // namespace io
+
+#endif
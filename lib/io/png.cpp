@@ -0,0 +1,86 @@
+#include "png.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+namespace {
+
+void AppendBigEndian(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    out.push_back(static_cast<std::uint8_t>(value >> 24));
+    out.push_back(static_cast<std::uint8_t>(value >> 16));
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+void WriteChunk(std::ofstream& file, const char* type, const std::vector<std::uint8_t>& data) {
+    std::vector<std::uint8_t> header;
+    AppendBigEndian(header, static_cast<std::uint32_t>(data.size()));
+    header.insert(header.end(), type, type + 4);
+    // The CRC covers the chunk type and data, not the length. zlib resets it on a null buffer, as an empty
+    // vector may have.
+    uLong crc = crc32(0, header.data() + 4, 4);
+    if (!data.empty()) {
+        crc = crc32(crc, data.data(), static_cast<uInt>(data.size()));
+    }
+    std::vector<std::uint8_t> footer;
+    AppendBigEndian(footer, static_cast<std::uint32_t>(crc));
+
+    file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    file.write(reinterpret_cast<const char*>(footer.data()), static_cast<std::streamsize>(footer.size()));
+}
+
+}  // namespace
+
+bool io::WritePng(const std::filesystem::path& path, int width, int height, int channels, const std::uint8_t* pixels,
+                  bool bottom_up) {
+    if (width <= 0 || height <= 0 || (channels != 3 && channels != 4)) {
+        std::cerr << "Can not write a " << width << "x" << height << "x" << channels << " image to " << path << '\n';
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Impossible to open " << path << " for writing\n";
+        return false;
+    }
+
+    const std::uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    std::vector<std::uint8_t> header;
+    AppendBigEndian(header, static_cast<std::uint32_t>(width));
+    AppendBigEndian(header, static_cast<std::uint32_t>(height));
+    // 8 bits per sample, RGB or RGBA, deflate, adaptive filtering, no interlace
+    header.insert(header.end(), {8, static_cast<std::uint8_t>(channels == 4 ? 6 : 2), 0, 0, 0});
+    WriteChunk(file, "IHDR", header);
+
+    // Every scanline starts with its filter type. Up (2) stores the difference to the row above, which turns
+    // the flat backgrounds and faces of a render into runs of zeros.
+    const std::size_t row = static_cast<std::size_t>(width) * channels;
+    std::vector<std::uint8_t> scanlines;
+    scanlines.reserve((row + 1) * height);
+    const std::uint8_t* above = nullptr;
+    for (int y = 0; y < height; y++) {
+        const std::uint8_t* source = pixels + row * static_cast<std::size_t>(bottom_up ? height - 1 - y : y);
+        scanlines.push_back(2);
+        for (std::size_t i = 0; i < row; i++) {
+            scanlines.push_back(static_cast<std::uint8_t>(source[i] - (above != nullptr ? above[i] : 0)));
+        }
+        above = source;
+    }
+
+    const uLong raw_size = static_cast<uLong>(scanlines.size());
+    std::vector<std::uint8_t> stream(compressBound(raw_size));
+    uLongf size = static_cast<uLongf>(stream.size());
+    if (compress2(stream.data(), &size, scanlines.data(), raw_size, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        std::cerr << "Impossible to compress " << path << '\n';
+        return false;
+    }
+    stream.resize(size);
+    WriteChunk(file, "IDAT", stream);
+    WriteChunk(file, "IEND", {});
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,17 @@
+#ifndef IO_PNG
+#define IO_PNG
+
+#include <cstdint>
+#include <filesystem>
+
+namespace io {
+
+// Writes an 8-bit RGB (channels = 3) or RGBA (channels = 4) image as a PNG. Rows are tightly packed,
+// top row first unless bottom_up is set, as returned by glReadPixels. Rows are filtered against the row above
+// and deflated with zlib.
+bool WritePng(const std::filesystem::path& path, int width, int height, int channels, const std::uint8_t* pixels,
+              bool bottom_up = false);
+
+}  // namespace io
+
+#endif
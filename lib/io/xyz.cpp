@@ -0,0 +1,267 @@
+#include "xyz.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "mapped_file.h"
+#include "util/parallel.h"
+
+namespace {
+
+bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Parses the next number of `text` starting at `pos`, skipping leading blanks
+bool ParseNumber(std::string_view text, std::size_t& pos, float& value) {
+    while (pos < text.size() && IsSpace(text[pos])) {
+        pos++;
+    }
+    auto [end, error] = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+    if (error != std::errc()) {
+        return false;
+    }
+    pos = static_cast<std::size_t>(end - text.data());
+    return true;
+}
+
+// Formatted lines are collected up to this size before they are written
+constexpr std::size_t kFlushSize = 1 << 20;
+// Digits reserved for the count line of a streamed file, enough for any 64-bit count
+constexpr std::size_t kCountWidth = 20;
+
+// Appends the "x y z" line of a block, or "x y z color" when color is not negative
+void AppendLine(std::string& buffer, const glm::ivec3& block, int color = -1) {
+    char number[16];
+    for (int axis = 0; axis < 3; axis++) {
+        char* end = std::to_chars(number, number + sizeof(number), block[axis]).ptr;
+        buffer.append(number, end);
+        buffer += axis == 2 && color < 0 ? '\n' : ' ';
+    }
+    if (color >= 0) {
+        char* end = std::to_chars(number, number + sizeof(number), color).ptr;
+        buffer.append(number, end);
+        buffer += '\n';
+    }
+}
+
+// Parses every complete "x y z" line of `text`; blank lines are skipped. A fourth number on a line is its
+// palette index and sets `colored`; with colors, indices are kept and lines without one get index 0.
+bool ParseLines(std::string_view text, std::vector<glm::ivec3>& blocks, std::vector<std::uint16_t>* colors,
+                bool& colored) {
+    std::size_t pos = 0;
+    while (true) {
+        while (pos < text.size() && IsSpace(text[pos])) {
+            pos++;
+        }
+        if (pos == text.size()) {
+            return true;
+        }
+        glm::vec3 center;
+        if (!ParseNumber(text, pos, center.x) || !ParseNumber(text, pos, center.y) ||
+            !ParseNumber(text, pos, center.z)) {
+            return false;
+        }
+        blocks.emplace_back(std::lround(center.x), std::lround(center.y), std::lround(center.z));
+        // The palette index is parsed even when it is not wanted, so that it is not taken for the next block
+        while (pos < text.size() && IsSpace(text[pos]) && text[pos] != '\n') {
+            pos++;
+        }
+        float color = 0;
+        if (pos < text.size() && text[pos] != '\n') {
+            if (!ParseNumber(text, pos, color) || color < 0 || color > 65535) {
+                return false;
+            }
+            colored = true;
+        }
+        if (colors != nullptr) {
+            colors->push_back(static_cast<std::uint16_t>(std::lround(color)));
+        }
+    }
+}
+
+// Shared by both ReadXYZ overloads; colors is nullptr when the caller does not want them
+bool ReadBlocks(const std::filesystem::path& path, std::vector<glm::ivec3>& blocks, std::vector<std::uint16_t>* colors,
+                unsigned threads) {
+    io::MappedFile file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string_view text = file.view();
+
+    // The count is an integer: a float would round counts above 2^24
+    std::size_t pos = 0;
+    while (pos < text.size() && IsSpace(text[pos])) {
+        pos++;
+    }
+    std::uint64_t count           = 0;
+    auto [count_end, count_error] = std::from_chars(text.data() + pos, text.data() + text.size(), count);
+    if (count_error != std::errc()) {
+        std::cerr << "Missing block count in " << path << '\n';
+        return false;
+    }
+    std::string_view body = text.substr(static_cast<std::size_t>(count_end - text.data()));
+
+    // Cut the body into ranges of whole lines, at least 1 MiB each so small files are read by one thread
+    constexpr std::size_t kMinRange = 1 << 20;
+    if (threads == 0) {
+        threads = util::HardwareThreads();
+    }
+    std::size_t range_count = std::max<std::size_t>(1, std::min<std::size_t>(threads, body.size() / kMinRange));
+    std::vector<std::size_t> cuts = {0};
+    for (std::size_t i = 1; i < range_count; i++) {
+        std::size_t cut = std::max(cuts.back(), body.size() * i / range_count);
+        cut             = body.find('\n', cut);
+        cuts.push_back(cut == std::string_view::npos ? body.size() : cut + 1);
+    }
+    cuts.push_back(body.size());
+
+    std::vector<std::vector<glm::ivec3>> parts(range_count);
+    std::vector<std::vector<std::uint16_t>> part_colors(range_count);
+    std::vector<char> parsed(range_count, 0);
+    std::vector<char> colored(range_count, 0);
+    util::ParallelTasks(
+        range_count,
+        [&](std::size_t range, unsigned) {
+            std::string_view lines = body.substr(cuts[range], cuts[range + 1] - cuts[range]);
+            // Lines hold about ten characters, which is a cheap and good enough reservation
+            parts[range].reserve(lines.size() / 10);
+            std::vector<std::uint16_t>* line_colors = colors != nullptr ? &part_colors[range] : nullptr;
+            bool any_color                          = false;
+
+            parsed[range]  = ParseLines(lines, parts[range], line_colors, any_color) ? 1 : 0;
+            colored[range] = any_color ? 1 : 0;
+        },
+        threads);
+
+    blocks.clear();
+    std::size_t total = 0;
+    for (std::size_t range = 0; range < range_count; range++) {
+        if (parsed[range] == 0) {
+            std::cerr << "Malformed block line in " << path << '\n';
+            return false;
+        }
+        total += parts[range].size();
+    }
+    blocks.reserve(total);
+    for (const std::vector<glm::ivec3>& part : parts) {
+        blocks.insert(blocks.end(), part.begin(), part.end());
+    }
+    if (colors != nullptr) {
+        colors->clear();
+        if (std::find(colored.begin(), colored.end(), 1) != colored.end()) {
+            colors->reserve(total);
+            for (const std::vector<std::uint16_t>& part : part_colors) {
+                colors->insert(colors->end(), part.begin(), part.end());
+            }
+        }
+    }
+
+    if (blocks.size() != count) {
+        std::cerr << path << " declares " << count << " blocks but holds " << blocks.size() << '\n';
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool io::ReadXYZ(const std::filesystem::path& path, std::vector<glm::ivec3>& blocks, unsigned threads) {
+    return ReadBlocks(path, blocks, nullptr, threads);
+}
+
+bool io::ReadXYZ(const std::filesystem::path& path, std::vector<glm::ivec3>& blocks, std::vector<std::uint16_t>& colors,
+                 unsigned threads) {
+    return ReadBlocks(path, blocks, &colors, threads);
+}
+
+bool io::WriteXYZ(const std::filesystem::path& path, const std::vector<glm::ivec3>& blocks,
+                  const std::vector<std::uint16_t>& colors) {
+    if (!colors.empty() && colors.size() != blocks.size()) {
+        std::cerr << "Got " << colors.size() << " colors for " << blocks.size() << " blocks\n";
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Impossible to open " << path << " for writing\n";
+        return false;
+    }
+
+    // Format lines into a large buffer instead of going through operator<< for every number
+    std::string buffer;
+    buffer.reserve(kFlushSize + 64);
+    buffer += std::to_string(blocks.size());
+    buffer += '\n';
+
+    for (std::size_t i = 0; i < blocks.size(); i++) {
+        AppendLine(buffer, blocks[i], colors.empty() ? -1 : colors[i]);
+        if (buffer.size() >= kFlushSize) {
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(file);
+}
+
+bool io::XYZWriter::Open(const std::filesystem::path& path) {
+    Close();
+    file_.open(path, std::ios::binary);
+    if (!file_.is_open()) {
+        std::cerr << "Impossible to open " << path << " for writing\n";
+        return false;
+    }
+    count_ = 0;
+    buffer_.reserve(kFlushSize + 64);
+    buffer_.assign(kCountWidth, ' ');
+    buffer_ += '\n';
+    return true;
+}
+
+void io::XYZWriter::Write(const glm::ivec3& block) {
+    Append(block, -1);
+}
+
+void io::XYZWriter::Write(const std::vector<glm::ivec3>& blocks) {
+    for (const glm::ivec3& block : blocks) {
+        Write(block);
+    }
+}
+
+void io::XYZWriter::Write(const glm::ivec3& block, std::uint16_t color) {
+    Append(block, color);
+}
+
+void io::XYZWriter::Write(const std::vector<glm::ivec3>& blocks, const std::vector<std::uint16_t>& colors) {
+    for (std::size_t i = 0; i < blocks.size(); i++) {
+        Write(blocks[i], colors[i]);
+    }
+}
+
+void io::XYZWriter::Append(const glm::ivec3& block, int color) {
+    AppendLine(buffer_, block, color);
+    count_++;
+    if (buffer_.size() >= kFlushSize) {
+        file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+}
+
+bool io::XYZWriter::Close() {
+    if (!file_.is_open()) {
+        return true;
+    }
+    file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+    std::string count = std::to_string(count_);
+    file_.seekp(0);
+    file_.write(count.data(), static_cast<std::streamsize>(count.size()));
+    bool written = static_cast<bool>(file_);
+    file_.close();
+    return written;
+}
@@ -0,0 +1,65 @@
+#ifndef IO_XYZ
+#define IO_XYZ
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+namespace io {
+
+// Reads a .XYZ block list: the block count on the first line, then one "x y z" line per block.
+// The file is memory mapped and split at line boundaries between `threads` parsers (0 means one per
+// hardware thread). Centers are rounded to the nearest cell. Blocks come back in file order. A count that
+// disagrees with the number of lines is an error.
+bool ReadXYZ(const std::filesystem::path& path, std::vector<glm::ivec3>& blocks, unsigned threads = 0);
+
+// ReadXYZ that also reads the optional fourth column, the palette index of the block. colors gets one index
+// per block, 0 where a line has no column, and is left empty when no line has one.
+bool ReadXYZ(const std::filesystem::path& path, std::vector<glm::ivec3>& blocks, std::vector<std::uint16_t>& colors,
+             unsigned threads = 0);
+
+// Writes the .XYZ block list read by 3D2MC: the block count on the first line,
+// then one "x y z" line with the center of every block, followed by its palette index when colors is not empty
+bool WriteXYZ(const std::filesystem::path& path, const std::vector<glm::ivec3>& blocks,
+              const std::vector<std::uint16_t>& colors = {});
+
+// Writes a .XYZ block list whose size is not known up front. Room for the count line is reserved when
+// the file is opened and the count is filled in by Close, padded with spaces, which every reader skips.
+class XYZWriter {
+public:
+    XYZWriter() = default;
+    explicit XYZWriter(const std::filesystem::path& path) { Open(path); }
+    XYZWriter(const XYZWriter&) = delete;
+    ~XYZWriter() { Close(); }
+
+    XYZWriter& operator=(const XYZWriter&) = delete;
+
+    bool Open(const std::filesystem::path& path);
+    bool is_open() const { return file_.is_open(); }
+
+    void Write(const glm::ivec3& block);
+    void Write(const std::vector<glm::ivec3>& blocks);
+    // Blocks with a palette index column
+    void Write(const glm::ivec3& block, std::uint16_t color);
+    void Write(const std::vector<glm::ivec3>& blocks, const std::vector<std::uint16_t>& colors);
+    std::size_t count() const { return count_; }
+
+    // Flushes the blocks, patches the count line and closes the file. False if any write failed.
+    bool Close();
+
+private:
+    // Color -1 writes the line without a palette index
+    void Append(const glm::ivec3& block, int color);
+
+    std::ofstream file_;
+    std::string buffer_;
+    std::size_t count_ = 0;
+};
+
+}  // namespace io
+
+#endif
@@ -0,0 +1,175 @@
+#include "buffer_arena.h"
+
+#include <algorithm>
+#include <iterator>
+
+render::RangeAllocator::RangeAllocator(std::size_t capacity) {
+    Reset(capacity, 0);
+}
+
+std::size_t render::RangeAllocator::Allocate(std::size_t size) {
+    auto fit = by_size_.lower_bound({size, 0});
+    if (size == 0 || fit == by_size_.end()) {
+        return kFailed;
+    }
+    const auto [free_size, offset] = *fit;
+    Erase(by_offset_.find(offset));
+    if (free_size > size) {
+        Insert(offset + size, free_size - size);
+    }
+    used_ += size;
+    return offset;
+}
+
+void render::RangeAllocator::Free(std::size_t offset, std::size_t size) {
+    used_ -= size;
+    // Merge with the free ranges right after and right before
+    auto next = by_offset_.lower_bound(offset);
+    if (next != by_offset_.end() && next->first == offset + size) {
+        size += next->second;
+        Erase(next++);
+    }
+    if (next != by_offset_.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            Erase(previous);
+        }
+    }
+    Insert(offset, size);
+}
+
+void render::RangeAllocator::Reset(std::size_t capacity, std::size_t used) {
+    capacity_ = capacity;
+    used_     = used;
+    by_offset_.clear();
+    by_size_.clear();
+    if (used < capacity) {
+        Insert(used, capacity - used);
+    }
+}
+
+void render::RangeAllocator::Insert(std::size_t offset, std::size_t size) {
+    by_offset_.emplace(offset, size);
+    by_size_.emplace(size, offset);
+}
+
+void render::RangeAllocator::Erase(std::map<std::size_t, std::size_t>::iterator range) {
+    by_size_.erase({range->second, range->first});
+    by_offset_.erase(range);
+}
+
+render::BufferArena::BufferArena(std::size_t unit_size, std::size_t initial_units)
+    : unit_size_(unit_size) {
+    Relocate(std::max<std::size_t>(initial_units, 1));
+    relocations_ = 0;
+}
+
+render::BufferArena::~BufferArena() {
+    glDeleteBuffers(1, &buffer_);
+}
+
+render::BufferArena::Handle render::BufferArena::Allocate(std::size_t units) {
+    if (units == 0) {
+        return kNoHandle;
+    }
+    std::size_t offset = ranges_.Allocate(units);
+    if (offset == RangeAllocator::kFailed) {
+        // Compact, and grow while the allocations would leave less than a quarter of the buffer free
+        std::size_t capacity = ranges_.capacity();
+        while ((ranges_.used() + units) * 4 > capacity * 3) {
+            capacity *= 2;
+        }
+        Relocate(capacity);
+        offset = ranges_.Allocate(units);
+    }
+    Handle handle = kNoHandle;
+    if (free_handles_.empty()) {
+        handle = static_cast<Handle>(allocations_.size());
+        allocations_.emplace_back();
+    } else {
+        handle = free_handles_.back();
+        free_handles_.pop_back();
+    }
+    allocations_[handle] = {offset, units};
+    return handle;
+}
+
+void render::BufferArena::Free(Handle handle) {
+    if (handle == kNoHandle) {
+        return;
+    }
+    Allocation& allocation = allocations_[handle];
+    ranges_.Free(allocation.offset, allocation.size);
+    allocation = Allocation();
+    free_handles_.push_back(handle);
+}
+
+void render::BufferArena::Write(Handle handle, const void* data) {
+    const Allocation& allocation = allocations_[handle];
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(allocation.offset * unit_size_),
+                    static_cast<GLsizeiptr>(allocation.size * unit_size_), data);
+}
+
+void render::BufferArena::Defragment() {
+    Relocate(ranges_.capacity());
+}
+
+render::ArenaStats render::BufferArena::stats() const {
+    ArenaStats stats;
+    stats.capacity     = ranges_.capacity() * unit_size_;
+    stats.used         = ranges_.used() * unit_size_;
+    stats.allocations  = allocations_.size() - free_handles_.size();
+    stats.free_ranges  = ranges_.free_ranges();
+    stats.largest_free = ranges_.LargestFree() * unit_size_;
+    stats.relocations  = relocations_;
+    return stats;
+}
+
+void render::BufferArena::Relocate(std::size_t capacity) {
+    GLuint target = 0;
+    glGenBuffers(1, &target);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, target);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity * unit_size_), nullptr, GL_DYNAMIC_DRAW);
+
+    // Live allocations in buffer order, copied to the front; ranges already next to each other move in one copy
+    std::vector<Handle> live;
+    for (Handle handle = 0; handle < allocations_.size(); handle++) {
+        if (allocations_[handle].size != 0) {
+            live.push_back(handle);
+        }
+    }
+    std::sort(live.begin(), live.end(),
+              [&](Handle a, Handle b) { return allocations_[a].offset < allocations_[b].offset; });
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer_);
+    auto copy = [&](std::size_t from, std::size_t to, std::size_t size) {
+        if (size != 0) {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(from * unit_size_),
+                                static_cast<GLintptr>(to * unit_size_), static_cast<GLsizeiptr>(size * unit_size_));
+        }
+    };
+    std::size_t run_from = 0;
+    std::size_t run_to   = 0;
+    std::size_t run_size = 0;
+    std::size_t used     = 0;
+    for (Handle handle : live) {
+        Allocation& allocation = allocations_[handle];
+        if (allocation.offset != run_from + run_size) {
+            copy(run_from, run_to, run_size);
+            run_from = allocation.offset;
+            run_to   = used;
+            run_size = 0;
+        }
+        run_size += allocation.size;
+        allocation.offset = used;
+        used += allocation.size;
+    }
+    copy(run_from, run_to, run_size);
+
+    glDeleteBuffers(1, &buffer_);
+    buffer_ = target;
+    ranges_.Reset(capacity, used);
+    relocations_++;
+}
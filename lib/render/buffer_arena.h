@@ -0,0 +1,116 @@
+#ifndef RENDER_BUFFER_ARENA
+#define RENDER_BUFFER_ARENA
+
+// Include GLEW
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace render {
+
+// Free ranges of an address space of units. Allocation takes the smallest free range that fits, freed ranges
+// merge with their free neighbours.
+class RangeAllocator {
+public:
+    static constexpr std::size_t kFailed = std::numeric_limits<std::size_t>::max();
+
+    explicit RangeAllocator(std::size_t capacity = 0);
+
+    // Offset of size free units, or kFailed when no free range is large enough
+    std::size_t Allocate(std::size_t size);
+    // Returns a range from Allocate
+    void Free(std::size_t offset, std::size_t size);
+    // Makes [0, used) allocated and the rest of the capacity free, as after moving every range to the front
+    void Reset(std::size_t capacity, std::size_t used);
+
+    std::size_t capacity() const { return capacity_; }
+    std::size_t used() const { return used_; }
+    std::size_t free_ranges() const { return by_offset_.size(); }
+    std::size_t LargestFree() const { return by_size_.empty() ? 0 : by_size_.rbegin()->first; }
+
+private:
+    void Insert(std::size_t offset, std::size_t size);
+    void Erase(std::map<std::size_t, std::size_t>::iterator range);
+
+    std::size_t capacity_ = 0;
+    std::size_t used_     = 0;
+    // Free ranges as offset -> size, and the same ranges as (size, offset) for best fit
+    std::map<std::size_t, std::size_t> by_offset_;
+    std::set<std::pair<std::size_t, std::size_t>> by_size_;
+};
+
+// Sizes in bytes
+struct ArenaStats {
+    std::size_t capacity     = 0;
+    std::size_t used         = 0;
+    std::size_t allocations  = 0;
+    std::size_t free_ranges  = 0;
+    std::size_t largest_free = 0;
+    // Times the allocations were moved to a new buffer
+    std::size_t relocations = 0;
+
+    // Share of the free bytes outside the largest free range: 0 while the free space is in one piece
+    double Fragmentation() const {
+        const std::size_t free = capacity - used;
+        return free == 0 ? 0 : 1 - static_cast<double>(largest_free) / static_cast<double>(free);
+    }
+};
+
+// One GL buffer suballocated into ranges of fixed-size units, so that many small meshes share a few GL objects
+// and draw from offsets into them. Allocations are named by handles, which stay valid when the arena moves
+// the ranges: when no free range fits, every allocation is copied with glCopyBufferSubData to the front of a
+// new buffer, which leaves the free space in one piece. The new buffer doubles in size while the allocations
+// would fill more than three quarters of it. buffer() changes then, and vertex arrays must bind it again.
+// The arena binds GL_COPY_READ_BUFFER and GL_COPY_WRITE_BUFFER only, so vertex array state is left alone.
+class BufferArena {
+public:
+    using Handle                      = std::uint32_t;
+    static constexpr Handle kNoHandle = std::numeric_limits<Handle>::max();
+
+    explicit BufferArena(std::size_t unit_size, std::size_t initial_units = 1 << 16);
+    BufferArena(const BufferArena&) = delete;
+    ~BufferArena();
+
+    BufferArena& operator=(const BufferArena&) = delete;
+
+    // Reserves units for a new allocation; kNoHandle for zero units
+    Handle Allocate(std::size_t units);
+    void Free(Handle handle);
+    // Fills the allocation with size(handle) units of data
+    void Write(Handle handle, const void* data);
+    // Moves every allocation to the front of a new buffer of the same capacity
+    void Defragment();
+
+    GLuint buffer() const { return buffer_; }
+    std::size_t unit_size() const { return unit_size_; }
+    // Position and length of an allocation, in units
+    std::size_t offset(Handle handle) const { return allocations_[handle].offset; }
+    std::size_t size(Handle handle) const { return allocations_[handle].size; }
+    ArenaStats stats() const;
+
+private:
+    struct Allocation {
+        std::size_t offset = 0;
+        // 0 for a handle on the free list
+        std::size_t size = 0;
+    };
+
+    void Relocate(std::size_t capacity);
+
+    const std::size_t unit_size_;
+    GLuint buffer_ = 0;
+    RangeAllocator ranges_;
+    std::vector<Allocation> allocations_;
+    std::vector<Handle> free_handles_;
+    std::size_t relocations_ = 0;
+};
+
+}  // namespace render
+
+#endif
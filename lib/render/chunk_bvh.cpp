@@ -0,0 +1,219 @@
+#include "chunk_bvh.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+
+namespace {
+
+render::Box ChunkBounds(const glm::ivec3& key, const voxel::VoxelGrid::Chunk& chunk) {
+    glm::ivec3 lo(std::numeric_limits<int>::max());
+    glm::ivec3 hi(std::numeric_limits<int>::min());
+    voxel::VoxelGrid::ForEachInChunk(key, chunk, [&](const glm::ivec3& cell, std::uint16_t) {
+        lo = glm::min(lo, cell);
+        hi = glm::max(hi, cell);
+    });
+    // Cells are block centers, a block spans half a unit around its cell
+    return {glm::vec3(lo) - 0.5f, glm::vec3(hi) + 0.5f};
+}
+
+void Grow(render::Box& box, const render::Box& other) {
+    box.lo = glm::min(box.lo, other.lo);
+    box.hi = glm::max(box.hi, other.hi);
+}
+
+}  // namespace
+
+void render::ChunkBvh::Build(const voxel::VoxelGrid& grid) {
+    keys_.clear();
+    boxes_.clear();
+    counts_.clear();
+    for (const auto& [key, chunk] : grid.chunks()) {
+        if (chunk->count == 0) {
+            continue;
+        }
+        keys_.push_back(key);
+        boxes_.push_back(ChunkBounds(key, *chunk));
+        counts_.push_back(chunk->count);
+    }
+    BuildTree();
+}
+
+bool render::ChunkBvh::Update(const voxel::VoxelGrid& grid, const std::vector<glm::ivec3>& changed) {
+    bool same_chunks = true;
+    for (const glm::ivec3& key : changed) {
+        const voxel::VoxelGrid::Chunk* chunk = grid.FindChunk(key);
+        if ((chunk != nullptr && chunk->count != 0) != (Find(key) >= 0)) {
+            same_chunks = false;
+            break;
+        }
+    }
+
+    if (same_chunks) {
+        for (const glm::ivec3& key : changed) {
+            std::int64_t id = Find(key);
+            if (id >= 0) {
+                const voxel::VoxelGrid::Chunk& chunk = *grid.FindChunk(key);
+                boxes_[static_cast<std::size_t>(id)]  = ChunkBounds(key, chunk);
+                counts_[static_cast<std::size_t>(id)] = chunk.count;
+            }
+        }
+        Refit();
+        return false;
+    }
+
+    std::unordered_map<glm::ivec3, std::uint32_t, voxel::VoxelGrid::ChunkKeyHash> old_ids;
+    old_ids.swap(ids_);
+    for (const glm::ivec3& key : changed) {
+        old_ids.erase(key);
+    }
+    std::vector<Box> old_boxes;
+    old_boxes.swap(boxes_);
+    keys_.clear();
+    counts_.clear();
+    for (const auto& [key, chunk] : grid.chunks()) {
+        if (chunk->count == 0) {
+            continue;
+        }
+        auto old = old_ids.find(key);
+        keys_.push_back(key);
+        boxes_.push_back(old != old_ids.end() ? old_boxes[old->second] : ChunkBounds(key, *chunk));
+        counts_.push_back(chunk->count);
+    }
+    BuildTree();
+    return true;
+}
+
+std::int64_t render::ChunkBvh::Find(const glm::ivec3& key) const {
+    auto it = ids_.find(key);
+    return it == ids_.end() ? -1 : static_cast<std::int64_t>(it->second);
+}
+
+void render::ChunkBvh::BuildTree() {
+    nodes_.clear();
+    ids_.clear();
+    if (keys_.empty()) {
+        return;
+    }
+
+    std::vector<std::uint32_t> order(keys_.size());
+    for (std::uint32_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    nodes_.reserve(2 * keys_.size() / kLeafSize + 1);
+    BuildNode(order, 0, static_cast<std::uint32_t>(order.size()));
+
+    // Renumber the chunks in tree order
+    std::vector<glm::ivec3> keys(order.size());
+    std::vector<Box> boxes(order.size());
+    std::vector<std::uint32_t> counts(order.size());
+    for (std::size_t i = 0; i < order.size(); i++) {
+        keys[i]   = keys_[order[i]];
+        boxes[i]  = boxes_[order[i]];
+        counts[i] = counts_[order[i]];
+    }
+    keys_.swap(keys);
+    boxes_.swap(boxes);
+    counts_.swap(counts);
+
+    ids_.reserve(keys_.size());
+    for (std::uint32_t i = 0; i < keys_.size(); i++) {
+        ids_.emplace(keys_[i], i);
+    }
+}
+
+void render::ChunkBvh::Refit() {
+    // Children always come after their parent
+    for (std::size_t i = nodes_.size(); i-- > 0;) {
+        Node& node = nodes_[i];
+        if (node.right == 0) {
+            node.box = boxes_[node.first];
+            for (std::uint32_t chunk = node.first + 1; chunk < node.first + node.count; chunk++) {
+                Grow(node.box, boxes_[chunk]);
+            }
+        } else {
+            node.box = nodes_[i + 1].box;
+            Grow(node.box, nodes_[node.right].box);
+        }
+    }
+}
+
+std::uint32_t render::ChunkBvh::BuildNode(std::vector<std::uint32_t>& order, std::uint32_t first,
+                                          std::uint32_t count) {
+    const std::uint32_t index = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+
+    auto center = [&](std::uint32_t chunk) { return boxes_[chunk].lo + boxes_[chunk].hi; };
+    Box box     = boxes_[order[first]];
+    Box centers = {center(order[first]), center(order[first])};
+    for (std::uint32_t i = first + 1; i < first + count; i++) {
+        Grow(box, boxes_[order[i]]);
+        glm::vec3 c = center(order[i]);
+        Grow(centers, {c, c});
+    }
+    nodes_[index].box   = box;
+    nodes_[index].first = first;
+    nodes_[index].count = count;
+    if (count <= kLeafSize) {
+        return index;
+    }
+
+    // Median split along the longest extent of the chunk centers
+    glm::vec3 extent = centers.hi - centers.lo;
+    int axis         = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+    const std::uint32_t middle = first + count / 2;
+    std::nth_element(order.begin() + first, order.begin() + middle, order.begin() + first + count,
+                     [&](std::uint32_t a, std::uint32_t b) { return center(a)[axis] < center(b)[axis]; });
+
+    BuildNode(order, first, middle - first);
+    nodes_[index].right = BuildNode(order, middle, first + count - middle);
+    return index;
+}
+
+void render::ChunkBvh::Cull(const Frustum& frustum, std::vector<std::uint32_t>& visible, CullStats* stats) const {
+    auto start = std::chrono::steady_clock::now();
+    visible.clear();
+    std::size_t tested = 0;
+
+    // Median splits keep the depth near log2(chunks / kLeafSize), far below the stack size
+    std::array<std::uint32_t, 64> stack;
+    std::size_t top = 0;
+    if (!nodes_.empty()) {
+        stack[top++] = 0;
+    }
+    while (top > 0) {
+        const std::uint32_t index = stack[--top];
+        const Node& node          = nodes_[index];
+        tested++;
+        Frustum::Side side = frustum.Classify(node.box);
+        if (side == Frustum::Side::kOutside) {
+            continue;
+        }
+        if (side == Frustum::Side::kInside) {
+            for (std::uint32_t i = node.first; i < node.first + node.count; i++) {
+                visible.push_back(i);
+            }
+        } else if (node.right == 0) {
+            for (std::uint32_t i = node.first; i < node.first + node.count; i++) {
+                tested++;
+                if (frustum.Intersects(boxes_[i])) {
+                    visible.push_back(i);
+                }
+            }
+        } else {
+            // Left child on top so ids come out in increasing order
+            stack[top++] = node.right;
+            stack[top++] = index + 1;
+        }
+    }
+
+    if (stats != nullptr) {
+        stats->nodes_tested += tested;
+        stats->chunks_visible += visible.size();
+        for (std::uint32_t chunk : visible) {
+            stats->blocks_visible += counts_[chunk];
+        }
+        stats->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef RENDER_CHUNK_BVH
+#define RENDER_CHUNK_BVH
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+#include "frustum.h"
+#include "voxel/voxel_grid.h"
+
+namespace render {
+
+struct CullStats {
+    std::size_t nodes_tested   = 0;
+    std::size_t chunks_visible = 0;
+    std::size_t blocks_visible = 0;
+    double seconds             = 0;
+};
+
+// Bounding volume hierarchy over the chunks of a voxel::VoxelGrid. Every chunk is bounded by the cubes
+// of its occupied cells, so mostly empty chunks stay small. Chunks are numbered in tree order: the chunks
+// of any subtree have consecutive ids, and Cull reports visible ids in increasing order.
+class ChunkBvh {
+public:
+    static constexpr std::uint32_t kLeafSize = 4;
+
+    struct Node {
+        Box box;
+        // Chunks [first, first + count) are under this node
+        std::uint32_t first = 0;
+        std::uint32_t count = 0;
+        // Index of the second child, 0 for leaves; the first child always follows its parent
+        std::uint32_t right = 0;
+    };
+
+    ChunkBvh() = default;
+    explicit ChunkBvh(const voxel::VoxelGrid& grid) { Build(grid); }
+
+    void Build(const voxel::VoxelGrid& grid);
+    // Brings the tree up to date after the blocks of the given chunks changed. If they only changed inside
+    // existing chunks the bounds are refitted and chunk ids stay; otherwise the tree is rebuilt, reusing the
+    // bounds of untouched chunks, and true is returned because ids changed.
+    bool Update(const voxel::VoxelGrid& grid, const std::vector<glm::ivec3>& changed);
+
+    // Id of the chunk with the given key, -1 if the chunk is empty or missing
+    std::int64_t Find(const glm::ivec3& key) const;
+
+    std::size_t size() const { return keys_.size(); }
+    // Chunk key, bounds and block count by chunk id
+    const std::vector<glm::ivec3>& keys() const { return keys_; }
+    const std::vector<Box>& boxes() const { return boxes_; }
+    const std::vector<std::uint32_t>& counts() const { return counts_; }
+    const std::vector<Node>& nodes() const { return nodes_; }
+
+    // Replaces visible with the ids of chunks that may intersect the frustum. Subtrees that are entirely
+    // inside are accepted without testing their children.
+    void Cull(const Frustum& frustum, std::vector<std::uint32_t>& visible, CullStats* stats = nullptr) const;
+
+private:
+    // Builds the tree over the chunks already in keys_, boxes_ and counts_
+    void BuildTree();
+    std::uint32_t BuildNode(std::vector<std::uint32_t>& order, std::uint32_t first, std::uint32_t count);
+    void Refit();
+
+    std::vector<glm::ivec3> keys_;
+    std::vector<Box> boxes_;
+    std::vector<std::uint32_t> counts_;
+    std::vector<Node> nodes_;
+    std::unordered_map<glm::ivec3, std::uint32_t, voxel::VoxelGrid::ChunkKeyHash> ids_;
+};
+
+}  // namespace render
+
+#endif
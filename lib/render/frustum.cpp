@@ -0,0 +1,33 @@
+#include "frustum.h"
+
+#include <cmath>
+
+render::Frustum::Frustum(const glm::mat4& view_projection) {
+    // Gribb-Hartmann: plane i is row 3 +- row (i / 2) of the matrix, glm stores columns
+    auto row = [&](int r) {
+        return glm::vec4(view_projection[0][r], view_projection[1][r], view_projection[2][r], view_projection[3][r]);
+    };
+    for (int i = 0; i < 6; i++) {
+        glm::vec4 plane = (i % 2 == 0) ? row(3) + row(i / 2) : row(3) - row(i / 2);
+        float length    = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        planes_[i]      = plane / length;
+    }
+}
+
+render::Frustum::Side render::Frustum::Classify(const Box& box) const {
+    Side side = Side::kInside;
+    for (const glm::vec4& plane : planes_) {
+        // The box corners farthest along and against the plane normal
+        glm::vec3 positive(plane.x >= 0 ? box.hi.x : box.lo.x, plane.y >= 0 ? box.hi.y : box.lo.y,
+                           plane.z >= 0 ? box.hi.z : box.lo.z);
+        glm::vec3 negative(plane.x >= 0 ? box.lo.x : box.hi.x, plane.y >= 0 ? box.lo.y : box.hi.y,
+                           plane.z >= 0 ? box.lo.z : box.hi.z);
+        if (plane.x * positive.x + plane.y * positive.y + plane.z * positive.z + plane.w < 0) {
+            return Side::kOutside;
+        }
+        if (plane.x * negative.x + plane.y * negative.y + plane.z * negative.z + plane.w < 0) {
+            side = Side::kIntersects;
+        }
+    }
+    return side;
+}
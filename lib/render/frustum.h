@@ -0,0 +1,35 @@
+#ifndef RENDER_FRUSTUM
+#define RENDER_FRUSTUM
+
+#include <array>
+#include <glm/glm.hpp>
+
+namespace render {
+
+// Axis-aligned box in world units, lo <= hi
+struct Box {
+    glm::vec3 lo;
+    glm::vec3 hi;
+};
+
+// The six clip planes of a projection * view matrix, normals pointing inside
+class Frustum {
+public:
+    enum class Side { kOutside, kIntersects, kInside };
+
+    // Contains everything, for drawing without culling
+    Frustum() = default;
+    explicit Frustum(const glm::mat4& view_projection);
+
+    // Conservative: a box near a frustum corner may be reported as intersecting while being outside
+    Side Classify(const Box& box) const;
+    bool Intersects(const Box& box) const { return Classify(box) != Side::kOutside; }
+
+private:
+    // left, right, bottom, top, near, far as (normal, distance)
+    std::array<glm::vec4, 6> planes_{};
+};
+
+}  // namespace render
+
+#endif
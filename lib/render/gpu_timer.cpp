@@ -0,0 +1,46 @@
+#include "gpu_timer.h"
+
+#include "util/trace.h"
+
+render::GpuTimer::GpuTimer(const char* name)
+    : name_(name) {
+    // Timer queries are core since GL 3.3
+    supported_ = util::TraceEnabled() && (GLEW_VERSION_3_3 || GLEW_ARB_timer_query);
+    if (supported_) {
+        glGenQueries(static_cast<GLsizei>(queries_.size()), queries_.data());
+    }
+}
+
+render::GpuTimer::~GpuTimer() {
+    if (supported_) {
+        glDeleteQueries(static_cast<GLsizei>(queries_.size()), queries_.data());
+    }
+}
+
+void render::GpuTimer::Begin() {
+    if (!supported_) {
+        return;
+    }
+    const std::size_t slot = issued_ % kLatency;
+    GLuint query           = queries_[slot];
+    if (issued_ >= kLatency) {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        // A result still pending after kLatency frames is dropped rather than waited for
+        if (available != 0) {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+            util::TraceCounter(name_, static_cast<double>(nanoseconds) / 1e6, frames_[slot]);
+        }
+    }
+    frames_[slot] = util::TraceCurrentFrame();
+    glBeginQuery(GL_TIME_ELAPSED, query);
+}
+
+void render::GpuTimer::End() {
+    if (!supported_) {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    issued_++;
+}
@@ -0,0 +1,43 @@
+#ifndef RENDER_GPU_TIMER
+#define RENDER_GPU_TIMER
+
+// Include GLEW
+#include <GL/glew.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace render {
+
+// Measures GPU time between Begin and End with GL_TIME_ELAPSED queries and reports it as a trace counter in
+// milliseconds. Results are read a few frames late from a small pool of queries, so the CPU never waits for
+// the GPU, and are reported against the frame they were measured in. Does nothing without timer query
+// support or while tracing is disabled. Timers must not nest.
+class GpuTimer {
+public:
+    // name must outlive the trace, see util::TraceCounter
+    explicit GpuTimer(const char* name);
+    GpuTimer(const GpuTimer&) = delete;
+    ~GpuTimer();
+
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void Begin();
+    void End();
+
+private:
+    static constexpr std::size_t kLatency = 4;
+
+    const char* name_;
+    bool supported_ = false;
+    std::array<GLuint, kLatency> queries_{};
+    // Trace frame every query was issued in, which its result is reported against
+    std::array<std::uint32_t, kLatency> frames_{};
+    // Queries begun so far; the one kLatency frames back is read before its slot is reused
+    std::size_t issued_ = 0;
+};
+
+}  // namespace render
+
+#endif
@@ -0,0 +1,67 @@
+#include "lod_selector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+render::LodSelector::LodSelector(const voxel::LodOctree& octree)
+    : octree_(&octree)
+    , refined_(octree.nodes().size(), 0) {
+}
+
+render::Box render::LodSelector::NodeBox(const voxel::LodOctree::Node& node) {
+    const float span = static_cast<float>(voxel::LodOctree::ChunkSpan(node.level));
+    glm::vec3 lo     = glm::vec3(node.key) * span - 0.5f;
+    return {lo, lo + span};
+}
+
+void render::LodSelector::Select(const Frustum& frustum, const glm::vec3& eye, const LodParams& params,
+                                 std::vector<std::uint32_t>& selected, CullStats* stats) {
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<voxel::LodOctree::Node>& nodes = octree_->nodes();
+    selected.clear();
+    stack_.clear();
+    for (std::size_t i = octree_->root_count(); i-- > 0;) {
+        stack_.push_back(static_cast<std::uint32_t>(i));
+    }
+
+    std::size_t tested = 0;
+    while (!stack_.empty()) {
+        const std::uint32_t index          = stack_.back();
+        const voxel::LodOctree::Node& node = nodes[index];
+        stack_.pop_back();
+        tested++;
+        Box box = NodeBox(node);
+        if (!frustum.Intersects(box)) {
+            continue;
+        }
+        if (node.level == 0) {
+            selected.push_back(index);
+            continue;
+        }
+
+        // Projected size of one cell of the node at the nearest point of its box
+        glm::vec3 gap   = glm::max(glm::max(box.lo - eye, eye - box.hi), glm::vec3(0.0f));
+        float distance  = std::max(std::sqrt(gap.x * gap.x + gap.y * gap.y + gap.z * gap.z), 1e-3f);
+        float pixels    = static_cast<float>(voxel::LodOctree::CellSize(node.level)) * params.pixel_scale / distance;
+        float threshold = refined_[index] ? params.max_cell_pixels / params.hysteresis : params.max_cell_pixels;
+        refined_[index] = pixels > threshold;
+        if (!refined_[index]) {
+            selected.push_back(index);
+            continue;
+        }
+        for (std::uint32_t child = node.first_child + node.child_count; child-- > node.first_child;) {
+            stack_.push_back(child);
+        }
+    }
+
+    if (stats != nullptr) {
+        stats->nodes_tested += tested;
+        stats->chunks_visible += selected.size();
+        for (std::uint32_t index : selected) {
+            const voxel::LodOctree::Node& node = nodes[index];
+            stats->blocks_visible += octree_->level(node.level).FindChunk(node.key)->count;
+        }
+        stats->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
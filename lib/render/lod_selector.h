@@ -0,0 +1,46 @@
+#ifndef RENDER_LOD_SELECTOR
+#define RENDER_LOD_SELECTOR
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "chunk_bvh.h"
+#include "frustum.h"
+#include "voxel/lod_octree.h"
+
+namespace render {
+
+struct LodParams {
+    // Pixels covered by one unit at distance one: viewport height / (2 * tan(fovy / 2))
+    float pixel_scale = 1.0f;
+    // A node is refined while one of its cells covers more pixels than this
+    float max_cell_pixels = 1.5f;
+    // A refined node only goes back to its own level once its cells shrink below max_cell_pixels / hysteresis,
+    // so nodes near the threshold do not flicker between levels
+    float hysteresis = 1.5f;
+};
+
+// Picks per frame the octree nodes to draw: visible nodes are refined top down until their cells are small
+// enough on screen. Remembers the choice of every node for the hysteresis.
+class LodSelector {
+public:
+    explicit LodSelector(const voxel::LodOctree& octree);
+
+    // World space bounds of the chunk of a node
+    static Box NodeBox(const voxel::LodOctree::Node& node);
+
+    // Replaces selected with the ids of nodes to draw. They cover every visible block exactly once.
+    // Stats count tested and selected nodes as chunks and the cells of the selected nodes as blocks.
+    void Select(const Frustum& frustum, const glm::vec3& eye, const LodParams& params,
+                std::vector<std::uint32_t>& selected, CullStats* stats = nullptr);
+
+private:
+    const voxel::LodOctree* octree_;
+    std::vector<std::uint8_t> refined_;
+    std::vector<std::uint32_t> stack_;
+};
+
+}  // namespace render
+
+#endif
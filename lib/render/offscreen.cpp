@@ -0,0 +1,173 @@
+#include "offscreen.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+render::OffscreenContext::~OffscreenContext() {
+#ifdef HAVE_EGL
+    if (egl_display_ != nullptr) {
+        EGLDisplay display = static_cast<EGLDisplay>(egl_display_);
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (egl_context_ != nullptr) {
+            eglDestroyContext(display, static_cast<EGLContext>(egl_context_));
+        }
+        eglTerminate(display);
+    }
+#endif
+    if (window_ != nullptr) {
+        glfwDestroyWindow(window_);
+        glfwTerminate();
+    }
+}
+
+bool render::OffscreenContext::Create() {
+    if (CreateEgl()) {
+        backend_ = "egl";
+    } else if (CreateGlfw()) {
+        backend_ = "glfw";
+    } else {
+        std::cerr << "Failed to create an offscreen OpenGL 3.3 context\n";
+        return false;
+    }
+
+    glewExperimental = GL_TRUE;
+    GLenum status    = glewInit();
+    // GLEW built for GLX reports a missing X display under EGL, but the entry points are loaded anyway
+    if (status != GLEW_OK && !(status == GLEW_ERROR_NO_GLX_DISPLAY && egl_context_ != nullptr)) {
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(status) << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool render::OffscreenContext::CreateEgl() {
+#ifdef HAVE_EGL
+    EGLDisplay display            = EGL_NO_DISPLAY;
+    const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto get_platform_display =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (client_extensions != nullptr && std::strstr(client_extensions, "EGL_MESA_platform_surfaceless") != nullptr &&
+        get_platform_display != nullptr) {
+        display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (display == EGL_NO_DISPLAY || eglInitialize(display, nullptr, nullptr) != EGL_TRUE) {
+        return false;
+    }
+    egl_display_ = display;
+
+    // The surface type defaults to windows, which surfaceless displays do not offer
+    const EGLint config_attributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    EGLint configs = 0;
+    if (eglBindAPI(EGL_OPENGL_API) != EGL_TRUE ||
+        eglChooseConfig(display, config_attributes, &config, 1, &configs) != EGL_TRUE || configs == 0) {
+        return false;
+    }
+    const EGLint context_attributes[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+                                         EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                         EGL_NONE};
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+    if (context == EGL_NO_CONTEXT) {
+        return false;
+    }
+    egl_context_ = context;
+    // Rendering goes to framebuffer objects only, so no surface is needed
+    return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) == EGL_TRUE;
+#else
+    return false;
+#endif
+}
+
+bool render::OffscreenContext::CreateGlfw() {
+    if (!glfwInit()) {
+        return false;
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    window_ = glfwCreateWindow(64, 64, "3D2MC", nullptr, nullptr);
+    if (window_ == nullptr) {
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(window_);
+    return true;
+}
+
+render::OffscreenTarget::OffscreenTarget(int width, int height)
+    : width_(width)
+    , height_(height) {
+    glGenFramebuffers(1, &framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+
+    glGenRenderbuffers(1, &color_);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_);
+
+    glGenRenderbuffers(1, &depth_);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Offscreen framebuffer of " << width << "x" << height << " is incomplete\n";
+    }
+
+    glGenBuffers(static_cast<GLsizei>(pixel_buffers_.size()), pixel_buffers_.data());
+    for (GLuint buffer : pixel_buffers_) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width) * height * 3, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+render::OffscreenTarget::~OffscreenTarget() {
+    glDeleteBuffers(static_cast<GLsizei>(pixel_buffers_.size()), pixel_buffers_.data());
+    glDeleteRenderbuffers(1, &depth_);
+    glDeleteRenderbuffers(1, &color_);
+    glDeleteFramebuffers(1, &framebuffer_);
+}
+
+void render::OffscreenTarget::Bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glViewport(0, 0, width_, height_);
+}
+
+void render::OffscreenTarget::StartReadback() {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffers_[started_ % kReadbacks]);
+    // RGB rows of odd widths are not 4 byte aligned
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    // With a pack buffer bound the copy is queued on the GPU and the call returns at once
+    glReadPixels(0, 0, width_, height_, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    started_++;
+}
+
+bool render::OffscreenTarget::FinishReadback(std::vector<std::uint8_t>& pixels) {
+    if (pending() == 0) {
+        return false;
+    }
+    const std::size_t size = static_cast<std::size_t>(width_) * height_ * 3;
+    pixels.resize(size);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_buffers_[finished_ % kReadbacks]);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT);
+    if (mapped != nullptr) {
+        std::memcpy(pixels.data(), mapped, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    finished_++;
+    return mapped != nullptr;
+}
@@ -0,0 +1,85 @@
+#ifndef RENDER_OFFSCREEN
+#define RENDER_OFFSCREEN
+
+// Include GLEW
+#include <GL/glew.h>
+
+// Include GLFW
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace render {
+
+// OpenGL 3.3 core context with no visible window. EGL, when built in, needs no display server: it takes the
+// Mesa surfaceless platform if present, which runs on software Mesa without a GPU. Otherwise a hidden GLFW
+// window provides the context.
+class OffscreenContext {
+public:
+    OffscreenContext() = default;
+    OffscreenContext(const OffscreenContext&) = delete;
+    ~OffscreenContext();
+
+    OffscreenContext& operator=(const OffscreenContext&) = delete;
+
+    // Creates the context, makes it current and loads GL functions
+    bool Create();
+
+    // "egl" or "glfw"
+    const char* backend() const { return backend_; }
+
+private:
+    bool CreateEgl();
+    bool CreateGlfw();
+
+    const char* backend_ = "none";
+    // EGLDisplay and EGLContext, kept opaque so that users do not need the EGL headers
+    void* egl_display_   = nullptr;
+    void* egl_context_   = nullptr;
+    GLFWwindow* window_  = nullptr;
+};
+
+// Framebuffer object with RGB color and depth renderbuffers, read back through a ring of pixel buffer
+// objects: a readback started after one image completes while the next image renders, so the CPU only
+// waits when it maps a buffer one image later.
+class OffscreenTarget {
+public:
+    static constexpr std::size_t kReadbacks = 2;
+
+    OffscreenTarget(int width, int height);
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    ~OffscreenTarget();
+
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+    // Binds the framebuffer and sets the viewport to cover it
+    void Bind() const;
+
+    // Starts copying the framebuffer into the next pixel buffer. The oldest readback must be finished
+    // first when kReadbacks are pending.
+    void StartReadback();
+    // Waits for the oldest pending readback and copies it to pixels as tightly packed RGB rows, bottom row
+    // first. False if no readback is pending.
+    bool FinishReadback(std::vector<std::uint8_t>& pixels);
+    std::size_t pending() const { return started_ - finished_; }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+private:
+    int width_;
+    int height_;
+    GLuint framebuffer_;
+    GLuint color_;
+    GLuint depth_;
+    std::array<GLuint, kReadbacks> pixel_buffers_{};
+    std::size_t started_  = 0;
+    std::size_t finished_ = 0;
+};
+
+}  // namespace render
+
+#endif
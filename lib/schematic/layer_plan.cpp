@@ -0,0 +1,181 @@
+#include "layer_plan.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+#include "util/parallel.h"
+
+namespace {
+
+void AppendNumber(std::string& out, long long value) {
+    char number[24];
+    out.append(number, std::to_chars(number, number + sizeof(number), value).ptr);
+}
+
+void AppendVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void AppendSigned(std::string& out, std::int64_t value) {
+    AppendVarint(out, static_cast<std::uint64_t>(value) << 1 ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+template <typename T>
+void AppendRaw(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+}  // namespace
+
+schematic::LayerPlan schematic::BuildLayerPlan(int y, std::vector<LayerCell>& cells) {
+    std::sort(cells.begin(), cells.end(), [](const LayerCell& a, const LayerCell& b) {
+        return a.z != b.z ? a.z < b.z : a.x < b.x;
+    });
+
+    LayerPlan plan;
+    plan.y      = y;
+    plan.blocks = cells.size();
+    for (const LayerCell& cell : cells) {
+        bool new_row = plan.rows.empty() || plan.rows.back().z != cell.z;
+        if (new_row) {
+            plan.rows.push_back(Row{cell.z, static_cast<std::uint32_t>(plan.runs.size()), 0});
+        }
+        Run* last = plan.runs.empty() ? nullptr : &plan.runs.back();
+        if (!new_row && last->x + last->length == cell.x && last->color == cell.color) {
+            last->length++;
+        } else if (new_row || last->x + last->length <= cell.x) {
+            plan.runs.push_back(Run{cell.x, 1, cell.color});
+            plan.rows.back().run_count++;
+        }
+        // Anything else is a duplicate of the previous cell
+    }
+    return plan;
+}
+
+void schematic::WriteLayerText(const LayerPlan& plan, std::string& out) {
+    out += "layer y=";
+    AppendNumber(out, plan.y);
+    out += " blocks=";
+    AppendNumber(out, static_cast<long long>(plan.blocks));
+    out += '\n';
+    for (const Row& row : plan.rows) {
+        out += "  z=";
+        AppendNumber(out, row.z);
+        out += ':';
+        for (std::uint32_t i = row.first_run; i < row.first_run + row.run_count; i++) {
+            const Run& run = plan.runs[i];
+            out += ' ';
+            AppendNumber(out, run.x);
+            if (run.length > 1) {
+                out += "..";
+                AppendNumber(out, run.x + run.length - 1);
+            }
+            if (run.color != 0) {
+                out += '#';
+                AppendNumber(out, run.color);
+            }
+        }
+        out += '\n';
+    }
+}
+
+void schematic::WriteLayerBinary(const LayerPlan& plan, std::string& out) {
+    AppendSigned(out, plan.y);
+    AppendVarint(out, plan.blocks);
+    AppendVarint(out, plan.rows.size());
+    int previous_z = 0;
+    for (const Row& row : plan.rows) {
+        AppendSigned(out, static_cast<std::int64_t>(row.z) - previous_z);
+        previous_z = row.z;
+        AppendVarint(out, row.run_count);
+        int previous_end = 0;
+        for (std::uint32_t i = row.first_run; i < row.first_run + row.run_count; i++) {
+            const Run& run = plan.runs[i];
+            if (i == row.first_run) {
+                AppendSigned(out, run.x);
+            } else {
+                AppendVarint(out, static_cast<std::uint64_t>(run.x - previous_end));
+            }
+            previous_end = run.x + run.length;
+            AppendVarint(out, static_cast<std::uint64_t>(run.length));
+            AppendVarint(out, run.color);
+        }
+    }
+}
+
+bool schematic::WriteLayerPlans(const voxel::VoxelGrid& grid, std::ostream* text, std::ostream* binary,
+                                const LayerPlanOptions& options) {
+    // Chunk keys bound the layers, so the buckets can be sized before the single pass over the blocks
+    int lowest  = std::numeric_limits<int>::max();
+    int highest = std::numeric_limits<int>::min();
+    for (const auto& [key, chunk] : grid.chunks()) {
+        lowest  = std::min(lowest, key.y * voxel::VoxelGrid::kChunkSize);
+        highest = std::max(highest, key.y * voxel::VoxelGrid::kChunkSize + voxel::VoxelGrid::kChunkMask);
+    }
+    std::vector<std::vector<LayerCell>> buckets(grid.empty() ? 0 : static_cast<std::size_t>(highest - lowest + 1));
+    grid.ForEach([&](const glm::ivec3& cell, std::uint16_t color) {
+        buckets[static_cast<std::size_t>(cell.y - lowest)].push_back(LayerCell{cell.x, cell.z, color});
+    });
+
+    std::vector<std::size_t> layers;
+    for (std::size_t i = 0; i < buckets.size(); i++) {
+        if (!buckets[i].empty()) {
+            layers.push_back(i);
+        }
+    }
+
+    if (text != nullptr) {
+        *text << "# 3D2MC layer plan: " << layers.size() << " layers, " << grid.size() << " blocks\n";
+    }
+    if (binary != nullptr) {
+        std::string header("3D2MCLAY");
+        AppendRaw<std::uint32_t>(header, 1);
+        AppendRaw<std::uint32_t>(header, static_cast<std::uint32_t>(layers.size()));
+        AppendRaw<std::uint64_t>(header, grid.size());
+        binary->write(header.data(), static_cast<std::streamsize>(header.size()));
+    }
+
+    const unsigned threads   = options.threads == 0 ? util::HardwareThreads() : options.threads;
+    const std::size_t window = options.window == 0 ? 4 * static_cast<std::size_t>(threads) : options.window;
+    std::vector<std::string> text_out(window);
+    std::vector<std::string> binary_out(window);
+    for (std::size_t begin = 0; begin < layers.size(); begin += window) {
+        std::size_t count = std::min(window, layers.size() - begin);
+        util::ParallelTasks(
+            count,
+            [&](std::size_t task, unsigned) {
+                std::size_t bucket = layers[begin + task];
+                LayerPlan plan     = BuildLayerPlan(lowest + static_cast<int>(bucket), buckets[bucket]);
+                // The bucket is not needed anymore once its plan exists
+                std::vector<LayerCell>().swap(buckets[bucket]);
+                text_out[task].clear();
+                binary_out[task].clear();
+                if (text != nullptr) {
+                    WriteLayerText(plan, text_out[task]);
+                }
+                if (binary != nullptr) {
+                    WriteLayerBinary(plan, binary_out[task]);
+                }
+            },
+            threads);
+
+        // Written in task order, so the output does not depend on which thread finished first
+        for (std::size_t task = 0; task < count; task++) {
+            if (text != nullptr) {
+                text->write(text_out[task].data(), static_cast<std::streamsize>(text_out[task].size()));
+            }
+            if (binary != nullptr) {
+                binary->write(binary_out[task].data(), static_cast<std::streamsize>(binary_out[task].size()));
+            }
+        }
+    }
+    return (text == nullptr || static_cast<bool>(*text)) && (binary == nullptr || static_cast<bool>(*binary));
+}
@@ -0,0 +1,72 @@
+#ifndef SCHEMATIC_LAYER_PLAN
+#define SCHEMATIC_LAYER_PLAN
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "voxel/voxel_grid.h"
+
+namespace schematic {
+
+// Horizontal line of blocks of one color: cells x .. x + length - 1 of a row
+struct Run {
+    int x;
+    int length;
+    std::uint16_t color;
+};
+
+// Row of a layer with a constant z; its runs are runs[first_run, first_run + run_count) of the layer
+struct Row {
+    int z;
+    std::uint32_t first_run;
+    std::uint32_t run_count;
+};
+
+// Build plan of one Y layer, rows sorted by z and runs by x
+struct LayerPlan {
+    int y             = 0;
+    std::size_t blocks = 0;
+    std::vector<Row> rows;
+    std::vector<Run> runs;
+};
+
+// A block of a layer before it is run-length encoded
+struct LayerCell {
+    int x;
+    int z;
+    std::uint16_t color;
+};
+
+// Sorts the cells of one layer and run-length encodes its rows
+LayerPlan BuildLayerPlan(int y, std::vector<LayerCell>& cells);
+
+// Human readable plan of one layer:
+//   layer y=<y> blocks=<count>
+//     z=<z>: <x>..<x_end> <x>#<color> ...
+void WriteLayerText(const LayerPlan& plan, std::string& out);
+
+// Compact plan of one layer. Integers are LEB128 varints, signed ones zigzag encoded:
+//   y, blocks, row count, then for every row: z delta to the previous row (the first row is absolute),
+//   run count, and for every run: x (absolute for the first run, gap after the previous run otherwise),
+//   length, color.
+void WriteLayerBinary(const LayerPlan& plan, std::string& out);
+
+struct LayerPlanOptions {
+    // Worker threads, 0 means one per hardware thread
+    unsigned threads = 0;
+    // Layers planned at once; only this many plans are kept in memory. 0 means four per thread.
+    std::size_t window = 0;
+};
+
+// Buckets the grid by Y in one pass, then plans windows of layers in parallel and streams every finished
+// window in ascending Y order. Either stream may be null. The binary stream starts with the 8 byte magic
+// "3D2MCLAY", a uint32 version, a uint32 layer count and a uint64 block count, all little-endian.
+bool WriteLayerPlans(const voxel::VoxelGrid& grid, std::ostream* text, std::ostream* binary,
+                     const LayerPlanOptions& options = LayerPlanOptions());
+
+}  // namespace schematic
+
+#endif
@@ -0,0 +1,230 @@
+#include "sponge_schematic.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "io/gzip.h"
+#include "util/parallel.h"
+
+namespace {
+
+// NBT tag types
+constexpr char kTagEnd       = 0;
+constexpr char kTagShort     = 2;
+constexpr char kTagInt       = 3;
+constexpr char kTagByteArray = 7;
+constexpr char kTagList      = 9;
+constexpr char kTagCompound  = 10;
+constexpr char kTagIntArray  = 11;
+
+// Encoded layers the default window holds at most, unless a single layer is larger
+constexpr std::uint64_t kWindowBytes = std::uint64_t(8) << 20;
+
+// NBT numbers are big-endian
+void AppendBigEndian(std::string& out, std::uint32_t value, int bytes) {
+    for (int byte = bytes - 1; byte >= 0; byte--) {
+        out += static_cast<char>(value >> (8 * byte) & 0xFF);
+    }
+}
+
+// Tag type and name of a named tag, the payload follows
+void AppendTag(std::string& out, char type, std::string_view name) {
+    out += type;
+    AppendBigEndian(out, static_cast<std::uint32_t>(name.size()), 2);
+    out += name;
+}
+
+void AppendInt(std::string& out, std::string_view name, std::int32_t value) {
+    AppendTag(out, kTagInt, name);
+    AppendBigEndian(out, static_cast<std::uint32_t>(value), 4);
+}
+
+void AppendShort(std::string& out, std::string_view name, int value) {
+    AppendTag(out, kTagShort, name);
+    AppendBigEndian(out, static_cast<std::uint32_t>(value), 2);
+}
+
+void AppendVarint(std::string& out, std::uint32_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+std::uint64_t VarintSize(std::uint32_t value) {
+    std::uint64_t size = 1;
+    for (; value >= 0x80; value >>= 7) {
+        size++;
+    }
+    return size;
+}
+
+// BlockData of layer y: rows of increasing z, cells of increasing x, empty cells as air (0)
+void EncodeLayer(const voxel::VoxelGrid& grid, int y, const glm::ivec3& lo, const glm::ivec3& hi,
+                 const std::vector<std::uint32_t>& remap, std::string& out) {
+    using voxel::VoxelGrid;
+    // Chunks of this layer, looked up once instead of once per cell
+    const glm::ivec3 first = VoxelGrid::ChunkOf(lo);
+    const glm::ivec3 last  = VoxelGrid::ChunkOf(hi);
+    const int columns      = last.x - first.x + 1;
+    std::vector<const VoxelGrid::Chunk*> chunks(static_cast<std::size_t>(columns) * (last.z - first.z + 1));
+    for (int cz = first.z; cz <= last.z; cz++) {
+        for (int cx = first.x; cx <= last.x; cx++) {
+            chunks[static_cast<std::size_t>(cz - first.z) * columns + (cx - first.x)] =
+                grid.FindChunk(glm::ivec3(cx, y >> VoxelGrid::kChunkBits, cz));
+        }
+    }
+
+    out.clear();
+    for (int z = lo.z; z <= hi.z; z++) {
+        const int cz = z >> VoxelGrid::kChunkBits;
+        for (int cx = first.x; cx <= last.x; cx++) {
+            const int x_begin = std::max(lo.x, cx * VoxelGrid::kChunkSize);
+            const int x_end   = std::min(hi.x, cx * VoxelGrid::kChunkSize + VoxelGrid::kChunkMask);
+            const VoxelGrid::Chunk* chunk =
+                chunks[static_cast<std::size_t>(cz - first.z) * columns + (cx - first.x)];
+            if (chunk == nullptr) {
+                out.append(static_cast<std::size_t>(x_end - x_begin + 1), '\0');
+                continue;
+            }
+            for (int x = x_begin; x <= x_end; x++) {
+                const int index = VoxelGrid::LocalIndex(glm::ivec3(x, y, z));
+                if (!chunk->Test(index)) {
+                    out += '\0';
+                } else {
+                    AppendVarint(out, remap[std::min<std::size_t>(chunk->Color(index), remap.size() - 1)]);
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+bool schematic::WriteSpongeSchematic(const voxel::VoxelGrid& grid, const voxel::BlockPalette& palette,
+                                     const std::filesystem::path& path, const SchematicOptions& options,
+                                     SchematicStats* stats) {
+    if (grid.empty() || palette.empty()) {
+        std::cerr << "Nothing to write to " << path << '\n';
+        return false;
+    }
+    const std::pair<glm::ivec3, glm::ivec3> bounds = grid.Bounds();
+    const glm::ivec3 lo                            = bounds.first;
+    const glm::ivec3 hi                            = bounds.second;
+    const glm::ivec3 size                          = hi - lo + 1;
+    const std::uint64_t volume                     = static_cast<std::uint64_t>(size.x) * size.y * size.z;
+    if (glm::any(glm::greaterThan(size, glm::ivec3(std::numeric_limits<std::uint16_t>::max())))) {
+        std::cerr << "A schematic can not be wider than 65535 blocks: " << path << '\n';
+        return false;
+    }
+
+    // Count the blocks of every color, which gives the used palette and the exact BlockData size
+    std::vector<std::uint64_t> counts(palette.size(), 0);
+    for (const auto& [key, chunk] : grid.chunks()) {
+        if (!chunk->colors) {
+            counts[0] += chunk->count;
+            continue;
+        }
+        voxel::VoxelGrid::ForEachInChunk(key, *chunk, [&](const glm::ivec3&, std::uint16_t color) {
+            counts[std::min<std::size_t>(color, palette.size() - 1)]++;
+        });
+    }
+
+    // Air is 0, then every used block name in palette order; colors sharing a name share an index
+    std::vector<std::string_view> names = {"minecraft:air"};
+    std::unordered_map<std::string_view, std::uint32_t> name_index = {{names[0], 0}};
+    std::vector<std::uint32_t> remap(palette.size(), 0);
+    std::uint64_t data_bytes = volume - grid.size();
+    for (std::size_t color = 0; color < palette.size(); color++) {
+        if (counts[color] == 0) {
+            continue;
+        }
+        const std::string& name = palette.blocks()[color].name;
+        auto [entry, inserted]  = name_index.emplace(name, static_cast<std::uint32_t>(names.size()));
+        if (inserted) {
+            names.push_back(name);
+        }
+        remap[color] = entry->second;
+        data_bytes += counts[color] * VarintSize(remap[color]);
+    }
+    if (data_bytes > static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max())) {
+        std::cerr << "Block data of " << data_bytes << " bytes does not fit in one schematic: " << path << '\n';
+        return false;
+    }
+
+    const unsigned threads = options.threads == 0 ? util::HardwareThreads() : options.threads;
+    io::GzipWriter file;
+    if (!file.Open(path, options.compression, threads)) {
+        return false;
+    }
+
+    std::string header;
+    AppendTag(header, kTagCompound, "Schematic");
+    AppendInt(header, "Version", 2);
+    AppendInt(header, "DataVersion", options.data_version);
+    AppendShort(header, "Width", size.x);
+    AppendShort(header, "Height", size.y);
+    AppendShort(header, "Length", size.z);
+    AppendTag(header, kTagIntArray, "Offset");
+    AppendBigEndian(header, 3, 4);
+    for (int axis = 0; axis < 3; axis++) {
+        AppendBigEndian(header, 0, 4);
+    }
+    AppendInt(header, "PaletteMax", static_cast<std::int32_t>(names.size()));
+    AppendTag(header, kTagCompound, "Palette");
+    for (std::size_t i = 0; i < names.size(); i++) {
+        AppendInt(header, names[i], static_cast<std::int32_t>(i));
+    }
+    header += kTagEnd;
+    AppendTag(header, kTagByteArray, "BlockData");
+    AppendBigEndian(header, static_cast<std::uint32_t>(data_bytes), 4);
+    file.Write(header);
+
+    // Layers are encoded a window at a time and handed to the compressor in Y order. By default the window is
+    // four layers per thread, as far as they fit in kWindowBytes: a layer is at least one byte per cell.
+    const std::uint64_t layer_bytes = std::max<std::uint64_t>(1, data_bytes / static_cast<std::uint64_t>(size.y));
+    const std::size_t window =
+        options.window != 0
+            ? options.window
+            : static_cast<std::size_t>(std::clamp<std::uint64_t>(kWindowBytes / layer_bytes, 1, 4 * threads));
+    std::vector<std::string> layers(std::min<std::size_t>(window, static_cast<std::size_t>(size.y)));
+    for (int begin = lo.y; begin <= hi.y; begin += static_cast<int>(layers.size())) {
+        const std::size_t count = std::min<std::size_t>(layers.size(), static_cast<std::size_t>(hi.y - begin + 1));
+        util::ParallelTasks(
+            count,
+            [&](std::size_t task, unsigned) {
+                EncodeLayer(grid, begin + static_cast<int>(task), lo, hi, remap, layers[task]);
+            },
+            threads);
+        for (std::size_t task = 0; task < count; task++) {
+            file.Write(layers[task]);
+        }
+    }
+
+    std::string footer;
+    // No block entities: an empty list of compounds
+    AppendTag(footer, kTagList, "BlockEntities");
+    footer += kTagCompound;
+    AppendBigEndian(footer, 0, 4);
+    footer += kTagEnd;
+    file.Write(footer);
+
+    const std::uint64_t encoded = file.bytes_in() - header.size() - footer.size();
+    if (!file.Close() || encoded != data_bytes) {
+        std::cerr << "Failed to write " << path << '\n';
+        return false;
+    }
+    if (stats != nullptr) {
+        stats->size             = size;
+        stats->palette          = names.size();
+        stats->block_data_bytes = data_bytes;
+        stats->file_bytes       = file.bytes_out();
+    }
+    return true;
+}
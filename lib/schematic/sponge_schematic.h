@@ -0,0 +1,47 @@
+#ifndef SCHEMATIC_SPONGE_SCHEMATIC
+#define SCHEMATIC_SPONGE_SCHEMATIC
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+
+#include "voxel/block_palette.h"
+#include "voxel/voxel_grid.h"
+
+namespace schematic {
+
+struct SchematicOptions {
+    // Minecraft data version the block names belong to; 3465 is 1.20.1
+    int data_version = 3465;
+    // zlib level, 1 (fastest) to 9 (smallest)
+    int compression = 6;
+    // Worker threads, 0 means one per hardware thread
+    unsigned threads = 0;
+    // Layers encoded at once; only this many layers are kept in memory. 0 means four per thread, fewer when
+    // they would take more than about 8 MiB, but at least one.
+    std::size_t window = 0;
+};
+
+struct SchematicStats {
+    // Width (x), height (y) and length (z) of the bounding box
+    glm::ivec3 size{0};
+    // Palette entries written, air included
+    std::size_t palette = 0;
+    std::uint64_t block_data_bytes = 0;
+    std::uint64_t file_bytes       = 0;
+};
+
+// Writes the bounding box of the grid as a gzip compressed Sponge schematic (version 2, .schem), the format
+// WorldEdit and most other tools paste. Cell colors are indices into palette, whose block names are used;
+// indices past its end use the last block and empty cells are air. BlockData holds one varint palette index
+// per cell in x, z, y order; its size is counted up front, then Y layers are encoded in parallel windows and
+// compressed as they are done, so only a window of layers of the uncompressed array is held in memory: about
+// 8 MiB by default, or one layer (width * length bytes and more) when a layer is larger.
+bool WriteSpongeSchematic(const voxel::VoxelGrid& grid, const voxel::BlockPalette& palette,
+                          const std::filesystem::path& path, const SchematicOptions& options = SchematicOptions(),
+                          SchematicStats* stats = nullptr);
+
+}  // namespace schematic
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef UTIL_MPMC_QUEUE
+#define UTIL_MPMC_QUEUE
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace util {
+
+// Bounded lock-free queue for any number of producer and consumer threads (D. Vyukov's array queue).
+// Every cell carries a sequence number telling whether it is ready for the next push or the next pop,
+// so a push or a pop is one compare-and-swap on the shared position plus one store to the cell.
+template <typename T>
+class MpmcQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit MpmcQueue(std::size_t capacity)
+        : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1)
+        , cells_(std::make_unique<Cell[]>(mask_ + 1)) {
+        for (std::size_t i = 0; i <= mask_; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&)            = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    // Returns false without touching value if the queue is full
+    bool TryPush(T&& value) {
+        std::size_t position = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell                 = &cells_[position & mask_];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t lag    = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (lag == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the queue is empty
+    bool TryPop(T& value) {
+        std::size_t position = head_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell                 = &cells_[position & mask_];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t lag    = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (lag == 0) {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        // The cell is free again for the push one lap later
+        cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    // Producers and consumers each get their own cache line
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    alignas(64) std::atomic<std::size_t> head_{0};
+};
+
+}  // namespace util
+
+#endif
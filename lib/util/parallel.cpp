@@ -0,0 +1,67 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+unsigned util::HardwareThreads() {
+    unsigned threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+}
+
+void util::ParallelFor(std::size_t begin, std::size_t end,
+                       const std::function<void(std::size_t, std::size_t)>& body, unsigned threads,
+                       std::size_t grain) {
+    if (end <= begin) {
+        return;
+    }
+    if (threads == 0) {
+        threads = HardwareThreads();
+    }
+    std::size_t count  = end - begin;
+    std::size_t ranges = std::min<std::size_t>(threads, (count + grain - 1) / std::max<std::size_t>(grain, 1));
+    if (ranges <= 1) {
+        body(begin, end);
+        return;
+    }
+
+    std::size_t step = (count + ranges - 1) / ranges;
+    std::vector<std::thread> workers;
+    workers.reserve(ranges - 1);
+    for (std::size_t from = begin + step; from < end; from += step) {
+        workers.emplace_back(body, from, std::min(end, from + step));
+    }
+    // The calling thread takes the first range itself
+    body(begin, std::min(end, begin + step));
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void util::ParallelTasks(std::size_t count, const std::function<void(std::size_t, unsigned)>& body,
+                         unsigned threads) {
+    if (count == 0) {
+        return;
+    }
+    if (threads == 0) {
+        threads = HardwareThreads();
+    }
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, count));
+
+    std::atomic<std::size_t> next(0);
+    auto worker = [&](unsigned thread_index) {
+        for (std::size_t task = next++; task < count; task = next++) {
+            body(task, thread_index);
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; i++) {
+        workers.emplace_back(worker, i);
+    }
+    worker(0);
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+}
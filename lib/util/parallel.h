@@ -0,0 +1,23 @@
+#ifndef UTIL_PARALLEL
+#define UTIL_PARALLEL
+
+#include <cstddef>
+#include <functional>
+
+namespace util {
+
+// Number of worker threads to use when the caller passes 0
+unsigned HardwareThreads();
+
+// Splits [begin, end) into contiguous ranges and calls body(range_begin, range_end) on up to `threads` threads.
+// Ranges never have less than `grain` elements, so small inputs run on the calling thread only.
+void ParallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t, std::size_t)>& body,
+                 unsigned threads = 0, std::size_t grain = 1);
+
+// Calls body(task_index, thread_index) for every task in [0, count), handing tasks out dynamically
+// so that uneven tasks (tiles, layers, chunks) keep every thread busy.
+void ParallelTasks(std::size_t count, const std::function<void(std::size_t, unsigned)>& body, unsigned threads = 0);
+
+}  // namespace util
+
+#endif
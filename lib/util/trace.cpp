@@ -0,0 +1,190 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> util::trace_detail::enabled(false);
+
+namespace {
+
+struct Event {
+    const char* name;
+    std::uint64_t start;
+    // Span length in nanoseconds, or the counter value
+    double value;
+    std::uint32_t frame;
+    bool counter;
+};
+
+struct Ring {
+    std::vector<Event> events;
+    // Events ever recorded; the ring holds the last events.size() of them
+    std::size_t recorded = 0;
+    std::uint32_t thread  = 0;
+    const char* name      = nullptr;
+};
+
+std::chrono::steady_clock::time_point trace_start;
+std::size_t ring_size = 0;
+std::atomic<std::uint32_t> frame(0);
+std::mutex rings_mutex;
+std::vector<std::unique_ptr<Ring>> rings;
+
+Ring& ThreadRing() {
+    thread_local Ring* ring = nullptr;
+    if (ring == nullptr) {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        rings.push_back(std::make_unique<Ring>());
+        ring         = rings.back().get();
+        ring->thread = static_cast<std::uint32_t>(rings.size());
+    }
+    return *ring;
+}
+
+void Record(const Event& event) {
+    Ring& ring = ThreadRing();
+    // The ring of a thread that started before TraceEnable is allocated by its first event
+    if (ring.events.empty()) {
+        ring.events.resize(ring_size);
+        if (ring.events.empty()) {
+            return;
+        }
+    }
+    ring.events[ring.recorded % ring.events.size()] = event;
+    ring.recorded++;
+}
+
+// Oldest first
+template <typename Visitor>
+void ForEachEvent(const Ring& ring, Visitor&& visit) {
+    std::size_t kept = std::min(ring.recorded, ring.events.size());
+    for (std::size_t i = ring.recorded - kept; i < ring.recorded; i++) {
+        visit(ring.events[i % ring.events.size()]);
+    }
+}
+
+}  // namespace
+
+void util::TraceEnable(std::size_t events_per_thread) {
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    trace_start = std::chrono::steady_clock::now();
+    ring_size   = events_per_thread;
+    trace_detail::enabled.store(true, std::memory_order_release);
+}
+
+std::uint64_t util::TraceNow() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace_start).count());
+}
+
+void util::TraceSpan(const char* name, std::uint64_t start, std::uint64_t duration) {
+    if (TraceEnabled()) {
+        Record({name, start, static_cast<double>(duration), frame.load(std::memory_order_relaxed), false});
+    }
+}
+
+void util::TraceCounter(const char* name, double value) {
+    if (TraceEnabled()) {
+        Record({name, TraceNow(), value, frame.load(std::memory_order_relaxed), true});
+    }
+}
+
+void util::TraceCounter(const char* name, double value, std::uint32_t measured_frame) {
+    if (TraceEnabled()) {
+        Record({name, TraceNow(), value, measured_frame, true});
+    }
+}
+
+void util::TraceThreadName(const char* name) {
+    ThreadRing().name = name;
+}
+
+void util::TraceFrame() {
+    frame.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint32_t util::TraceCurrentFrame() {
+    return frame.load(std::memory_order_relaxed);
+}
+
+bool util::WriteChromeTrace(const std::filesystem::path& path) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Impossible to open " << path << " for writing\n";
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    // Timestamps are in microseconds; names are identifiers from the code and need no escaping
+    file << "{\"traceEvents\":[\n";
+    const char* separator = "";
+    for (const std::unique_ptr<Ring>& ring : rings) {
+        if (ring->name != nullptr) {
+            file << separator << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << ring->thread
+                 << R"(,"args":{"name":")" << ring->name << "\"}}";
+            separator = ",\n";
+        }
+        ForEachEvent(*ring, [&](const Event& event) {
+            file << separator << R"({"name":")" << event.name << R"(","pid":1,"tid":)" << ring->thread
+                 << R"(,"ts":)" << event.start / 1000.0;
+            if (event.counter) {
+                file << R"(,"ph":"C","args":{"value":)" << event.value << "}}";
+            } else {
+                file << R"(,"ph":"X","dur":)" << event.value / 1000.0 << R"(,"args":{"frame":)" << event.frame
+                     << "}}";
+            }
+            separator = ",\n";
+        });
+    }
+    file << "\n]}\n";
+    return file.good();
+}
+
+bool util::WriteFrameCsv(const std::filesystem::path& path) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Impossible to open " << path << " for writing\n";
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    // Column per span or counter name, sorted so the columns do not depend on thread timing
+    std::map<std::string, std::size_t> columns;
+    for (const std::unique_ptr<Ring>& ring : rings) {
+        ForEachEvent(*ring, [&](const Event& event) {
+            columns.emplace(std::string(event.name) + (event.counter ? "" : "_ms"), 0);
+        });
+    }
+    std::size_t index = 0;
+    for (auto& [name, column] : columns) {
+        column = index++;
+    }
+
+    std::map<std::uint32_t, std::vector<double>> frames;
+    for (const std::unique_ptr<Ring>& ring : rings) {
+        ForEachEvent(*ring, [&](const Event& event) {
+            std::vector<double>& row = frames[event.frame];
+            row.resize(columns.size());
+            double& cell = row[columns[std::string(event.name) + (event.counter ? "" : "_ms")]];
+            cell         = event.counter ? event.value : cell + event.value / 1e6;
+        });
+    }
+
+    file << "frame";
+    for (const auto& [name, column] : columns) {
+        file << ',' << name;
+    }
+    file << '\n';
+    for (const auto& [number, row] : frames) {
+        file << number;
+        for (double value : row) {
+            file << ',' << value;
+        }
+        file << '\n';
+    }
+    return file.good();
+}
@@ -0,0 +1,69 @@
+#ifndef UTIL_TRACE
+#define UTIL_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace util {
+
+namespace trace_detail {
+extern std::atomic<bool> enabled;
+}
+
+// Starts recording. Every thread keeps the last events_per_thread events in its own ring buffer, so
+// recording never takes a lock after a thread's first event.
+void TraceEnable(std::size_t events_per_thread = 1 << 16);
+// Acquire pairs with the release in TraceEnable: a thread that sees true also sees the trace start and ring size
+inline bool TraceEnabled() {
+    return trace_detail::enabled.load(std::memory_order_acquire);
+}
+
+// Nanoseconds since TraceEnable
+std::uint64_t TraceNow();
+
+// Names must outlive the trace, string literals are the intended use. All of these do nothing while
+// tracing is disabled.
+void TraceSpan(const char* name, std::uint64_t start, std::uint64_t duration);
+void TraceCounter(const char* name, double value);
+// Counter measured during an earlier frame, such as a GPU time read back a few frames late
+void TraceCounter(const char* name, double value, std::uint32_t frame);
+// Names the calling thread in the trace. Unlike the events, the name is kept while tracing is disabled, so
+// threads started before TraceEnable are named too.
+void TraceThreadName(const char* name);
+// Starts the next frame; events are attributed to the frame current when they start
+void TraceFrame();
+std::uint32_t TraceCurrentFrame();
+
+// Records the lifetime of the scope as a span
+class TraceScope {
+public:
+    explicit TraceScope(const char* name)
+        : name_(TraceEnabled() ? name : nullptr)
+        , start_(name_ != nullptr ? TraceNow() : 0) {
+    }
+    TraceScope(const TraceScope&) = delete;
+    ~TraceScope() {
+        if (name_ != nullptr) {
+            TraceSpan(name_, start_, TraceNow() - start_);
+        }
+    }
+
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    std::uint64_t start_;
+};
+
+// Both must be called once the traced threads are idle. The Chrome trace loads in about:tracing or
+// ui.perfetto.dev; the CSV has one row per frame with the total milliseconds of every span name and the
+// last value of every counter.
+bool WriteChromeTrace(const std::filesystem::path& path);
+bool WriteFrameCsv(const std::filesystem::path& path);
+
+}  // namespace util
+
+#endif
@@ -0,0 +1,52 @@
+#include "worker_pool.h"
+
+#include "parallel.h"
+#include "trace.h"
+
+util::WorkerPool::WorkerPool(unsigned threads) {
+    if (threads == 0) {
+        threads = HardwareThreads();
+    }
+    threads_.reserve(threads);
+    for (unsigned i = 0; i < threads; i++) {
+        threads_.emplace_back(&WorkerPool::Run, this);
+    }
+}
+
+util::WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+void util::WorkerPool::Submit(std::function<void()> job) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    wake_.notify_one();
+}
+
+void util::WorkerPool::Run() {
+    TraceThreadName("worker");
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+            if (stop_) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        job();
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef UTIL_WORKER_POOL
+#define UTIL_WORKER_POOL
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+
+// Long-lived threads running submitted jobs in submission order. Unlike ParallelTasks the caller does not
+// wait: jobs report their results themselves, e.g. through an MpmcQueue.
+class WorkerPool {
+public:
+    // 0 threads means one per hardware thread
+    explicit WorkerPool(unsigned threads = 0);
+    WorkerPool(const WorkerPool&) = delete;
+    // Jobs that have not started yet are dropped, running ones are waited for
+    ~WorkerPool();
+
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void Submit(std::function<void()> job);
+
+    // Jobs queued or running
+    std::size_t pending() const { return pending_.load(std::memory_order_relaxed); }
+    unsigned size() const { return static_cast<unsigned>(threads_.size()); }
+
+private:
+    void Run();
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::function<void()>> jobs_;
+    bool stop_ = false;
+    std::atomic<std::size_t> pending_{0};
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace util
+
+#endif
@@ -1,130 +1,421 @@
 #include "vboindexer.hpp"
 
+#include <algorithm>
+#include <bit>
 #include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
 
-// Returns true iif v1 can be considered equal to v2
-bool is_near(float v1, float v2) {
-    return std::fabs(v1 - v2) < 0.01f;
-}
+#include "util/parallel.h"
+
+namespace {
+
+// Tolerance of the TBN indexer: vertices closer than this in every component are merged
+constexpr float kNearTolerance = 0.01f;
+// Grid cells of the TBN indexer are clamped to this range, far beyond any coordinate where the tolerance
+// still means something
+constexpr double kMaxCell = 1 << 30;
+// Inputs smaller than this are indexed on the calling thread when the caller lets us choose
+constexpr std::size_t kParallelThreshold = 1 << 16;
+constexpr std::uint32_t kEmpty           = std::numeric_limits<std::uint32_t>::max();
+
+// The eight floats of a vertex turned into comparable words for exact matching
+struct VertexKeys {
+    const std::vector<glm::vec3>& vertices;
+    const std::vector<glm::vec2>& uvs;
+    const std::vector<glm::vec3>& normals;
 
-// Searches through all already-exported vertices
-// for a similar one.
-// Similar = same position + same UVs + same normal
-bool getSimilarVertexIndex(glm::vec3& in_vertex, glm::vec2& in_uv, glm::vec3& in_normal,
-                           std::vector<glm::vec3>& out_vertices, std::vector<glm::vec2>& out_uvs,
-                           std::vector<glm::vec3>& out_normals, unsigned short& result) {
-    // Lame linear search
-    for (unsigned int i = 0; i < out_vertices.size(); i++) {
-        if (is_near(in_vertex.x, out_vertices[i].x) && is_near(in_vertex.y, out_vertices[i].y) &&
-            is_near(in_vertex.z, out_vertices[i].z) && is_near(in_uv.x, out_uvs[i].x) &&
-            is_near(in_uv.y, out_uvs[i].y) && is_near(in_normal.x, out_normals[i].x) &&
-            is_near(in_normal.y, out_normals[i].y) && is_near(in_normal.z, out_normals[i].z)) {
-            result = i;
-            return true;
+    static std::uint32_t Word(float value) { return std::bit_cast<std::uint32_t>(value); }
+
+    void Key(std::size_t i, std::uint32_t (&key)[8]) const {
+        key[0] = Word(vertices[i].x);
+        key[1] = Word(vertices[i].y);
+        key[2] = Word(vertices[i].z);
+        key[3] = Word(uvs[i].x);
+        key[4] = Word(uvs[i].y);
+        key[5] = Word(normals[i].x);
+        key[6] = Word(normals[i].y);
+        key[7] = Word(normals[i].z);
+    }
+
+    std::uint64_t Hash(std::size_t i) const {
+        std::uint32_t key[8];
+        Key(i, key);
+        std::uint64_t hash = 0;
+        for (std::uint32_t word : key) {
+            hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 29;
         }
+        return hash;
     }
-    // No other vertex could be used instead.
-    // Looks like we'll have to add it to the VBO.
-    return false;
-}
 
-void indexVBO_slow(std::vector<glm::vec3>& in_vertices, std::vector<glm::vec2>& in_uvs,
-                   std::vector<glm::vec3>& in_normals,
-
-                   std::vector<unsigned short>& out_indices, std::vector<glm::vec3>& out_vertices,
-                   std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals) {
-    // For each input vertex
-    for (unsigned int i = 0; i < in_vertices.size(); i++) {
-        // Try to find a similar vertex in out_XXXX
-        unsigned short index;
-        bool found =
-            getSimilarVertexIndex(in_vertices[i], in_uvs[i], in_normals[i], out_vertices, out_uvs, out_normals, index);
-
-        if (found) {  // A similar vertex is already in the VBO, use it instead !
-            out_indices.push_back(index);
-        } else {  // If not, it needs to be added in the output data.
-            out_vertices.push_back(in_vertices[i]);
-            out_uvs.push_back(in_uvs[i]);
-            out_normals.push_back(in_normals[i]);
-            out_indices.push_back((unsigned short)out_vertices.size() - 1);
+    bool Equal(std::size_t a, std::size_t b) const {
+        std::uint32_t key_a[8];
+        std::uint32_t key_b[8];
+        Key(a, key_a);
+        Key(b, key_b);
+        return std::equal(key_a, key_a + 8, key_b);
+    }
+};
+
+// Result of deduplication: for every input vertex the output vertex it maps to, and for the exact one the input
+// vertices grouped by hash shard
+struct Deduplication {
+    std::vector<std::uint32_t> out_index;
+    // Input indices of the output vertices, in output order
+    std::vector<std::uint32_t> unique;
+    // Input indices sorted by shard, in input order within a shard
+    std::vector<std::uint32_t> order;
+    std::vector<std::size_t> shard_begin;
+    unsigned threads;
+};
+
+// Deduplicates the input vertices. Vertices are distributed into shards by hash; every shard owns its own
+// open-addressing table and sees its vertices in input order, so shards run in parallel and the result is the
+// same as the one of a sequential pass.
+Deduplication Deduplicate(const VertexKeys& keys, std::size_t count, unsigned threads) {
+    if (threads == 0) {
+        threads = count >= kParallelThreshold ? util::HardwareThreads() : 1;
+    }
+    const unsigned shard_bits = threads == 1 ? 0 : static_cast<unsigned>(std::bit_width(4u * threads - 1));
+    const std::size_t shards  = std::size_t(1) << shard_bits;
+    const std::size_t ranges  = std::min<std::size_t>(std::max<std::size_t>(count, 1), threads);
+    auto range_begin          = [&](std::size_t range) { return count * range / ranges; };
+    auto shard_of             = [&](std::uint64_t hash) {
+        return shard_bits == 0 ? std::size_t(0) : static_cast<std::size_t>(hash >> (64 - shard_bits));
+    };
+
+    Deduplication result;
+    result.threads = threads;
+
+    std::vector<std::uint64_t> hashes(count);
+    // histogram[range * shards + shard]: vertices of a range that go to a shard
+    std::vector<std::size_t> histogram(ranges * shards, 0);
+    util::ParallelTasks(
+        ranges,
+        [&](std::size_t range, unsigned) {
+            for (std::size_t i = range_begin(range); i < range_begin(range + 1); i++) {
+                hashes[i] = keys.Hash(i);
+                histogram[range * shards + shard_of(hashes[i])]++;
+            }
+        },
+        threads);
+
+    // Stable scatter of the vertex indices into shard order
+    result.shard_begin.assign(shards + 1, 0);
+    std::vector<std::size_t> offsets(ranges * shards);
+    std::size_t offset = 0;
+    for (std::size_t shard = 0; shard < shards; shard++) {
+        result.shard_begin[shard] = offset;
+        for (std::size_t range = 0; range < ranges; range++) {
+            offsets[range * shards + shard] = offset;
+            offset += histogram[range * shards + shard];
         }
     }
+    result.shard_begin[shards] = offset;
+    result.order.resize(count);
+    util::ParallelTasks(
+        ranges,
+        [&](std::size_t range, unsigned) {
+            for (std::size_t i = range_begin(range); i < range_begin(range + 1); i++) {
+                result.order[offsets[range * shards + shard_of(hashes[i])]++] = static_cast<std::uint32_t>(i);
+            }
+        },
+        threads);
+
+    // first[i]: the first input vertex with the same key as vertex i
+    std::vector<std::uint32_t> first(count);
+    util::ParallelTasks(
+        shards,
+        [&](std::size_t shard, unsigned) {
+            const std::size_t begin = result.shard_begin[shard];
+            const std::size_t end   = result.shard_begin[shard + 1];
+            std::vector<std::uint32_t> table(std::bit_ceil(std::max<std::size_t>(2 * (end - begin), 16)), kEmpty);
+            const std::size_t mask = table.size() - 1;
+            for (std::size_t k = begin; k < end; k++) {
+                std::uint32_t i = result.order[k];
+                // The top bits of the hash chose the shard, the low bits pick the slot
+                for (std::size_t slot = hashes[i] & mask;; slot = (slot + 1) & mask) {
+                    if (table[slot] == kEmpty) {
+                        table[slot] = i;
+                        first[i]    = i;
+                        break;
+                    }
+                    if (hashes[table[slot]] == hashes[i] && keys.Equal(table[slot], i)) {
+                        first[i] = table[slot];
+                        break;
+                    }
+                }
+            }
+        },
+        threads);
+
+    // Output indices follow the first occurrences in input order: count per range, prefix sum, assign
+    std::vector<std::size_t> unique_before(ranges + 1, 0);
+    util::ParallelTasks(
+        ranges,
+        [&](std::size_t range, unsigned) {
+            for (std::size_t i = range_begin(range); i < range_begin(range + 1); i++) {
+                unique_before[range + 1] += first[i] == i ? 1 : 0;
+            }
+        },
+        threads);
+    for (std::size_t range = 0; range < ranges; range++) {
+        unique_before[range + 1] += unique_before[range];
+    }
+    result.unique.resize(unique_before[ranges]);
+    result.out_index.resize(count);
+    util::ParallelTasks(
+        ranges,
+        [&](std::size_t range, unsigned) {
+            std::size_t next = unique_before[range];
+            for (std::size_t i = range_begin(range); i < range_begin(range + 1); i++) {
+                if (first[i] == i) {
+                    result.unique[next] = static_cast<std::uint32_t>(i);
+                    result.out_index[i] = static_cast<std::uint32_t>(next++);
+                }
+            }
+        },
+        threads);
+    util::ParallelFor(
+        0, count,
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                if (first[i] != i) {
+                    result.out_index[i] = result.out_index[first[i]];
+                }
+            }
+        },
+        threads);
+    return result;
 }
 
-struct PackedVertex {
-    glm::vec3 position;
-    glm::vec2 uv;
-    glm::vec3 normal;
-    bool operator<(const PackedVertex that) const {
-        return memcmp((void*)this, (void*)&that, sizeof(PackedVertex)) > 0;
-    };
+bool IsNear(float a, float b) {
+    return std::fabs(a - b) < kNearTolerance;
+}
+
+// Cell of a coordinate in a grid twice the tolerance wide, and the range of cells [first, last] that may hold
+// values within the tolerance: the neighbour on the side of the half the value lies in. The halves overlap a
+// little so that rounding never misses a neighbour.
+struct NearCells {
+    std::int64_t cell;
+    std::int64_t first;
+    std::int64_t last;
 };
 
-bool getSimilarVertexIndex_fast(PackedVertex& packed, std::map<PackedVertex, unsigned short>& VertexToOutIndex,
-                                unsigned short& result) {
-    std::map<PackedVertex, unsigned short>::iterator it = VertexToOutIndex.find(packed);
-    if (it == VertexToOutIndex.end()) {
-        return false;
-    } else {
-        result = it->second;
-        return true;
+NearCells CellsNear(float value) {
+    const double position = static_cast<double>(value) / (2 * kNearTolerance);
+    const double cell     = std::floor(position);
+    if (std::isnan(cell) || std::fabs(cell) >= kMaxCell) {
+        const auto clamped = static_cast<std::int64_t>(std::isnan(cell) ? 0.0 : std::clamp(cell, -kMaxCell, kMaxCell));
+        return {clamped, clamped - 1, clamped + 1};
     }
+    const double fraction = position - cell;
+    const auto index      = static_cast<std::int64_t>(cell);
+    return {index, fraction < 0.51 ? index - 1 : index, fraction > 0.49 ? index + 1 : index};
 }
 
-void indexVBO(std::vector<glm::vec3>& in_vertices, std::vector<glm::vec2>& in_uvs, std::vector<glm::vec3>& in_normals,
+// Deduplication of the TBN indexer: every vertex maps to the first earlier output vertex whose eight components
+// are all within kNearTolerance of its own, as the linear is_near search did. Matches are not transitive, which
+// ties the result to input order, so the search is sequential. Bitwise equal vertices always map to the same
+// output, so the parallel exact deduplication goes first and the search only sees its unique vertices. Output
+// positions are bucketed by cell, and only the few cells around a vertex that can hold a match are searched.
+Deduplication DeduplicateNear(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec2>& uvs,
+                              const std::vector<glm::vec3>& normals, unsigned threads) {
+    const Deduplication exact = Deduplicate(VertexKeys{vertices, uvs, normals}, vertices.size(), threads);
+    const std::size_t count   = exact.unique.size();
+    Deduplication result;
+    result.threads = exact.threads;
+    // near_index[k]: output vertex of the exact unique vertex k
+    std::vector<std::uint32_t> near_index(count);
 
-              std::vector<unsigned short>& out_indices, std::vector<glm::vec3>& out_vertices,
-              std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals) {
-    std::map<PackedVertex, unsigned short> VertexToOutIndex;
-
-    // For each input vertex
-    for (unsigned int i = 0; i < in_vertices.size(); i++) {
-        PackedVertex packed = {in_vertices[i], in_uvs[i], in_normals[i]};
-
-        // Try to find a similar vertex in out_XXXX
-        unsigned short index;
-        bool found = getSimilarVertexIndex_fast(packed, VertexToOutIndex, index);
-
-        if (found) {  // A similar vertex is already in the VBO, use it instead !
-            out_indices.push_back(index);
-        } else {  // If not, it needs to be added in the output data.
-            out_vertices.push_back(in_vertices[i]);
-            out_uvs.push_back(in_uvs[i]);
-            out_normals.push_back(in_normals[i]);
-            unsigned short newindex = (unsigned short)out_vertices.size() - 1;
-            out_indices.push_back(newindex);
-            VertexToOutIndex[packed] = newindex;
+    auto cell_hash = [](std::int64_t x, std::int64_t y, std::int64_t z) {
+        std::uint64_t hash = 0;
+        for (std::int64_t word : {x, y, z}) {
+            hash = (hash ^ static_cast<std::uint64_t>(word)) * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 29;
+        }
+        return hash;
+    };
+    auto near = [&](std::uint32_t a, std::uint32_t b) {
+        return IsNear(vertices[a].x, vertices[b].x) && IsNear(vertices[a].y, vertices[b].y) &&
+               IsNear(vertices[a].z, vertices[b].z) && IsNear(uvs[a].x, uvs[b].x) && IsNear(uvs[a].y, uvs[b].y) &&
+               IsNear(normals[a].x, normals[b].x) && IsNear(normals[a].y, normals[b].y) &&
+               IsNear(normals[a].z, normals[b].z);
+    };
+    // Output vertices of every cell hash as linked lists in output order, whose ends are in an open-addressing
+    // table; a hash collision only adds candidates. The first match of a list is its earliest one.
+    std::vector<std::uint64_t> slot_hashes(std::bit_ceil(std::max<std::size_t>(2 * count, 16)));
+    std::vector<std::uint32_t> heads(slot_hashes.size(), kEmpty);
+    std::vector<std::uint32_t> tails(slot_hashes.size(), kEmpty);
+    const std::size_t mask = heads.size() - 1;
+    auto slot_of           = [&](std::uint64_t hash) {
+        std::size_t slot = hash & mask;
+        while (heads[slot] != kEmpty && slot_hashes[slot] != hash) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    };
+    std::vector<std::uint32_t> next;
+    for (std::size_t k = 0; k < count; k++) {
+        const std::uint32_t i = exact.unique[k];
+        const NearCells cx    = CellsNear(vertices[i].x);
+        const NearCells cy    = CellsNear(vertices[i].y);
+        const NearCells cz    = CellsNear(vertices[i].z);
+        std::uint32_t match   = kEmpty;
+        for (std::int64_t x = cx.first; x <= cx.last; x++) {
+            for (std::int64_t y = cy.first; y <= cy.last; y++) {
+                for (std::int64_t z = cz.first; z <= cz.last; z++) {
+                    // kEmpty ends a list and is above every output index
+                    for (std::uint32_t out = heads[slot_of(cell_hash(x, y, z))]; out < match; out = next[out]) {
+                        if (near(result.unique[out], i)) {
+                            match = out;
+                        }
+                    }
+                }
+            }
+        }
+        if (match == kEmpty) {
+            match = static_cast<std::uint32_t>(result.unique.size());
+            result.unique.push_back(i);
+            const std::uint64_t hash = cell_hash(cx.cell, cy.cell, cz.cell);
+            const std::size_t slot   = slot_of(hash);
+            next.push_back(kEmpty);
+            if (heads[slot] == kEmpty) {
+                heads[slot]       = match;
+                slot_hashes[slot] = hash;
+            } else {
+                next[tails[slot]] = match;
+            }
+            tails[slot] = match;
         }
+        near_index[k] = match;
     }
+
+    result.out_index.resize(vertices.size());
+    util::ParallelFor(
+        0, vertices.size(),
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                result.out_index[i] = near_index[exact.out_index[i]];
+            }
+        },
+        result.threads);
+    return result;
+}
+
+template <typename Index>
+bool FitsIndex(std::size_t unique_count) {
+    if (unique_count > static_cast<std::size_t>(std::numeric_limits<Index>::max()) + 1) {
+        std::cerr << "vboindexer: " << unique_count << " unique vertices do not fit " << sizeof(Index) * 8
+                  << "-bit indices\n";
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+void Gather(const std::vector<T>& in, const Deduplication& dedup, std::vector<T>& out) {
+    out.resize(dedup.unique.size());
+    util::ParallelFor(
+        0, out.size(),
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                out[i] = in[dedup.unique[i]];
+            }
+        },
+        dedup.threads);
+}
+
+template <typename Index>
+bool IndexVertices(const std::vector<glm::vec3>& in_vertices, const std::vector<glm::vec2>& in_uvs,
+                   const std::vector<glm::vec3>& in_normals, std::vector<Index>& out_indices,
+                   std::vector<glm::vec3>& out_vertices, std::vector<glm::vec2>& out_uvs,
+                   std::vector<glm::vec3>& out_normals, unsigned threads) {
+    Deduplication dedup = Deduplicate(VertexKeys{in_vertices, in_uvs, in_normals}, in_vertices.size(), threads);
+    if (!FitsIndex<Index>(dedup.unique.size())) {
+        out_indices.clear();
+        out_vertices.clear();
+        out_uvs.clear();
+        out_normals.clear();
+        return false;
+    }
+    out_indices.assign(dedup.out_index.begin(), dedup.out_index.end());
+    Gather(in_vertices, dedup, out_vertices);
+    Gather(in_uvs, dedup, out_uvs);
+    Gather(in_normals, dedup, out_normals);
+    return true;
 }
 
-void indexVBO_TBN(std::vector<glm::vec3>& in_vertices, std::vector<glm::vec2>& in_uvs,
-                  std::vector<glm::vec3>& in_normals, std::vector<glm::vec3>& in_tangents,
-                  std::vector<glm::vec3>& in_bitangents,
+template <typename Index>
+bool IndexVerticesTBN(const std::vector<glm::vec3>& in_vertices, const std::vector<glm::vec2>& in_uvs,
+                      const std::vector<glm::vec3>& in_normals, const std::vector<glm::vec3>& in_tangents,
+                      const std::vector<glm::vec3>& in_bitangents, std::vector<Index>& out_indices,
+                      std::vector<glm::vec3>& out_vertices, std::vector<glm::vec2>& out_uvs,
+                      std::vector<glm::vec3>& out_normals, std::vector<glm::vec3>& out_tangents,
+                      std::vector<glm::vec3>& out_bitangents, unsigned threads) {
+    Deduplication dedup = DeduplicateNear(in_vertices, in_uvs, in_normals, threads);
+    if (!FitsIndex<Index>(dedup.unique.size())) {
+        out_indices.clear();
+        out_vertices.clear();
+        out_uvs.clear();
+        out_normals.clear();
+        out_tangents.clear();
+        out_bitangents.clear();
+        return false;
+    }
+    out_indices.assign(dedup.out_index.begin(), dedup.out_index.end());
+    Gather(in_vertices, dedup, out_vertices);
+    Gather(in_uvs, dedup, out_uvs);
+    Gather(in_normals, dedup, out_normals);
+
+    // Average the tangents and the bitangents
+    out_tangents.assign(dedup.unique.size(), glm::vec3(0));
+    out_bitangents.assign(dedup.unique.size(), glm::vec3(0));
+    for (std::size_t i = 0; i < in_vertices.size(); i++) {
+        out_tangents[dedup.out_index[i]] += in_tangents[i];
+        out_bitangents[dedup.out_index[i]] += in_bitangents[i];
+    }
+    return true;
+}
+
+}  // namespace
+
+bool indexVBO(const std::vector<glm::vec3>& in_vertices, const std::vector<glm::vec2>& in_uvs,
+              const std::vector<glm::vec3>& in_normals,
+
+              std::vector<unsigned short>& out_indices, std::vector<glm::vec3>& out_vertices,
+              std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals, unsigned threads) {
+    return IndexVertices(in_vertices, in_uvs, in_normals, out_indices, out_vertices, out_uvs, out_normals, threads);
+}
+
+bool indexVBO(const std::vector<glm::vec3>& in_vertices, const std::vector<glm::vec2>& in_uvs,
+              const std::vector<glm::vec3>& in_normals,
+
+              std::vector<unsigned int>& out_indices, std::vector<glm::vec3>& out_vertices,
+              std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals, unsigned threads) {
+    return IndexVertices(in_vertices, in_uvs, in_normals, out_indices, out_vertices, out_uvs, out_normals, threads);
+}
+
+bool indexVBO_TBN(const std::vector<glm::vec3>& in_vertices, const std::vector<glm::vec2>& in_uvs,
+                  const std::vector<glm::vec3>& in_normals, const std::vector<glm::vec3>& in_tangents,
+                  const std::vector<glm::vec3>& in_bitangents,
 
                   std::vector<unsigned short>& out_indices, std::vector<glm::vec3>& out_vertices,
                   std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals,
-                  std::vector<glm::vec3>& out_tangents, std::vector<glm::vec3>& out_bitangents) {
-    // For each input vertex
-    for (unsigned int i = 0; i < in_vertices.size(); i++) {
-        // Try to find a similar vertex in out_XXXX
-        unsigned short index;
-        bool found =
-            getSimilarVertexIndex(in_vertices[i], in_uvs[i], in_normals[i], out_vertices, out_uvs, out_normals, index);
-
-        if (found) {  // A similar vertex is already in the VBO, use it instead !
-            out_indices.push_back(index);
-
-            // Average the tangents and the bitangents
-            out_tangents[index] += in_tangents[i];
-            out_bitangents[index] += in_bitangents[i];
-        } else {  // If not, it needs to be added in the output data.
-            out_vertices.push_back(in_vertices[i]);
-            out_uvs.push_back(in_uvs[i]);
-            out_normals.push_back(in_normals[i]);
-            out_tangents.push_back(in_tangents[i]);
-            out_bitangents.push_back(in_bitangents[i]);
-            out_indices.push_back((unsigned short)out_vertices.size() - 1);
-        }
-    }
+                  std::vector<glm::vec3>& out_tangents, std::vector<glm::vec3>& out_bitangents, unsigned threads) {
+    return IndexVerticesTBN(in_vertices, in_uvs, in_normals, in_tangents, in_bitangents, out_indices, out_vertices,
+                            out_uvs, out_normals, out_tangents, out_bitangents, threads);
+}
+
+bool indexVBO_TBN(const std::vector<glm::vec3>& in_vertices, const std::vector<glm::vec2>& in_uvs,
+                  const std::vector<glm::vec3>& in_normals, const std::vector<glm::vec3>& in_tangents,
+                  const std::vector<glm::vec3>& in_bitangents,
+
+                  std::vector<unsigned int>& out_indices, std::vector<glm::vec3>& out_vertices,
+                  std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals,
+                  std::vector<glm::vec3>& out_tangents, std::vector<glm::vec3>& out_bitangents, unsigned threads) {
+    return IndexVerticesTBN(in_vertices, in_uvs, in_normals, in_tangents, in_bitangents, out_indices, out_vertices,
+                            out_uvs, out_normals, out_tangents, out_bitangents, threads);
 }
@@ -1,23 +1,50 @@
 #ifndef VBOINDEXER_HPP
 #define VBOINDEXER_HPP
 
-#include <string.h>  // for memcmp
-
 #include <glm/glm.hpp>
-#include <map>
 #include <vector>
 
-void indexVBO(std::vector<glm::vec3>& in_vertices, std::vector<glm::vec2>& in_uvs, std::vector<glm::vec3>& in_normals,
+// Both indexers merge duplicate (position, uv, normal) vertices through hash tables in about linear time.
+// Output vertices keep the order of their first occurrence, whatever the thread count.
+//
+// The index type picks 16- or 32-bit indices. With unsigned short the functions return false and leave the
+// outputs empty when the mesh has more than 65536 unique vertices instead of silently wrapping indices.
+//
+// threads: 0 chooses automatically (inputs of 65536 vertices and more are indexed on all cores),
+// any other value is used as is.
+
+// Vertices are merged only when they are bitwise equal
+bool indexVBO(const std::vector<glm::vec3>& in_vertices, const std::vector<glm::vec2>& in_uvs,
+              const std::vector<glm::vec3>& in_normals,
 
               std::vector<unsigned short>& out_indices, std::vector<glm::vec3>& out_vertices,
-              std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals);
+              std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals, unsigned threads = 0);
+
+bool indexVBO(const std::vector<glm::vec3>& in_vertices, const std::vector<glm::vec2>& in_uvs,
+              const std::vector<glm::vec3>& in_normals,
+
+              std::vector<unsigned int>& out_indices, std::vector<glm::vec3>& out_vertices,
+              std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals, unsigned threads = 0);
 
-void indexVBO_TBN(std::vector<glm::vec3>& in_vertices, std::vector<glm::vec2>& in_uvs,
-                  std::vector<glm::vec3>& in_normals, std::vector<glm::vec3>& in_tangents,
-                  std::vector<glm::vec3>& in_bitangents,
+// Vertices are merged into the first earlier output vertex whose every component is within 0.01 of theirs (the
+// is_near tolerance), as the linear search did; tangents and bitangents of merged vertices are summed. Only
+// the bitwise equal vertices are merged in parallel, the tolerant matching between the rest is sequential.
+bool indexVBO_TBN(const std::vector<glm::vec3>& in_vertices, const std::vector<glm::vec2>& in_uvs,
+                  const std::vector<glm::vec3>& in_normals, const std::vector<glm::vec3>& in_tangents,
+                  const std::vector<glm::vec3>& in_bitangents,
 
                   std::vector<unsigned short>& out_indices, std::vector<glm::vec3>& out_vertices,
                   std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals,
-                  std::vector<glm::vec3>& out_tangents, std::vector<glm::vec3>& out_bitangents);
+                  std::vector<glm::vec3>& out_tangents, std::vector<glm::vec3>& out_bitangents,
+                  unsigned threads = 0);
+
+bool indexVBO_TBN(const std::vector<glm::vec3>& in_vertices, const std::vector<glm::vec2>& in_uvs,
+                  const std::vector<glm::vec3>& in_normals, const std::vector<glm::vec3>& in_tangents,
+                  const std::vector<glm::vec3>& in_bitangents,
+
+                  std::vector<unsigned int>& out_indices, std::vector<glm::vec3>& out_vertices,
+                  std::vector<glm::vec2>& out_uvs, std::vector<glm::vec3>& out_normals,
+                  std::vector<glm::vec3>& out_tangents, std::vector<glm::vec3>& out_bitangents,
+                  unsigned threads = 0);
 
-#endif
\ No newline at end of file
+#endif
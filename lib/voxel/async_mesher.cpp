@@ -0,0 +1,101 @@
+#include "async_mesher.h"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+#include "util/parallel.h"
+#include "util/trace.h"
+
+namespace {
+
+constexpr std::size_t kFinishedCapacity = 1024;
+
+// The chunk itself and the six face neighbours the mesher reads to cull border faces
+const glm::ivec3 kMeshedChunks[7] = {{0, 0, 0},  {1, 0, 0}, {-1, 0, 0}, {0, 1, 0},
+                                     {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+
+unsigned MeshingThreads(unsigned threads) {
+    if (threads != 0) {
+        return threads;
+    }
+    return std::max(1u, util::HardwareThreads() - 1);
+}
+
+std::unique_ptr<voxel::VoxelGrid::Chunk> CopyChunk(const voxel::VoxelGrid::Chunk& chunk) {
+    auto copy    = std::make_unique<voxel::VoxelGrid::Chunk>();
+    copy->bits   = chunk.bits;
+    copy->colors = chunk.colors;
+    copy->count  = chunk.count;
+    return copy;
+}
+
+}  // namespace
+
+voxel::AsyncMesher::AsyncMesher(const VoxelGrid& grid, std::shared_mutex& grid_mutex, const MeshOptions& options,
+                                unsigned threads)
+    : grid_(&grid)
+    , grid_mutex_(&grid_mutex)
+    , options_(options)
+    , finished_(kFinishedCapacity)
+    , pool_(MeshingThreads(threads)) {
+}
+
+voxel::AsyncMesher::~AsyncMesher() {
+    // Workers blocked on a full queue give up instead of waiting for a Poll that never comes
+    stopping_.store(true, std::memory_order_relaxed);
+}
+
+void voxel::AsyncMesher::Request(const std::vector<glm::ivec3>& chunk_keys) {
+    for (const glm::ivec3& key : chunk_keys) {
+        std::uint64_t generation = next_generation_++;
+        generations_[key]        = generation;
+        requested_++;
+        pool_.Submit([this, key, generation] { Build(key, generation); });
+    }
+}
+
+std::size_t voxel::AsyncMesher::Poll(std::deque<ChunkMeshResult>& ready) {
+    std::size_t moved = 0;
+    std::unique_ptr<ChunkMeshResult> result;
+    while (finished_.TryPop(result)) {
+        returned_++;
+        if (Current(*result)) {
+            ready.push_back(std::move(*result));
+            moved++;
+        }
+    }
+    return moved;
+}
+
+bool voxel::AsyncMesher::Current(const ChunkMeshResult& result) const {
+    auto it = generations_.find(result.key);
+    return it != generations_.end() && it->second == result.generation;
+}
+
+void voxel::AsyncMesher::Build(const glm::ivec3& key, std::uint64_t generation) {
+    util::TraceScope trace_build("mesh_build");
+    // Mesh a private copy, so the grid is only locked while copying
+    thread_local VoxelGrid snapshot;
+    snapshot.Clear();
+    {
+        std::shared_lock<std::shared_mutex> lock(*grid_mutex_);
+        for (const glm::ivec3& offset : kMeshedChunks) {
+            const VoxelGrid::Chunk* chunk = grid_->FindChunk(key + offset);
+            if (chunk != nullptr) {
+                snapshot.InsertChunk(key + offset, CopyChunk(*chunk));
+            }
+        }
+    }
+
+    auto result        = std::make_unique<ChunkMeshResult>();
+    result->key        = key;
+    result->generation = generation;
+    MeshChunk(snapshot, key, options_, result->mesh, &result->stats);
+    while (!finished_.TryPush(std::move(result))) {
+        if (stopping_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
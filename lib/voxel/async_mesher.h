@@ -0,0 +1,74 @@
+#ifndef VOXEL_ASYNC_MESHER
+#define VOXEL_ASYNC_MESHER
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <glm/glm.hpp>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "greedy_mesher.h"
+#include "util/mpmc_queue.h"
+#include "util/worker_pool.h"
+#include "voxel_grid.h"
+
+namespace voxel {
+
+struct ChunkMeshResult {
+    glm::ivec3 key;
+    std::uint64_t generation = 0;
+    // Empty when the chunk has no visible faces or no longer exists
+    BlockMesh mesh;
+    MeshStats stats;
+};
+
+// Meshes chunks on background threads. Requests and polls come from one thread, the one that owns the grid;
+// it must hold grid_mutex exclusively while changing the grid. Workers hold it shared only while copying a
+// chunk and its neighbours, so an edit waits for a few copies at most, never for meshing.
+class AsyncMesher {
+public:
+    // 0 threads leaves one hardware thread to the caller
+    AsyncMesher(const VoxelGrid& grid, std::shared_mutex& grid_mutex, const MeshOptions& options,
+                unsigned threads = 0);
+    AsyncMesher(const AsyncMesher&) = delete;
+    ~AsyncMesher();
+
+    AsyncMesher& operator=(const AsyncMesher&) = delete;
+
+    // Queues the chunks for meshing; results of earlier requests for the same chunks become stale
+    void Request(const std::vector<glm::ivec3>& chunk_keys);
+
+    // Moves finished meshes to the back of ready, dropping stale ones, and returns how many were moved
+    std::size_t Poll(std::deque<ChunkMeshResult>& ready);
+
+    // False once a later request for the same chunk was made
+    bool Current(const ChunkMeshResult& result) const;
+
+    // Requested chunks not returned by Poll yet
+    std::size_t in_flight() const { return requested_ - returned_; }
+
+private:
+    void Build(const glm::ivec3& key, std::uint64_t generation);
+
+    const VoxelGrid* grid_;
+    std::shared_mutex* grid_mutex_;
+    MeshOptions options_;
+
+    std::unordered_map<glm::ivec3, std::uint64_t, VoxelGrid::ChunkKeyHash> generations_;
+    std::uint64_t next_generation_ = 1;
+    std::size_t requested_         = 0;
+    std::size_t returned_          = 0;
+
+    std::atomic<bool> stopping_{false};
+    util::MpmcQueue<std::unique_ptr<ChunkMeshResult>> finished_;
+    // Declared last so that the workers are joined before anything they use goes away
+    util::WorkerPool pool_;
+};
+
+}  // namespace voxel
+
+#endif
@@ -0,0 +1,75 @@
+#include "block_editor.h"
+
+#include <algorithm>
+
+bool voxel::BlockEditor::Add(const glm::ivec3& cell, std::uint16_t color) {
+    if (grid_->Contains(cell)) {
+        return Recolor(cell, color);
+    }
+    grid_->Set(cell, color);
+    MarkOccupancy(cell);
+    return true;
+}
+
+bool voxel::BlockEditor::Remove(const glm::ivec3& cell) {
+    if (!grid_->Erase(cell)) {
+        return false;
+    }
+    MarkOccupancy(cell);
+    return true;
+}
+
+bool voxel::BlockEditor::Recolor(const glm::ivec3& cell, std::uint16_t color) {
+    if (!grid_->Contains(cell) || grid_->Color(cell) == color) {
+        return false;
+    }
+    grid_->Set(cell, color);
+    // Colors only merge faces inside the chunk, neighbours mesh the same
+    dirty_.insert(VoxelGrid::ChunkOf(cell));
+    return true;
+}
+
+std::size_t voxel::BlockEditor::Apply(const std::vector<BlockEdit>& edits) {
+    std::size_t changed = 0;
+    for (const BlockEdit& edit : edits) {
+        bool applied = false;
+        switch (edit.kind) {
+        case BlockEdit::Kind::kAdd:
+            applied = Add(edit.cell, edit.color);
+            break;
+        case BlockEdit::Kind::kRemove:
+            applied = Remove(edit.cell);
+            break;
+        case BlockEdit::Kind::kRecolor:
+            applied = Recolor(edit.cell, edit.color);
+            break;
+        }
+        changed += applied ? 1 : 0;
+    }
+    return changed;
+}
+
+std::vector<glm::ivec3> voxel::BlockEditor::TakeDirtyChunks() {
+    std::vector<glm::ivec3> keys(dirty_.begin(), dirty_.end());
+    dirty_.clear();
+    std::sort(keys.begin(), keys.end(), [](const glm::ivec3& a, const glm::ivec3& b) {
+        return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+    });
+    return keys;
+}
+
+void voxel::BlockEditor::MarkOccupancy(const glm::ivec3& cell) {
+    const glm::ivec3 key   = VoxelGrid::ChunkOf(cell);
+    const glm::ivec3 local = cell - key * VoxelGrid::kChunkSize;
+    dirty_.insert(key);
+    // The mesher culls border faces against the six face neighbours only
+    for (int axis = 0; axis < 3; axis++) {
+        glm::ivec3 step(0);
+        step[axis] = 1;
+        if (local[axis] == 0) {
+            dirty_.insert(key - step);
+        } else if (local[axis] == VoxelGrid::kChunkMask) {
+            dirty_.insert(key + step);
+        }
+    }
+}
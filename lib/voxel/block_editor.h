@@ -0,0 +1,56 @@
+#ifndef VOXEL_BLOCK_EDITOR
+#define VOXEL_BLOCK_EDITOR
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <unordered_set>
+#include <vector>
+
+#include "voxel_grid.h"
+
+namespace voxel {
+
+struct BlockEdit {
+    enum class Kind { kAdd, kRemove, kRecolor };
+
+    Kind kind = Kind::kAdd;
+    glm::ivec3 cell;
+    // Palette index for kAdd and kRecolor
+    std::uint16_t color = 0;
+};
+
+// Changes the blocks of a grid at runtime and keeps the set of chunks whose meshes the changes invalidate:
+// the chunk of every changed cell and, when occupancy changes on a chunk border, the neighbour across it.
+class BlockEditor {
+public:
+    explicit BlockEditor(VoxelGrid& grid)
+        : grid_(&grid) {
+    }
+
+    // Each returns true if the grid changed: adding an existing block only changes its color,
+    // removing or recoloring a missing block does nothing
+    bool Add(const glm::ivec3& cell, std::uint16_t color = 0);
+    bool Remove(const glm::ivec3& cell);
+    bool Recolor(const glm::ivec3& cell, std::uint16_t color);
+
+    // Applies the edits in order and returns how many changed the grid
+    std::size_t Apply(const std::vector<BlockEdit>& edits);
+
+    const VoxelGrid& grid() const { return *grid_; }
+    bool dirty() const { return !dirty_.empty(); }
+
+    // Keys of the chunks to remesh since the last call, sorted. Chunks that lost their last block are
+    // included and no longer exist in the grid.
+    std::vector<glm::ivec3> TakeDirtyChunks();
+
+private:
+    void MarkOccupancy(const glm::ivec3& cell);
+
+    VoxelGrid* grid_;
+    std::unordered_set<glm::ivec3, VoxelGrid::ChunkKeyHash> dirty_;
+};
+
+}  // namespace voxel
+
+#endif
@@ -0,0 +1,134 @@
+#include "block_palette.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "util/parallel.h"
+
+namespace {
+
+float SrgbToLinear(float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+// CIE Lab under the D65 white point
+glm::vec3 SrgbToLab(const glm::vec3& srgb) {
+    glm::vec3 rgb(SrgbToLinear(srgb.x), SrgbToLinear(srgb.y), SrgbToLinear(srgb.z));
+    glm::vec3 xyz(0.4124564f * rgb.x + 0.3575761f * rgb.y + 0.1804375f * rgb.z,
+                  0.2126729f * rgb.x + 0.7151522f * rgb.y + 0.0721750f * rgb.z,
+                  0.0193339f * rgb.x + 0.1191920f * rgb.y + 0.9503041f * rgb.z);
+    xyz /= glm::vec3(0.95047f, 1.0f, 1.08883f);
+    auto f = [](float t) { return t > 0.008856f ? std::cbrt(t) : 7.787f * t + 16.0f / 116.0f; };
+    glm::vec3 v(f(xyz.x), f(xyz.y), f(xyz.z));
+    return glm::vec3(116.0f * v.y - 16.0f, 500.0f * (v.x - v.y), 200.0f * (v.y - v.z));
+}
+
+std::uint16_t NearestLab(const std::vector<glm::vec3>& lab, const glm::vec3& color) {
+    std::uint16_t best   = 0;
+    float best_distance  = std::numeric_limits<float>::max();
+    for (std::size_t i = 0; i < lab.size(); i++) {
+        glm::vec3 delta = lab[i] - color;
+        float distance  = glm::dot(delta, delta);
+        if (distance < best_distance) {
+            best          = static_cast<std::uint16_t>(i);
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+}  // namespace
+
+voxel::BlockPalette voxel::BlockPalette::Default() {
+    auto rgb = [](int r, int g, int b) { return glm::vec3(r, g, b) / 255.0f; };
+    return BlockPalette({
+        {"minecraft:white_concrete", rgb(207, 213, 214)},
+        {"minecraft:orange_concrete", rgb(224, 97, 1)},
+        {"minecraft:magenta_concrete", rgb(169, 48, 159)},
+        {"minecraft:light_blue_concrete", rgb(36, 137, 199)},
+        {"minecraft:yellow_concrete", rgb(241, 175, 21)},
+        {"minecraft:lime_concrete", rgb(94, 169, 24)},
+        {"minecraft:pink_concrete", rgb(214, 101, 143)},
+        {"minecraft:gray_concrete", rgb(55, 58, 62)},
+        {"minecraft:light_gray_concrete", rgb(125, 125, 115)},
+        {"minecraft:cyan_concrete", rgb(21, 119, 136)},
+        {"minecraft:purple_concrete", rgb(100, 32, 156)},
+        {"minecraft:blue_concrete", rgb(45, 47, 143)},
+        {"minecraft:brown_concrete", rgb(96, 60, 32)},
+        {"minecraft:green_concrete", rgb(73, 91, 36)},
+        {"minecraft:red_concrete", rgb(142, 33, 33)},
+        {"minecraft:black_concrete", rgb(8, 10, 15)},
+    });
+}
+
+bool voxel::BlockPalette::Load(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Impossible to open " << path << '\n';
+        return false;
+    }
+    std::vector<Block> blocks;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream record(line);
+        Block block;
+        glm::ivec3 rgb;
+        if (!(record >> block.name) || block.name[0] == '#') {
+            continue;
+        }
+        if (!(record >> rgb.x >> rgb.y >> rgb.z)) {
+            std::cerr << "Malformed palette line in " << path << ": " << line << '\n';
+            return false;
+        }
+        block.color = glm::vec3(glm::clamp(rgb, glm::ivec3(0), glm::ivec3(255))) / 255.0f;
+        blocks.push_back(block);
+    }
+    if (blocks.empty() || blocks.size() > std::numeric_limits<std::uint16_t>::max()) {
+        std::cerr << "Palette " << path << " holds " << blocks.size() << " blocks\n";
+        return false;
+    }
+    Assign(std::move(blocks));
+    return true;
+}
+
+void voxel::BlockPalette::Assign(std::vector<Block> blocks) {
+    blocks_ = std::move(blocks);
+    lab_.clear();
+    for (const Block& block : blocks_) {
+        lab_.push_back(SrgbToLab(block.color));
+    }
+    BuildLut();
+}
+
+std::vector<glm::vec3> voxel::BlockPalette::Colors() const {
+    std::vector<glm::vec3> colors;
+    for (const Block& block : blocks_) {
+        colors.push_back(block.color);
+    }
+    return colors;
+}
+
+std::uint16_t voxel::BlockPalette::Nearest(const glm::vec3& color) const {
+    return NearestLab(lab_, SrgbToLab(color));
+}
+
+void voxel::BlockPalette::BuildLut() {
+    lut_.assign(static_cast<std::size_t>(kLevels) * kLevels * kLevels, 0);
+    if (blocks_.empty()) {
+        return;
+    }
+    // One red level per task; every entry holds the block nearest to the color at its grid point
+    util::ParallelFor(0, kLevels, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; r++) {
+            for (int g = 0; g < kLevels; g++) {
+                for (int b = 0; b < kLevels; b++) {
+                    glm::vec3 color = glm::vec3(static_cast<float>(r), g, b) / static_cast<float>(kLevels - 1);
+                    lut_[(r * kLevels + g) * kLevels + b] = NearestLab(lab_, SrgbToLab(color));
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,78 @@
+#ifndef VOXEL_BLOCK_PALETTE
+#define VOXEL_BLOCK_PALETTE
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+namespace voxel {
+
+// Blocks a model can be built from, with the color each one looks like. Colors map to the perceptually nearest
+// block (CIE76 distance in Lab) through a lookup table over quantized RGB, so mapping a color is one table
+// read; an optional ordered dither spreads in-between colors over neighbouring cells.
+class BlockPalette {
+public:
+    struct Block {
+        // Block id, e.g. "minecraft:white_concrete"
+        std::string name;
+        // sRGB, 0..1
+        glm::vec3 color;
+    };
+
+    // The sixteen Minecraft concrete colors
+    static BlockPalette Default();
+
+    BlockPalette() = default;
+    explicit BlockPalette(std::vector<Block> blocks) { Assign(std::move(blocks)); }
+
+    // Reads "name r g b" lines with 0..255 components; blank lines and lines starting with # are skipped
+    bool Load(const std::filesystem::path& path);
+    void Assign(std::vector<Block> blocks);
+
+    const std::vector<Block>& blocks() const { return blocks_; }
+    std::size_t size() const { return blocks_.size(); }
+    bool empty() const { return blocks_.empty(); }
+    // Block colors by palette index, e.g. for voxel::MeshOptions::palette
+    std::vector<glm::vec3> Colors() const;
+
+    // Exact nearest block, searching every entry
+    std::uint16_t Nearest(const glm::vec3& color) const;
+
+    // Amplitude of the ordered dither in RGB units, 0 turns it off
+    void set_dither(float dither) { dither_ = dither; }
+    float dither() const { return dither_; }
+
+    // Nearest block through the lookup table, dithered by the cell position
+    std::uint16_t Map(const glm::vec3& color, const glm::ivec3& cell) const {
+        glm::vec3 value = color;
+        if (dither_ > 0) {
+            value += (kBayer[(cell.x & 3) | ((cell.y + cell.z) & 3) << 2] - 0.5f) * dither_;
+        }
+        glm::ivec3 level = glm::clamp(glm::ivec3(value * static_cast<float>(kLevels - 1) + 0.5f), glm::ivec3(0),
+                                      glm::ivec3(kLevels - 1));
+        return lut_[static_cast<std::size_t>((level.x * kLevels + level.y) * kLevels + level.z)];
+    }
+
+private:
+    // Levels per channel in the lookup table: 32^3 entries of 2 bytes stay in the L2 cache
+    static constexpr int kLevels = 32;
+    // 4x4 Bayer thresholds, centered in their intervals
+    static constexpr float kBayer[16] = {
+        0.5f / 16, 8.5f / 16,  2.5f / 16,  10.5f / 16, 12.5f / 16, 4.5f / 16,  14.5f / 16, 6.5f / 16,
+        3.5f / 16, 11.5f / 16, 1.5f / 16,  9.5f / 16,  15.5f / 16, 7.5f / 16,  13.5f / 16, 5.5f / 16};
+
+    void BuildLut();
+
+    std::vector<Block> blocks_;
+    // Lab coordinates of the block colors
+    std::vector<glm::vec3> lab_;
+    std::vector<std::uint16_t> lut_;
+    float dither_ = 0;
+};
+
+}  // namespace voxel
+
+#endif
@@ -0,0 +1,258 @@
+#include "greedy_mesher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include "packed_vertex.h"
+#include "util/parallel.h"
+
+namespace {
+
+constexpr int kSize = voxel::VoxelGrid::kChunkSize;
+// Chunk cells plus a one cell border copied from the neighbouring chunks
+constexpr int kPadded = kSize + 2;
+
+// Brightness of every face direction (+X, -X, +Y, -Y, +Z, -Z), so that flat colored faces stay distinguishable
+constexpr float kFaceShade[6] = {0.8f, 0.8f, 1.0f, 0.5f, 0.65f, 0.65f};
+
+// Cell keys of a padded chunk: 0 for empty cells, palette index + 1 for occupied ones
+class PaddedChunk {
+public:
+    void Load(const voxel::VoxelGrid& grid, const glm::ivec3& key) {
+        std::fill(cells_.begin(), cells_.end(), 0);
+        const glm::ivec3 origin = key * kSize;
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    // Only the chunk itself and its six face neighbours can hide a face
+                    if (std::abs(dx) + std::abs(dy) + std::abs(dz) > 1) {
+                        continue;
+                    }
+                    const voxel::VoxelGrid::Chunk* chunk = grid.FindChunk(key + glm::ivec3(dx, dy, dz));
+                    if (chunk == nullptr) {
+                        continue;
+                    }
+                    const glm::ivec3 lo(dx > 0 ? kSize : dx < 0 ? -1 : 0, dy > 0 ? kSize : dy < 0 ? -1 : 0,
+                                        dz > 0 ? kSize : dz < 0 ? -1 : 0);
+                    const glm::ivec3 hi(dx == 0 ? kSize - 1 : lo.x, dy == 0 ? kSize - 1 : lo.y,
+                                        dz == 0 ? kSize - 1 : lo.z);
+                    for (int z = lo.z; z <= hi.z; z++) {
+                        for (int y = lo.y; y <= hi.y; y++) {
+                            for (int x = lo.x; x <= hi.x; x++) {
+                                int index = voxel::VoxelGrid::LocalIndex(origin + glm::ivec3(x, y, z));
+                                if (chunk->Test(index)) {
+                                    at(x, y, z) = static_cast<std::uint32_t>(chunk->Color(index)) + 1;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::uint32_t& at(int x, int y, int z) { return cells_[((z + 1) * kPadded + y + 1) * kPadded + x + 1]; }
+    std::uint32_t at(const glm::ivec3& cell) { return at(cell.x, cell.y, cell.z); }
+
+private:
+    std::vector<std::uint32_t> cells_ = std::vector<std::uint32_t>(kPadded * kPadded * kPadded);
+};
+
+}  // namespace
+
+void voxel::BlockMesh::Clear() {
+    positions.clear();
+    colors.clear();
+    packed.clear();
+    indices.clear();
+}
+
+void voxel::BlockMesh::Append(const BlockMesh& other) {
+    auto offset = static_cast<std::uint32_t>(positions.size() + packed.size());
+    positions.insert(positions.end(), other.positions.begin(), other.positions.end());
+    colors.insert(colors.end(), other.colors.begin(), other.colors.end());
+    packed.insert(packed.end(), other.packed.begin(), other.packed.end());
+    indices.reserve(indices.size() + other.indices.size());
+    for (std::uint32_t index : other.indices) {
+        indices.push_back(index + offset);
+    }
+}
+
+void voxel::MeshChunk(const VoxelGrid& grid, const glm::ivec3& chunk_key, const MeshOptions& options,
+                      BlockMesh& mesh, MeshStats* stats) {
+    const VoxelGrid::Chunk* chunk = grid.FindChunk(chunk_key);
+    if (chunk == nullptr) {
+        return;
+    }
+
+    thread_local PaddedChunk padded;
+    padded.Load(grid, chunk_key);
+
+    const glm::vec3 origin = glm::vec3(chunk_key * kSize) - 0.5f;
+    std::uint32_t mask[kSize * kSize];
+    std::size_t visible_faces = 0;
+    std::size_t quads         = 0;
+
+    for (int face = 0; face < 6; face++) {
+        const int d    = face / 2;
+        const int u    = (d + 1) % 3;
+        const int v    = (d + 2) % 3;
+        const int sign = face % 2 == 0 ? 1 : -1;
+        glm::ivec3 step(0);
+        step[d] = sign;
+
+        for (int slice = 0; slice < kSize; slice++) {
+            // Faces of this slice that look into an empty cell
+            for (int j = 0; j < kSize; j++) {
+                for (int i = 0; i < kSize; i++) {
+                    glm::ivec3 cell;
+                    cell[d]             = slice;
+                    cell[u]             = i;
+                    cell[v]             = j;
+                    std::uint32_t key   = padded.at(cell);
+                    bool visible        = key != 0 && padded.at(cell + step) == 0;
+                    mask[j * kSize + i] = visible ? key : 0;
+                    visible_faces += visible ? 1 : 0;
+                }
+            }
+
+            // Greedy merge: grow every face first along u, then along v while whole rows match
+            for (int j = 0; j < kSize; j++) {
+                for (int i = 0; i < kSize;) {
+                    const std::uint32_t key = mask[j * kSize + i];
+                    if (key == 0) {
+                        i++;
+                        continue;
+                    }
+                    int width = 1;
+                    while (i + width < kSize && mask[j * kSize + i + width] == key) {
+                        width++;
+                    }
+                    int height = 1;
+                    while (j + height < kSize &&
+                           std::all_of(mask + (j + height) * kSize + i, mask + (j + height) * kSize + i + width,
+                                       [key](std::uint32_t other) { return other == key; })) {
+                        height++;
+                    }
+                    for (int row = j; row < j + height; row++) {
+                        std::fill(mask + row * kSize + i, mask + row * kSize + i + width, 0);
+                    }
+
+                    glm::ivec3 corner(0);
+                    corner[d] = slice + (sign > 0 ? 1 : 0);
+                    corner[u] = i;
+                    corner[v] = j;
+                    glm::ivec3 du(0);
+                    glm::ivec3 dv(0);
+                    du[u] = width;
+                    dv[v] = height;
+
+                    const std::size_t palette_index =
+                        std::min<std::size_t>(key - 1, options.palette.empty() ? 0 : options.palette.size() - 1);
+
+                    auto base = static_cast<std::uint32_t>(mesh.positions.size() + mesh.packed.size());
+                    if (options.packed) {
+                        const auto color = static_cast<std::uint32_t>(
+                            std::min<std::size_t>(palette_index, voxel::kPackedColors - 1));
+                        mesh.packed.push_back(voxel::PackVertex(corner, face, color));
+                        mesh.packed.push_back(voxel::PackVertex(corner + du, face, color));
+                        mesh.packed.push_back(voxel::PackVertex(corner + du + dv, face, color));
+                        mesh.packed.push_back(voxel::PackVertex(corner + dv, face, color));
+                    } else {
+                        const glm::vec3 color =
+                            (options.palette.empty() ? glm::vec3(1) : options.palette[palette_index]) *
+                            kFaceShade[face];
+                        mesh.positions.push_back(origin + glm::vec3(corner));
+                        mesh.positions.push_back(origin + glm::vec3(corner + du));
+                        mesh.positions.push_back(origin + glm::vec3(corner + du + dv));
+                        mesh.positions.push_back(origin + glm::vec3(corner + dv));
+                        mesh.colors.insert(mesh.colors.end(), 4, color);
+                    }
+                    // (u, v, d) is right-handed, so this order is counter-clockwise seen from the +d side
+                    if (sign > 0) {
+                        mesh.indices.insert(mesh.indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+                    } else {
+                        mesh.indices.insert(mesh.indices.end(), {base, base + 2, base + 1, base, base + 3, base + 2});
+                    }
+                    quads++;
+                    i += width;
+                }
+            }
+        }
+    }
+
+    if (stats != nullptr) {
+        stats->blocks += chunk->count;
+        stats->visible_faces += visible_faces;
+        stats->quads += quads;
+    }
+}
+
+voxel::BlockMesh voxel::MeshGrid(const VoxelGrid& grid, const MeshOptions& options, MeshStats* stats) {
+    std::vector<glm::ivec3> keys;
+    keys.reserve(grid.chunks().size());
+    for (const auto& [key, chunk] : grid.chunks()) {
+        keys.push_back(key);
+    }
+    return MeshChunks(grid, keys, options, nullptr, stats);
+}
+
+std::vector<voxel::BlockMesh> voxel::MeshEachChunk(const VoxelGrid& grid, const std::vector<glm::ivec3>& keys,
+                                                   const MeshOptions& options, MeshStats* stats) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<BlockMesh> meshes(keys.size());
+    std::vector<MeshStats> chunk_stats(keys.size());
+    util::ParallelTasks(
+        keys.size(),
+        [&](std::size_t task, unsigned) { MeshChunk(grid, keys[task], options, meshes[task], &chunk_stats[task]); },
+        options.threads);
+
+    if (stats != nullptr) {
+        for (const MeshStats& chunk : chunk_stats) {
+            stats->blocks += chunk.blocks;
+            stats->visible_faces += chunk.visible_faces;
+            stats->quads += chunk.quads;
+        }
+        stats->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return meshes;
+}
+
+voxel::BlockMesh voxel::MeshChunks(const VoxelGrid& grid, const std::vector<glm::ivec3>& keys,
+                                   const MeshOptions& options, std::vector<std::size_t>* chunk_indices,
+                                   MeshStats* stats) {
+    std::vector<BlockMesh> meshes = MeshEachChunk(grid, keys, options, stats);
+    auto start                    = std::chrono::steady_clock::now();
+
+    BlockMesh result;
+    std::size_t vertices = 0;
+    std::size_t packed   = 0;
+    std::size_t indices  = 0;
+    for (const BlockMesh& mesh : meshes) {
+        vertices += mesh.positions.size();
+        packed += mesh.packed.size();
+        indices += mesh.indices.size();
+    }
+    result.positions.reserve(vertices);
+    result.colors.reserve(vertices);
+    result.packed.reserve(packed);
+    result.indices.reserve(indices);
+    if (chunk_indices != nullptr) {
+        chunk_indices->assign(1, 0);
+        chunk_indices->reserve(keys.size() + 1);
+    }
+    for (const BlockMesh& mesh : meshes) {
+        result.Append(mesh);
+        if (chunk_indices != nullptr) {
+            chunk_indices->push_back(result.indices.size());
+        }
+    }
+
+    if (stats != nullptr) {
+        // Meshing time is already counted, add the concatenation
+        stats->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return result;
+}
@@ -0,0 +1,65 @@
+#ifndef VOXEL_GREEDY_MESHER
+#define VOXEL_GREEDY_MESHER
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "voxel_grid.h"
+
+namespace voxel {
+
+// Indexed triangle mesh of block faces. Positions are in cell units with blocks centered on their
+// cell coordinates, so the mesh lines up with figure::Cube drawn at the same cells.
+struct BlockMesh {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> colors;
+    // Vertices in the format of packed_vertex.h instead of positions and colors, with MeshOptions::packed
+    std::vector<std::uint32_t> packed;
+    std::vector<std::uint32_t> indices;
+
+    void Clear();
+    // Appends other, shifting its indices past the vertices already here. Packed vertices are relative to
+    // their own chunk, so packed meshes of different chunks no longer line up after it.
+    void Append(const BlockMesh& other);
+};
+
+struct MeshOptions {
+    // Colors of palette indices stored in the grid; indices past the end use the last entry
+    std::vector<glm::vec3> palette = {glm::vec3(0.583f, 0.771f, 0.014f)};
+    // Worker threads for MeshGrid, 0 means one per hardware thread
+    unsigned threads = 0;
+    // Emit one packed 32-bit word per vertex, drawn a chunk at a time with the chunk origin as a uniform.
+    // Palette indices past kPackedColors use the last packed one; MeshLod always emits float vertices.
+    bool packed = false;
+};
+
+struct MeshStats {
+    std::size_t blocks = 0;
+    // Block faces not hidden by a neighbour, i.e. what a face-culled mesh without merging would hold
+    std::size_t visible_faces = 0;
+    std::size_t quads         = 0;
+    double seconds            = 0;
+};
+
+// Meshes one chunk of the grid: faces shared by two occupied cells are dropped and coplanar faces of the
+// same color are greedily merged into rectangles. Neighbouring chunks are read to cull border faces.
+void MeshChunk(const VoxelGrid& grid, const glm::ivec3& chunk_key, const MeshOptions& options, BlockMesh& mesh,
+               MeshStats* stats = nullptr);
+
+// Meshes every chunk in parallel and concatenates the results
+BlockMesh MeshGrid(const VoxelGrid& grid, const MeshOptions& options, MeshStats* stats = nullptr);
+
+// Meshes the given chunks in parallel into one mesh per chunk, in the same order
+std::vector<BlockMesh> MeshEachChunk(const VoxelGrid& grid, const std::vector<glm::ivec3>& chunk_keys,
+                                     const MeshOptions& options, MeshStats* stats = nullptr);
+
+// Meshes the given chunks in parallel and concatenates the results in the same order. When chunk_indices
+// is given it receives chunk_keys.size() + 1 offsets: the indices of chunk i are [offsets[i], offsets[i + 1]).
+BlockMesh MeshChunks(const VoxelGrid& grid, const std::vector<glm::ivec3>& chunk_keys, const MeshOptions& options,
+                     std::vector<std::size_t>* chunk_indices = nullptr, MeshStats* stats = nullptr);
+
+}  // namespace voxel
+
+#endif
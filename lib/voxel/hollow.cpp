@@ -0,0 +1,193 @@
+#include "hollow.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <vector>
+
+#include "util/parallel.h"
+
+namespace {
+
+// Squared distances of one line to the nearest zero, in place: out[q] = min_p (q - p)^2 + f[p], the lower
+// envelope of parabolas rooted at every sample. v and z are scratch of at least n and n + 1 entries.
+void Envelope(std::uint32_t* f, int n, std::vector<int>& v, std::vector<double>& z, std::vector<std::uint32_t>& d) {
+    auto intersection = [&](int q, int p) {
+        return ((static_cast<double>(f[q]) + static_cast<double>(q) * q) -
+                (static_cast<double>(f[p]) + static_cast<double>(p) * p)) /
+               (2.0 * q - 2.0 * p);
+    };
+    int k = 0;
+    v[0]  = 0;
+    z[0]  = -std::numeric_limits<double>::infinity();
+    z[1]  = std::numeric_limits<double>::infinity();
+    for (int q = 1; q < n; q++) {
+        double s = intersection(q, v[k]);
+        while (s <= z[k]) {
+            k--;
+            s = intersection(q, v[k]);
+        }
+        k++;
+        v[k]     = q;
+        z[k]     = s;
+        z[k + 1] = std::numeric_limits<double>::infinity();
+    }
+    k = 0;
+    for (int q = 0; q < n; q++) {
+        while (z[k + 1] < q) {
+            k++;
+        }
+        const std::uint64_t offset = static_cast<std::uint64_t>(std::abs(q - v[k]));
+        d[q] = static_cast<std::uint32_t>(
+            std::min<std::uint64_t>(offset * offset + f[v[k]], std::numeric_limits<std::uint32_t>::max()));
+    }
+    std::copy(d.begin(), d.begin() + n, f);
+}
+
+}  // namespace
+
+voxel::VoxelGrid voxel::Hollow(const VoxelGrid& grid, const HollowOptions& options, HollowStats* stats) {
+    VoxelGrid shell;
+    HollowStats counts;
+    if (grid.empty()) {
+        if (stats != nullptr) {
+            *stats = counts;
+        }
+        return shell;
+    }
+    const unsigned threads                         = options.threads == 0 ? util::HardwareThreads() : options.threads;
+    const int halo                                 = std::max(options.thickness, 0);
+    const auto limit                               = static_cast<std::uint64_t>(halo) * halo;
+    const std::pair<glm::ivec3, glm::ivec3> bounds = grid.Bounds();
+    const glm::ivec3 lo                            = bounds.first;
+    const glm::ivec3 hi                            = bounds.second;
+    const int width                                = hi.x - lo.x + 1;
+    const int length                               = hi.z - lo.z + 1;
+    const int rows                                 = hi.y - lo.y + 1;
+    const std::size_t layer                        = static_cast<std::size_t>(width) * length;
+
+    // Core layers per slab, so that they and the halo above and below fit in the budget
+    const std::size_t budget_layers = options.memory_budget / (layer * sizeof(std::uint32_t));
+    const int slab = std::clamp(static_cast<int>(std::min<std::size_t>(budget_layers, rows + 2 * halo)) - 2 * halo, 1,
+                                rows);
+
+    // Chunks by chunk Y, so every slab reads only the chunks it overlaps
+    std::map<int, std::vector<std::pair<glm::ivec3, const VoxelGrid::Chunk*>>> chunk_layers;
+    for (const auto& [key, chunk] : grid.chunks()) {
+        chunk_layers[key.y].emplace_back(key, chunk.get());
+    }
+
+    std::vector<std::uint32_t> field;
+    std::vector<std::vector<std::pair<glm::ivec3, std::uint16_t>>> kept;
+    for (int slab_lo = lo.y; slab_lo <= hi.y; slab_lo += slab) {
+        const int slab_hi = std::min(slab_lo + slab - 1, hi.y);
+        const int read_lo = slab_lo - halo;
+        const int height  = slab_hi + halo - read_lo + 1;
+        counts.slabs++;
+
+        // 0 for empty cells, 1 for occupied ones until the x pass turns them into distances
+        field.assign(layer * height, 0);
+        auto at = [&](int x, int y, int z) -> std::uint32_t& {
+            return field[(static_cast<std::size_t>(y) * length + z) * width + x];
+        };
+        const int chunk_lo = read_lo >> VoxelGrid::kChunkBits;
+        const int chunk_hi = (read_lo + height - 1) >> VoxelGrid::kChunkBits;
+        for (auto it = chunk_layers.lower_bound(chunk_lo); it != chunk_layers.end() && it->first <= chunk_hi; ++it) {
+            for (const auto& [key, chunk] : it->second) {
+                VoxelGrid::ForEachInChunk(key, *chunk, [&](const glm::ivec3& cell, std::uint16_t) {
+                    if (cell.y >= read_lo && cell.y < read_lo + height) {
+                        at(cell.x - lo.x, cell.y - read_lo, cell.z - lo.z) = 1;
+                    }
+                });
+            }
+        }
+
+        // Along x: distance to the nearest empty cell of the row, the cells past both ends being empty
+        util::ParallelFor(
+            0, static_cast<std::size_t>(height) * length,
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t row = begin; row < end; row++) {
+                    std::uint32_t* cells = field.data() + row * width;
+                    std::uint32_t run    = 0;
+                    for (int x = 0; x < width; x++) {
+                        run      = cells[x] == 0 ? 0 : run + 1;
+                        cells[x] = run;
+                    }
+                    run = 0;
+                    for (int x = width - 1; x >= 0; x--) {
+                        run      = cells[x] == 0 ? 0 : std::min(run + 1, cells[x]);
+                        cells[x] = run * run;
+                    }
+                }
+            },
+            threads);
+
+        // Along z, then along y: copy every strided line out, take its lower envelope, copy it back. Lines along
+        // z get an empty cell past each end; along y the halo layers stand in for what lies beyond the slab.
+        auto envelope_pass = [&](int lines, int n, bool padded, auto line_start, std::size_t stride) {
+            const int pad = padded ? 1 : 0;
+            util::ParallelFor(
+                0, static_cast<std::size_t>(lines),
+                [&](std::size_t begin, std::size_t end) {
+                    std::vector<std::uint32_t> line(n + 2 * pad, 0);
+                    std::vector<std::uint32_t> out(line.size());
+                    std::vector<int> v(line.size());
+                    std::vector<double> z(line.size() + 1);
+                    for (std::size_t i = begin; i < end; i++) {
+                        std::uint32_t* first = field.data() + line_start(i);
+                        for (int q = 0; q < n; q++) {
+                            line[q + pad] = first[q * stride];
+                        }
+                        Envelope(line.data(), static_cast<int>(line.size()), v, z, out);
+                        for (int q = 0; q < n; q++) {
+                            first[q * stride] = line[q + pad];
+                        }
+                        if (padded) {
+                            line.front() = 0;
+                            line.back()  = 0;
+                        }
+                    }
+                },
+                threads);
+        };
+        // Lines along z: one per (x, y)
+        envelope_pass(
+            width * height, length, true, [&](std::size_t i) { return (i / width) * layer + i % width; },
+            static_cast<std::size_t>(width));
+        // Lines along y: one per (x, z)
+        envelope_pass(static_cast<int>(layer), height, false, [&](std::size_t i) { return i; }, layer);
+
+        // Keep the occupied cells of the slab core within the thickness
+        kept.assign(static_cast<std::size_t>(slab_hi - slab_lo + 1), {});
+        util::ParallelTasks(
+            kept.size(),
+            [&](std::size_t task, unsigned) {
+                const int y = slab_lo + static_cast<int>(task);
+                for (int z = 0; z < length; z++) {
+                    for (int x = 0; x < width; x++) {
+                        const std::uint32_t distance = at(x, y - read_lo, z);
+                        if (distance == 0 || distance > limit) {
+                            continue;
+                        }
+                        const glm::ivec3 cell(lo.x + x, y, lo.z + z);
+                        kept[task].emplace_back(cell, grid.Color(cell));
+                    }
+                }
+            },
+            threads);
+        for (const std::vector<std::pair<glm::ivec3, std::uint16_t>>& cells : kept) {
+            for (const auto& [cell, color] : cells) {
+                shell.Set(cell, color);
+            }
+        }
+    }
+
+    counts.kept    = shell.size();
+    counts.removed = grid.size() - shell.size();
+    if (stats != nullptr) {
+        *stats = counts;
+    }
+    return shell;
+}
@@ -0,0 +1,34 @@
+#ifndef VOXEL_HOLLOW
+#define VOXEL_HOLLOW
+
+#include <cstddef>
+
+#include "voxel_grid.h"
+
+namespace voxel {
+
+struct HollowOptions {
+    // Blocks kept under the surface: cells no farther than this from an empty cell (Euclidean, in cells)
+    int thickness = 1;
+    // Worker threads, 0 means one per hardware thread
+    unsigned threads = 0;
+    // Bytes of distance field held at once; the grid is processed in Y slabs that fit
+    std::size_t memory_budget = std::size_t(256) << 20;
+};
+
+struct HollowStats {
+    std::size_t kept    = 0;
+    std::size_t removed = 0;
+    std::size_t slabs   = 0;
+};
+
+// Shell of the grid: the cells whose exact Euclidean distance to the nearest empty cell is at most
+// options.thickness, with their colors. Cells outside the bounds count as empty, and so do closed cavities.
+// The squared distance transform is separable (Felzenszwalb and Huttenlocher): distances along x, then the
+// lower envelope of parabolas along z and y, every pass running over independent lines in parallel. A slab
+// reads thickness extra layers above and below, which is all an exact answer within the thickness needs.
+VoxelGrid Hollow(const VoxelGrid& grid, const HollowOptions& options = HollowOptions(), HollowStats* stats = nullptr);
+
+}  // namespace voxel
+
+#endif
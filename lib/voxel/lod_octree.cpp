@@ -0,0 +1,187 @@
+#include "lod_octree.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <unordered_set>
+
+#include "util/parallel.h"
+
+namespace {
+
+using Chunk = voxel::VoxelGrid::Chunk;
+
+constexpr int kSize = voxel::VoxelGrid::kChunkSize;
+constexpr int kHalf = kSize / 2;
+
+glm::ivec3 ParentKey(const glm::ivec3& key) {
+    return glm::ivec3(key.x >> 1, key.y >> 1, key.z >> 1);
+}
+
+bool KeyLess(const glm::ivec3& a, const glm::ivec3& b) {
+    return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+}
+
+std::unique_ptr<Chunk> DownsampleChunk(const voxel::VoxelGrid& fine, const glm::ivec3& parent) {
+    auto coarse = std::make_unique<Chunk>();
+    for (int octant = 0; octant < 8; octant++) {
+        const glm::ivec3 offset(octant & 1, octant >> 1 & 1, octant >> 2);
+        const Chunk* child = fine.FindChunk(parent * 2 + offset);
+        if (child == nullptr) {
+            continue;
+        }
+        // The child chunk fills one 16^3 octant of the coarse chunk
+        for (int z = 0; z < kHalf; z++) {
+            for (int y = 0; y < kHalf; y++) {
+                for (int x = 0; x < kHalf; x++) {
+                    std::array<std::uint16_t, 8> colors;
+                    int occupied = 0;
+                    for (int i = 0; i < 8; i++) {
+                        glm::ivec3 cell(2 * x + (i & 1), 2 * y + (i >> 1 & 1), 2 * z + (i >> 2));
+                        int index = voxel::VoxelGrid::LocalIndex(cell);
+                        if (child->Test(index)) {
+                            colors[occupied++] = child->Color(index);
+                        }
+                    }
+                    if (occupied == 0) {
+                        continue;
+                    }
+
+                    int index = voxel::VoxelGrid::LocalIndex(offset * kHalf + glm::ivec3(x, y, z));
+                    coarse->bits[index >> 6] |= std::uint64_t(1) << (index & 63);
+                    coarse->count++;
+                    if (!child->colors) {
+                        continue;
+                    }
+                    std::uint16_t majority = colors[0];
+                    int best               = 0;
+                    for (int i = 0; i < occupied; i++) {
+                        int votes = static_cast<int>(std::count(colors.begin(), colors.begin() + occupied, colors[i]));
+                        if (votes > best || (votes == best && colors[i] < majority)) {
+                            best     = votes;
+                            majority = colors[i];
+                        }
+                    }
+                    coarse->colors.Set(index, majority);
+                }
+            }
+        }
+    }
+    return coarse;
+}
+
+}  // namespace
+
+void voxel::Downsample(const VoxelGrid& fine, VoxelGrid& coarse, unsigned threads) {
+    std::unordered_set<glm::ivec3, VoxelGrid::ChunkKeyHash> parent_set;
+    for (const auto& [key, chunk] : fine.chunks()) {
+        parent_set.insert(ParentKey(key));
+    }
+    std::vector<glm::ivec3> parents(parent_set.begin(), parent_set.end());
+
+    std::vector<std::unique_ptr<Chunk>> chunks(parents.size());
+    util::ParallelTasks(
+        parents.size(), [&](std::size_t task, unsigned) { chunks[task] = DownsampleChunk(fine, parents[task]); },
+        threads);
+
+    coarse.Clear();
+    for (std::size_t i = 0; i < parents.size(); i++) {
+        coarse.InsertChunk(parents[i], std::move(chunks[i]));
+    }
+}
+
+void voxel::LodOctree::Build(const VoxelGrid& base, const LodOptions& options) {
+    base_ = &base;
+    coarse_.clear();
+    nodes_.clear();
+    root_count_ = 0;
+
+    const std::size_t budget = static_cast<std::size_t>(static_cast<double>(base.MemoryUsage()) *
+                                                        options.max_memory_ratio);
+    std::size_t used = 0;
+    // A single chunk has nothing left to merge with
+    while (levels() <= options.max_levels && level(levels() - 1).chunks().size() > 1) {
+        VoxelGrid coarse;
+        Downsample(level(levels() - 1), coarse, options.threads);
+        used += coarse.MemoryUsage();
+        if (used > budget) {
+            break;
+        }
+        coarse_.push_back(std::move(coarse));
+    }
+
+    // Breadth first, so the children of every node are consecutive
+    const VoxelGrid& top = level(levels() - 1);
+    for (const auto& [key, chunk] : top.chunks()) {
+        nodes_.push_back({key, levels() - 1});
+    }
+    std::sort(nodes_.begin(), nodes_.end(), [](const Node& a, const Node& b) { return KeyLess(a.key, b.key); });
+    root_count_ = nodes_.size();
+    for (std::size_t i = 0; i < nodes_.size(); i++) {
+        if (nodes_[i].level == 0) {
+            continue;
+        }
+        const Node parent      = nodes_[i];
+        const VoxelGrid& finer = level(parent.level - 1);
+        nodes_[i].first_child  = static_cast<std::uint32_t>(nodes_.size());
+        for (int octant = 0; octant < 8; octant++) {
+            glm::ivec3 key = parent.key * 2 + glm::ivec3(octant & 1, octant >> 1 & 1, octant >> 2);
+            if (finer.FindChunk(key) != nullptr) {
+                nodes_.push_back({key, parent.level - 1});
+            }
+        }
+        nodes_[i].child_count = static_cast<std::uint32_t>(nodes_.size()) - nodes_[i].first_child;
+    }
+}
+
+std::size_t voxel::LodOctree::MemoryUsage() const {
+    std::size_t bytes = nodes_.capacity() * sizeof(Node);
+    for (const VoxelGrid& grid : coarse_) {
+        bytes += grid.MemoryUsage();
+    }
+    return bytes;
+}
+
+voxel::BlockMesh voxel::MeshLod(const LodOctree& octree, const MeshOptions& options,
+                                std::vector<std::size_t>* node_indices, MeshStats* stats) {
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<LodOctree::Node>& nodes = octree.nodes();
+    std::vector<BlockMesh> meshes(nodes.size());
+    std::vector<MeshStats> node_stats(nodes.size());
+    // Nodes are scaled below, which packed chunk-local corners can not express
+    MeshOptions float_options = options;
+    float_options.packed      = false;
+    util::ParallelTasks(
+        nodes.size(),
+        [&](std::size_t task, unsigned) {
+            const LodOctree::Node& node = nodes[task];
+            MeshChunk(octree.level(node.level), node.key, float_options, meshes[task], &node_stats[task]);
+            // A cell c of level k spans blocks [c * 2^k - 0.5, (c + 1) * 2^k - 0.5]
+            const float scale = static_cast<float>(LodOctree::CellSize(node.level));
+            for (glm::vec3& position : meshes[task].positions) {
+                position = (position + 0.5f) * scale - 0.5f;
+            }
+        },
+        options.threads);
+
+    BlockMesh result;
+    if (node_indices != nullptr) {
+        node_indices->assign(1, 0);
+        node_indices->reserve(nodes.size() + 1);
+    }
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        result.Append(meshes[i]);
+        if (node_indices != nullptr) {
+            node_indices->push_back(result.indices.size());
+        }
+        if (stats != nullptr) {
+            stats->blocks += node_stats[i].blocks;
+            stats->visible_faces += node_stats[i].visible_faces;
+            stats->quads += node_stats[i].quads;
+        }
+    }
+    if (stats != nullptr) {
+        stats->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return result;
+}
@@ -0,0 +1,77 @@
+#ifndef VOXEL_LOD_OCTREE
+#define VOXEL_LOD_OCTREE
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "greedy_mesher.h"
+#include "voxel_grid.h"
+
+namespace voxel {
+
+struct LodOptions {
+    // Coarse levels above the base grid, each halving the resolution
+    int max_levels = 8;
+    // A coarse level is only added while all coarse levels together stay under this share of the base grid
+    // memory. Dense builds need about 1/8 + 1/64 + ... = 1/7.
+    double max_memory_ratio = 0.25;
+    // Worker threads, 0 means one per hardware thread
+    unsigned threads = 0;
+};
+
+// Halves the resolution of fine into coarse: a coarse cell is occupied when any of its 8 fine cells is and
+// takes the most common color among them, ties going to the smallest palette index. Chunks are built in parallel.
+void Downsample(const VoxelGrid& fine, VoxelGrid& coarse, unsigned threads = 0);
+
+// Level of detail pyramid over a block set. Level 0 is the base grid, a cell of level k covers 2^k blocks
+// along every axis. The chunks of all levels form an octree: the children of chunk K at level k are the
+// existing chunks 2K + {0, 1}^3 of level k - 1.
+class LodOctree {
+public:
+    struct Node {
+        glm::ivec3 key;
+        int level = 0;
+        // Children are the nodes [first_child, first_child + child_count)
+        std::uint32_t first_child = 0;
+        std::uint32_t child_count = 0;
+    };
+
+    LodOctree() = default;
+    // base must outlive the octree
+    explicit LodOctree(const VoxelGrid& base, const LodOptions& options = LodOptions()) { Build(base, options); }
+
+    void Build(const VoxelGrid& base, const LodOptions& options = LodOptions());
+
+    // Levels including the base one
+    int levels() const { return static_cast<int>(coarse_.size()) + 1; }
+    const VoxelGrid& level(int index) const { return index == 0 ? *base_ : coarse_[index - 1]; }
+
+    // Nodes of the coarsest level come first and are the roots; every node precedes its children
+    const std::vector<Node>& nodes() const { return nodes_; }
+    std::size_t root_count() const { return root_count_; }
+
+    // Blocks covered by one cell and by one chunk of a level, along one axis
+    static int CellSize(int level) { return 1 << level; }
+    static int ChunkSpan(int level) { return VoxelGrid::kChunkSize << level; }
+
+    // Heap footprint of the coarse levels and the node array, the base grid is not counted
+    std::size_t MemoryUsage() const;
+
+private:
+    const VoxelGrid* base_ = nullptr;
+    std::vector<VoxelGrid> coarse_;
+    std::vector<Node> nodes_;
+    std::size_t root_count_ = 0;
+};
+
+// Meshes every node of the octree in parallel, with positions scaled to blocks so that all levels line up with
+// the base grid. When node_indices is given it receives nodes().size() + 1 offsets: the indices of node i are
+// [offsets[i], offsets[i + 1]).
+BlockMesh MeshLod(const LodOctree& octree, const MeshOptions& options, std::vector<std::size_t>* node_indices = nullptr,
+                  MeshStats* stats = nullptr);
+
+}  // namespace voxel
+
+#endif
@@ -0,0 +1,265 @@
+#include "morton.h"
+
+#include <array>
+#include <memory>
+#include <utility>
+
+#include "util/parallel.h"
+
+namespace {
+
+constexpr int kDigitBits = 11;
+constexpr int kBuckets   = 1 << kDigitBits;
+// Blocks a thread handles at least in every pass
+constexpr std::size_t kGrain = 1 << 16;
+
+struct Entry {
+    std::uint64_t code;
+    std::uint32_t index;
+};
+
+// Morton order of full 32-bit coordinates: the axis whose coordinates differ in the highest bit decides,
+// z before y before x on a tie (Chan's most significant differing bit comparison)
+bool MortonLess(const glm::ivec3& a, const glm::ivec3& b) {
+    auto less_msb = [](std::uint32_t x, std::uint32_t y) { return x < y && x < (x ^ y); };
+    std::uint32_t differ[3];
+    for (int axis = 0; axis < 3; axis++) {
+        differ[axis] = static_cast<std::uint32_t>(a[axis]) ^ static_cast<std::uint32_t>(b[axis]);
+    }
+    int axis = 2;
+    for (int other = 1; other >= 0; other--) {
+        if (less_msb(differ[axis], differ[other])) {
+            axis = other;
+        }
+    }
+    // The sign bit is flipped so that negative coordinates come first
+    return (static_cast<std::uint32_t>(a[axis]) ^ 0x80000000u) < (static_cast<std::uint32_t>(b[axis]) ^ 0x80000000u);
+}
+
+std::uint64_t CodeOf(std::uint64_t code) {
+    return code;
+}
+
+std::uint64_t CodeOf(const Entry& entry) {
+    return entry.code;
+}
+
+// Stable LSD radix sort of codes or entries over the digits in which some codes differ. Every pass counts the
+// digits of contiguous parts on their own threads, so that parts scatter in order without locks.
+template <typename T>
+void RadixSort(std::vector<T>& entries, unsigned threads) {
+    std::uint64_t any_set = 0;
+    std::uint64_t all_set = ~std::uint64_t(0);
+    for (const T& entry : entries) {
+        any_set |= CodeOf(entry);
+        all_set &= CodeOf(entry);
+    }
+    const std::uint64_t varying = any_set ^ all_set;
+
+    const std::size_t count = entries.size();
+    const std::size_t parts = std::max<std::size_t>(1, std::min<std::size_t>(threads, count / kGrain));
+    std::vector<T> buffer(count);
+    std::vector<std::array<std::size_t, kBuckets>> offsets(parts);
+    for (int shift = 0; shift < 64; shift += kDigitBits) {
+        if ((varying >> shift & (kBuckets - 1)) == 0) {
+            continue;
+        }
+        auto digit = [shift](const T& entry) { return CodeOf(entry) >> shift & (kBuckets - 1); };
+        util::ParallelTasks(
+            parts,
+            [&](std::size_t part, unsigned) {
+                std::array<std::size_t, kBuckets>& counts = offsets[part];
+                counts.fill(0);
+                const std::size_t end = count * (part + 1) / parts;
+                for (std::size_t i = count * part / parts; i < end; i++) {
+                    counts[digit(entries[i])]++;
+                }
+            },
+            threads);
+        // Bucket by bucket, part by part: the start of every part within every bucket
+        std::size_t total = 0;
+        for (int bucket = 0; bucket < kBuckets; bucket++) {
+            for (std::size_t part = 0; part < parts; part++) {
+                const std::size_t size = offsets[part][bucket];
+                offsets[part][bucket]  = total;
+                total += size;
+            }
+        }
+        util::ParallelTasks(
+            parts,
+            [&](std::size_t part, unsigned) {
+                std::array<std::size_t, kBuckets>& next = offsets[part];
+                const std::size_t end                   = count * (part + 1) / parts;
+                for (std::size_t i = count * part / parts; i < end; i++) {
+                    buffer[next[digit(entries[i])]++] = entries[i];
+                }
+            },
+            threads);
+        entries.swap(buffer);
+    }
+}
+
+}  // namespace
+
+std::size_t voxel::SortMorton(std::vector<glm::ivec3>& blocks, std::vector<std::uint16_t>* colors,
+                              unsigned threads) {
+    threads                 = threads == 0 ? util::HardwareThreads() : threads;
+    const std::size_t count = blocks.size();
+    const bool colored      = colors != nullptr && !colors->empty();
+    bool in_range           = true;
+    for (const glm::ivec3& block : blocks) {
+        in_range = in_range && MortonRange(block);
+    }
+
+    std::vector<glm::ivec3> sorted;
+    std::vector<std::uint16_t> sorted_colors;
+    if (in_range && !colored) {
+        // Blocks come back from their codes, so the codes alone are sorted
+        std::vector<std::uint64_t> codes(count);
+        util::ParallelFor(
+            0, count,
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) {
+                    codes[i] = MortonEncode(blocks[i]);
+                }
+            },
+            threads, kGrain);
+        RadixSort(codes, threads);
+        codes.erase(std::unique(codes.begin(), codes.end()), codes.end());
+        sorted.resize(codes.size());
+        util::ParallelFor(
+            0, codes.size(),
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) {
+                    sorted[i] = MortonDecode(codes[i]);
+                }
+            },
+            threads, kGrain);
+    } else if (in_range) {
+        // Codes carry the input index along for the colors
+        std::vector<Entry> entries(count);
+        util::ParallelFor(
+            0, count,
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) {
+                    entries[i] = {MortonEncode(blocks[i]), static_cast<std::uint32_t>(i)};
+                }
+            },
+            threads, kGrain);
+        RadixSort(entries, threads);
+        // Equal codes are in input order, the last copy of every block stands for it
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            if (i + 1 == count || entries[i].code != entries[i + 1].code) {
+                entries[kept++] = entries[i];
+            }
+        }
+        sorted.resize(kept);
+        sorted_colors.resize(kept);
+        util::ParallelFor(
+            0, kept,
+            [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) {
+                    sorted[i]        = MortonDecode(entries[i].code);
+                    sorted_colors[i] = (*colors)[entries[i].index];
+                }
+            },
+            threads, kGrain);
+    } else {
+        std::vector<std::uint32_t> order(count);
+        for (std::size_t i = 0; i < count; i++) {
+            order[i] = static_cast<std::uint32_t>(i);
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&](std::uint32_t a, std::uint32_t b) { return MortonLess(blocks[a], blocks[b]); });
+        for (std::size_t i = 0; i < count; i++) {
+            if (i + 1 < count && blocks[order[i]] == blocks[order[i + 1]]) {
+                continue;
+            }
+            sorted.push_back(blocks[order[i]]);
+            if (colored) {
+                sorted_colors.push_back((*colors)[order[i]]);
+            }
+        }
+    }
+
+    const std::size_t duplicates = count - sorted.size();
+    blocks.swap(sorted);
+    if (colored) {
+        colors->swap(sorted_colors);
+    }
+    return duplicates;
+}
+
+void voxel::FillGrid(VoxelGrid& grid, const std::vector<glm::ivec3>& blocks, const std::vector<std::uint16_t>& colors,
+                     unsigned threads) {
+    threads = threads == 0 ? util::HardwareThreads() : threads;
+    grid.Clear();
+    if (threads == 1) {
+        // Sorting only pays off when the chunks are built on several threads
+        for (std::size_t i = 0; i < blocks.size(); i++) {
+            grid.Set(blocks[i], colors.empty() ? 0 : colors[i]);
+        }
+        return;
+    }
+    const std::size_t count = blocks.size();
+    bool in_range           = true;
+    for (const glm::ivec3& block : blocks) {
+        in_range = in_range && MortonRange(VoxelGrid::ChunkOf(block));
+    }
+
+    // Block indices ordered by the Morton code of their chunk, in input order within a chunk
+    std::vector<Entry> entries(count);
+    util::ParallelFor(
+        0, count,
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                entries[i] = {in_range ? MortonEncode(VoxelGrid::ChunkOf(blocks[i])) : 0,
+                              static_cast<std::uint32_t>(i)};
+            }
+        },
+        threads, kGrain);
+    if (in_range) {
+        RadixSort(entries, threads);
+    } else {
+        std::stable_sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) {
+            return MortonLess(VoxelGrid::ChunkOf(blocks[a.index]), VoxelGrid::ChunkOf(blocks[b.index]));
+        });
+    }
+
+    // Entries [starts[c], starts[c + 1]) share a chunk
+    auto chunk_at = [&](std::size_t i) { return VoxelGrid::ChunkOf(blocks[entries[i].index]); };
+    std::vector<std::size_t> starts;
+    for (std::size_t i = 0; i < count; i++) {
+        if (i == 0 || (in_range ? entries[i].code != entries[i - 1].code : chunk_at(i) != chunk_at(i - 1))) {
+            starts.push_back(i);
+        }
+    }
+    starts.push_back(count);
+
+    // Later copies of a block overwrite the color of earlier ones, as VoxelGrid::Set does
+    const std::size_t chunk_count = starts.size() - 1;
+    std::vector<std::unique_ptr<VoxelGrid::Chunk>> chunks(chunk_count);
+    util::ParallelFor(
+        0, chunk_count,
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; c++) {
+                auto chunk = std::make_unique<VoxelGrid::Chunk>();
+                for (std::size_t i = starts[c]; i < starts[c + 1]; i++) {
+                    const std::uint32_t block = entries[i].index;
+                    const int index           = VoxelGrid::LocalIndex(blocks[block]);
+                    const std::uint16_t color = colors.empty() ? 0 : colors[block];
+                    chunk->colors.Set(index, color);
+                    if (!chunk->Test(index)) {
+                        chunk->bits[index >> 6] |= std::uint64_t(1) << (index & 63);
+                        chunk->count++;
+                    }
+                }
+                chunks[c] = std::move(chunk);
+            }
+        },
+        threads, 16);
+    for (std::size_t c = 0; c < chunk_count; c++) {
+        grid.InsertChunk(chunk_at(starts[c]), std::move(chunks[c]));
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef VOXEL_MORTON
+#define VOXEL_MORTON
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "voxel_grid.h"
+
+namespace voxel {
+
+// Morton (Z-order) codes interleave the bits of the three coordinates, x lowest. Coordinates are biased by
+// kMortonBias so that kMortonAxisBits bits per axis hold [-kMortonBias, kMortonBias).
+inline constexpr int kMortonAxisBits = 21;
+inline constexpr int kMortonBias     = 1 << (kMortonAxisBits - 1);
+
+// Spreads the low 21 bits of value to every third bit
+inline std::uint64_t MortonSpread(std::uint64_t value) {
+    value &= 0x1fffff;
+    value = (value | value << 32) & 0x1f00000000ffff;
+    value = (value | value << 16) & 0x1f0000ff0000ff;
+    value = (value | value << 8) & 0x100f00f00f00f00f;
+    value = (value | value << 4) & 0x10c30c30c30c30c3;
+    value = (value | value << 2) & 0x1249249249249249;
+    return value;
+}
+
+inline std::uint64_t MortonCompact(std::uint64_t value) {
+    value &= 0x1249249249249249;
+    value = (value | value >> 2) & 0x10c30c30c30c30c3;
+    value = (value | value >> 4) & 0x100f00f00f00f00f;
+    value = (value | value >> 8) & 0x1f0000ff0000ff;
+    value = (value | value >> 16) & 0x1f00000000ffff;
+    value = (value | value >> 32) & 0x1fffff;
+    return value;
+}
+
+// Code of a cell inside the Morton range; see MortonRange
+inline std::uint64_t MortonEncode(const glm::ivec3& cell) {
+    return MortonSpread(static_cast<std::uint64_t>(cell.x + kMortonBias)) |
+           MortonSpread(static_cast<std::uint64_t>(cell.y + kMortonBias)) << 1 |
+           MortonSpread(static_cast<std::uint64_t>(cell.z + kMortonBias)) << 2;
+}
+
+inline glm::ivec3 MortonDecode(std::uint64_t code) {
+    return glm::ivec3(static_cast<int>(MortonCompact(code)), static_cast<int>(MortonCompact(code >> 1)),
+                      static_cast<int>(MortonCompact(code >> 2))) -
+           kMortonBias;
+}
+
+// True when every coordinate of the cell fits the 21 bits of a code
+inline bool MortonRange(const glm::ivec3& cell) {
+    return std::min({cell.x, cell.y, cell.z}) >= -kMortonBias && std::max({cell.x, cell.y, cell.z}) < kMortonBias;
+}
+
+// Sorts blocks into Morton order and drops duplicates, keeping the color of the last copy as VoxelGrid::Set
+// would. colors, when given and not empty, holds one palette index per block and is reordered along. The sort
+// is a parallel LSD radix sort over 11-bit digits of the codes that skips the digits all codes share; blocks
+// beyond the Morton range fall back to a comparison sort in Morton order of the full coordinates. The cells of
+// every chunk of a VoxelGrid end up next to each other. Returns the number of duplicates removed.
+std::size_t SortMorton(std::vector<glm::ivec3>& blocks, std::vector<std::uint16_t>* colors = nullptr,
+                       unsigned threads = 0);
+
+// Replaces the contents of the grid with blocks in any order, repeated ones included: the color of the last copy
+// wins, as with VoxelGrid::Set. Block indices are radix sorted by the Morton code of their chunk, which groups
+// the blocks of every chunk; every chunk is then built whole on one of the threads and inserted with a single
+// map operation. With a single thread the blocks are simply set one by one. colors may be empty.
+void FillGrid(VoxelGrid& grid, const std::vector<glm::ivec3>& blocks, const std::vector<std::uint16_t>& colors,
+              unsigned threads = 0);
+
+}  // namespace voxel
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef VOXEL_PACKED_VERTEX
+#define VOXEL_PACKED_VERTEX
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "voxel_grid.h"
+
+namespace voxel {
+
+// Block mesh vertex in one 32-bit word, decoded by "shaders/vertex shaders/PackedVertexShader.glsl":
+//   bits  0..17  corner inside the chunk, 6 bits per axis: 0..kChunkSize, relative to the low corner of cell 0
+//   bits 18..20  face, in the greedy mesher order +X, -X, +Y, -Y, +Z, -Z
+//   bits 21..31  palette index
+// The chunk origin and the palette colors are uniforms, so 4 bytes replace the 24 of a float position and color.
+constexpr int kPackedAxisBits         = 6;
+constexpr int kPackedFaceShift        = 3 * kPackedAxisBits;
+constexpr int kPackedColorShift       = kPackedFaceShift + 3;
+constexpr std::uint32_t kPackedColors = 1u << (32 - kPackedColorShift);
+
+static_assert(VoxelGrid::kChunkSize < (1 << kPackedAxisBits), "chunk corners must fit the packed axis bits");
+
+inline std::uint32_t PackVertex(const glm::ivec3& corner, int face, std::uint32_t color) {
+    return static_cast<std::uint32_t>(corner.x) | static_cast<std::uint32_t>(corner.y) << kPackedAxisBits |
+           static_cast<std::uint32_t>(corner.z) << (2 * kPackedAxisBits) |
+           static_cast<std::uint32_t>(face) << kPackedFaceShift | color << kPackedColorShift;
+}
+
+inline glm::ivec3 UnpackCorner(std::uint32_t vertex) {
+    constexpr std::uint32_t mask = (1u << kPackedAxisBits) - 1;
+    return glm::ivec3(vertex & mask, vertex >> kPackedAxisBits & mask, vertex >> (2 * kPackedAxisBits) & mask);
+}
+
+inline int UnpackFace(std::uint32_t vertex) { return static_cast<int>(vertex >> kPackedFaceShift & 7); }
+
+inline std::uint32_t UnpackColor(std::uint32_t vertex) { return vertex >> kPackedColorShift; }
+
+}  // namespace voxel
+
+#endif
@@ -0,0 +1,210 @@
+#include "raycast.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+#include "util/parallel.h"
+
+namespace {
+
+constexpr int kSize       = voxel::VoxelGrid::kChunkSize;
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+// Ray parameter where the ray crosses a plane perpendicular to one axis, infinite when parallel to it
+float PlaneT(float plane, float origin, float direction) {
+    return direction == 0 ? kInfinity : (plane - origin) / direction;
+}
+
+int MinAxis(const glm::vec3& t) {
+    return t.x <= t.y ? (t.x <= t.z ? 0 : 2) : (t.y <= t.z ? 1 : 2);
+}
+
+void AddStats(voxel::RaycastStats& total, const voxel::RaycastStats& part) {
+    total.rays += part.rays;
+    total.hits += part.hits;
+    total.cells += part.cells;
+    total.chunks_walked += part.chunks_walked;
+    total.chunks_skipped += part.chunks_skipped;
+}
+
+// Steps cell by cell through one chunk, starting at cell entered at t through entry_axis, until the ray
+// leaves the chunk or passes t_exit. True with cell, t and entry_axis at the first occupied cell.
+bool WalkChunk(const voxel::VoxelGrid::Chunk& chunk, const glm::ivec3& key, const glm::vec3& origin,
+               const glm::vec3& direction, const glm::ivec3& step, float t_exit, glm::ivec3& cell, float& t,
+               int& entry_axis, std::size_t& cells) {
+    glm::vec3 t_max;
+    glm::vec3 t_delta;
+    for (int axis = 0; axis < 3; axis++) {
+        const auto plane = static_cast<float>(cell[axis] + (step[axis] > 0 ? 1 : 0));
+        t_max[axis]      = PlaneT(plane, origin[axis], direction[axis]);
+        t_delta[axis]    = direction[axis] == 0 ? kInfinity : 1 / std::abs(direction[axis]);
+    }
+    while (true) {
+        cells++;
+        if (chunk.Test(voxel::VoxelGrid::LocalIndex(cell))) {
+            return true;
+        }
+        const int axis = MinAxis(t_max);
+        if (t_max[axis] >= t_exit) {
+            return false;
+        }
+        t = t_max[axis];
+        cell[axis] += step[axis];
+        t_max[axis] += t_delta[axis];
+        entry_axis = axis;
+        // Rounding can put the last boundary of the chunk a hair before t_exit
+        if (cell[axis] >> voxel::VoxelGrid::kChunkBits != key[axis]) {
+            return false;
+        }
+    }
+}
+
+}  // namespace
+
+voxel::Raycaster::Raycaster(const VoxelGrid& grid) : grid_(&grid) {
+    Update();
+}
+
+void voxel::Raycaster::Update() {
+    chunk_lo_ = glm::ivec3(std::numeric_limits<int>::max());
+    chunk_hi_ = glm::ivec3(std::numeric_limits<int>::min());
+    for (const auto& [key, chunk] : grid_->chunks()) {
+        chunk_lo_ = glm::min(chunk_lo_, key);
+        chunk_hi_ = glm::max(chunk_hi_, key);
+    }
+}
+
+bool voxel::Raycaster::Cast(const Ray& ray, float max_distance, RayHit& hit, RaycastStats* stats) const {
+    hit = RayHit();
+    RaycastStats local;
+    local.rays  = 1;
+    auto finish = [&] {
+        if (stats != nullptr) {
+            AddStats(*stats, local);
+        }
+        return hit.hit;
+    };
+    if (grid_->chunks().empty()) {
+        return finish();
+    }
+    // Shifted by half a cell, cell c covers [c, c + 1) and the cell of a point is its floor
+    const glm::vec3 direction = glm::normalize(ray.direction);
+    const glm::vec3 origin    = ray.origin + 0.5f;
+    const glm::ivec3 step(direction.x > 0 ? 1 : -1, direction.y > 0 ? 1 : -1, direction.z > 0 ? 1 : -1);
+
+    // Clip the ray to the box of the stored chunks
+    const glm::vec3 box_lo(chunk_lo_ * kSize);
+    const glm::vec3 box_hi((chunk_hi_ + 1) * kSize);
+    float t_near   = 0;
+    float t_far    = max_distance;
+    int entry_axis = -1;
+    bool inside    = true;
+    for (int axis = 0; axis < 3 && inside; axis++) {
+        if (direction[axis] == 0) {
+            inside = origin[axis] >= box_lo[axis] && origin[axis] < box_hi[axis];
+            continue;
+        }
+        float t0 = (box_lo[axis] - origin[axis]) / direction[axis];
+        float t1 = (box_hi[axis] - origin[axis]) / direction[axis];
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        if (t0 > t_near) {
+            t_near     = t0;
+            entry_axis = axis;
+        }
+        t_far = std::min(t_far, t1);
+    }
+    if (!inside || t_near > t_far) {
+        return finish();
+    }
+
+    float t = t_near;
+    // Entry cell of a chunk: exact along the axis it was entered through, clamped into the chunk along the
+    // others so that rounding at its faces can not put it next door
+    auto entry_cell = [&](const glm::ivec3& lo, const glm::ivec3& hi) {
+        glm::ivec3 cell = glm::clamp(glm::ivec3(glm::floor(origin + direction * t)), lo, hi);
+        if (entry_axis >= 0) {
+            cell[entry_axis] = step[entry_axis] > 0 ? lo[entry_axis] : hi[entry_axis];
+        }
+        return cell;
+    };
+    glm::ivec3 cell = entry_cell(chunk_lo_ * kSize, (chunk_hi_ + 1) * kSize - 1);
+    glm::ivec3 key  = VoxelGrid::ChunkOf(cell);
+    while (true) {
+        glm::vec3 chunk_t_max;
+        for (int axis = 0; axis < 3; axis++) {
+            const auto plane  = static_cast<float>((key[axis] + (step[axis] > 0 ? 1 : 0)) * kSize);
+            chunk_t_max[axis] = PlaneT(plane, origin[axis], direction[axis]);
+        }
+        const int exit_axis = MinAxis(chunk_t_max);
+        const float t_exit  = std::min(chunk_t_max[exit_axis], t_far);
+
+        const VoxelGrid::Chunk* chunk = grid_->FindChunk(key);
+        if (chunk == nullptr) {
+            local.chunks_skipped++;
+        } else {
+            local.chunks_walked++;
+            if (WalkChunk(*chunk, key, origin, direction, step, t_exit, cell, t, entry_axis, local.cells)) {
+                hit.hit      = true;
+                hit.cell     = cell;
+                hit.distance = t;
+                hit.point    = ray.origin + direction * t;
+                hit.color    = chunk->Color(VoxelGrid::LocalIndex(cell));
+                if (entry_axis >= 0) {
+                    hit.normal[entry_axis] = -step[entry_axis];
+                }
+                local.hits = 1;
+                break;
+            }
+        }
+        if (chunk_t_max[exit_axis] >= t_far) {
+            break;
+        }
+        t = chunk_t_max[exit_axis];
+        key[exit_axis] += step[exit_axis];
+        entry_axis = exit_axis;
+        cell       = entry_cell(key * kSize, key * kSize + kSize - 1);
+    }
+    return finish();
+}
+
+std::vector<voxel::RayHit> voxel::Raycaster::CastBatch(const std::vector<Ray>& rays, float max_distance,
+                                                       unsigned threads, RaycastStats* stats) const {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<RayHit> hits(rays.size());
+    std::mutex stats_mutex;
+    util::ParallelFor(
+        0, rays.size(),
+        [&](std::size_t begin, std::size_t end) {
+            RaycastStats local;
+            for (std::size_t i = begin; i < end; i++) {
+                Cast(rays[i], max_distance, hits[i], &local);
+            }
+            if (stats != nullptr) {
+                std::lock_guard<std::mutex> lock(stats_mutex);
+                AddStats(*stats, local);
+            }
+        },
+        threads, 256);
+    if (stats != nullptr) {
+        stats->seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return hits;
+}
+
+voxel::Ray voxel::CursorRay(const glm::dvec2& cursor, const glm::ivec2& window_size, const glm::mat4& projection,
+                            const glm::mat4& view) {
+    // Window y grows downwards, normalized device y upwards
+    const auto x = static_cast<float>(2 * cursor.x / window_size.x - 1);
+    const auto y = static_cast<float>(1 - 2 * cursor.y / window_size.y);
+    const glm::mat4 inverse = glm::inverse(projection * view);
+    glm::vec4 near_point    = inverse * glm::vec4(x, y, -1, 1);
+    glm::vec4 far_point     = inverse * glm::vec4(x, y, 1, 1);
+    near_point /= near_point.w;
+    far_point /= far_point.w;
+    return {glm::vec3(near_point), glm::normalize(glm::vec3(far_point - near_point))};
+}
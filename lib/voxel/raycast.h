@@ -0,0 +1,71 @@
+#ifndef VOXEL_RAYCAST
+#define VOXEL_RAYCAST
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "voxel_grid.h"
+
+namespace voxel {
+
+struct Ray {
+    glm::vec3 origin;
+    // Need not be normalized; distances are measured along the normalized direction
+    glm::vec3 direction;
+};
+
+struct RayHit {
+    bool hit = false;
+    glm::ivec3 cell{0};
+    // Outward normal of the face the ray entered through, zero when the ray starts inside the block
+    glm::ivec3 normal{0};
+    float distance = 0;
+    glm::vec3 point{0};
+    std::uint16_t color = 0;
+};
+
+struct RaycastStats {
+    std::size_t rays = 0;
+    std::size_t hits = 0;
+    // Cells tested inside stored chunks
+    std::size_t cells = 0;
+    // Stored chunks walked cell by cell, and missing chunks crossed in a single step
+    std::size_t chunks_walked  = 0;
+    std::size_t chunks_skipped = 0;
+    double seconds             = 0;
+};
+
+// First occupied cell along rays through a voxel::VoxelGrid, blocks being unit cubes centered on their cells.
+// The walk is a two level 3D DDA (Amanatides and Woo): it steps chunk by chunk through the box of the stored
+// chunks, crosses missing chunks in one step and only steps cell by cell inside stored ones, so a ray costs
+// O(its length in chunks + cells in the stored chunks it crosses), not O(blocks).
+class Raycaster {
+public:
+    explicit Raycaster(const VoxelGrid& grid);
+
+    // Recomputes the box of the stored chunks; needed after edits add or remove chunks
+    void Update();
+
+    // Fills hit with the first occupied cell within max_distance of the origin. False on a miss.
+    bool Cast(const Ray& ray, float max_distance, RayHit& hit, RaycastStats* stats = nullptr) const;
+
+    // Casts the rays in parallel, for visibility and coverage analysis; hits[i] belongs to rays[i]
+    std::vector<RayHit> CastBatch(const std::vector<Ray>& rays, float max_distance, unsigned threads = 0,
+                                  RaycastStats* stats = nullptr) const;
+
+private:
+    const VoxelGrid* grid_;
+    glm::ivec3 chunk_lo_{0};
+    glm::ivec3 chunk_hi_{-1};
+};
+
+// World space ray under the cursor: window coordinates with the origin at the top left, as glfwGetCursorPos
+// reports them, unprojected through the camera matrices from the near plane to the far plane
+Ray CursorRay(const glm::dvec2& cursor, const glm::ivec2& window_size, const glm::mat4& projection,
+              const glm::mat4& view);
+
+}  // namespace voxel
+
+#endif
@@ -0,0 +1,180 @@
+#include "voxel_grid.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+bool voxel::VoxelGrid::Set(const glm::ivec3& cell, std::uint16_t color) {
+    std::unique_ptr<Chunk>& chunk = chunks_[ChunkOf(cell)];
+    if (!chunk) {
+        chunk = std::make_unique<Chunk>();
+    }
+
+    int index           = LocalIndex(cell);
+    std::uint64_t& word = chunk->bits[index >> 6];
+    std::uint64_t bit   = std::uint64_t(1) << (index & 63);
+    bool inserted       = (word & bit) == 0;
+    word |= bit;
+    if (inserted) {
+        chunk->count++;
+        size_++;
+    }
+
+    chunk->colors.Set(index, color);
+    return inserted;
+}
+
+bool voxel::VoxelGrid::Erase(const glm::ivec3& cell) {
+    auto it = chunks_.find(ChunkOf(cell));
+    if (it == chunks_.end()) {
+        return false;
+    }
+
+    Chunk& chunk        = *it->second;
+    int index           = LocalIndex(cell);
+    std::uint64_t& word = chunk.bits[index >> 6];
+    std::uint64_t bit   = std::uint64_t(1) << (index & 63);
+    if ((word & bit) == 0) {
+        return false;
+    }
+    word &= ~bit;
+    chunk.colors.Set(index, 0);
+    size_--;
+    if (--chunk.count == 0) {
+        chunks_.erase(it);
+    }
+    return true;
+}
+
+bool voxel::VoxelGrid::Contains(const glm::ivec3& cell) const {
+    const Chunk* chunk = FindChunk(ChunkOf(cell));
+    return chunk != nullptr && chunk->Test(LocalIndex(cell));
+}
+
+std::uint16_t voxel::VoxelGrid::Color(const glm::ivec3& cell) const {
+    const Chunk* chunk = FindChunk(ChunkOf(cell));
+    if (chunk == nullptr) {
+        return 0;
+    }
+    int index = LocalIndex(cell);
+    return chunk->Test(index) ? chunk->Color(index) : 0;
+}
+
+void voxel::VoxelGrid::Clear() {
+    chunks_.clear();
+    size_ = 0;
+}
+
+const voxel::VoxelGrid::Chunk* voxel::VoxelGrid::FindChunk(const glm::ivec3& key) const {
+    auto it = chunks_.find(key);
+    return it == chunks_.end() ? nullptr : it->second.get();
+}
+
+void voxel::VoxelGrid::InsertChunk(const glm::ivec3& key, std::unique_ptr<Chunk> chunk) {
+    auto it = chunks_.find(key);
+    if (it != chunks_.end()) {
+        size_ -= it->second->count;
+        chunks_.erase(it);
+    }
+    if (chunk && chunk->count != 0) {
+        size_ += chunk->count;
+        chunks_.emplace(key, std::move(chunk));
+    }
+}
+
+std::pair<glm::ivec3, glm::ivec3> voxel::VoxelGrid::Bounds() const {
+    glm::ivec3 lo(std::numeric_limits<int>::max());
+    glm::ivec3 hi(std::numeric_limits<int>::min());
+    // One pass over the occupancy bits, about one bit per cell
+    ForEach([&](const glm::ivec3& cell, std::uint16_t) {
+        lo = glm::min(lo, cell);
+        hi = glm::max(hi, cell);
+    });
+    return {lo, hi};
+}
+
+std::size_t voxel::VoxelGrid::MemoryUsage() const {
+    // A hash node holds the key, the owning pointer, the cached hash and the next pointer
+    constexpr std::size_t kNodeSize = sizeof(glm::ivec3) + sizeof(std::unique_ptr<Chunk>) + 2 * sizeof(void*);
+    std::size_t bytes = chunks_.bucket_count() * sizeof(void*) + chunks_.size() * (kNodeSize + sizeof(Chunk));
+    for (const auto& [key, chunk] : chunks_) {
+        bytes += chunk->colors.MemoryUsage();
+    }
+    return bytes;
+}
+
+voxel::VoxelGrid::ChunkColors::ChunkColors(const ChunkColors& other) {
+    *this = other;
+}
+
+voxel::VoxelGrid::ChunkColors& voxel::VoxelGrid::ChunkColors::operator=(const ChunkColors& other) {
+    if (this != &other) {
+        words_.reset();
+        if (other.bits_ != 0) {
+            words_ = std::make_unique<std::uint64_t[]>(Words(other.bits_));
+            std::copy_n(other.words_.get(), Words(other.bits_), words_.get());
+        }
+        colors_ = other.colors_;
+        bits_   = other.bits_;
+    }
+    return *this;
+}
+
+void voxel::VoxelGrid::ChunkColors::Set(int index, std::uint16_t color) {
+    if (bits_ == 0) {
+        if (color == 0) {
+            return;
+        }
+        colors_ = {0};
+        Widen(1);
+    }
+    if (bits_ == 16) {
+        Put(index, color);
+        return;
+    }
+    auto it = std::find(colors_.begin(), colors_.end(), color);
+    if (it != colors_.end()) {
+        Put(index, static_cast<std::uint32_t>(it - colors_.begin()));
+        return;
+    }
+    if (colors_.size() == 256) {
+        Widen(16);
+        Put(index, color);
+        return;
+    }
+    colors_.push_back(color);
+    if (colors_.size() > (std::size_t(1) << bits_)) {
+        Widen(bits_ * 2);
+    }
+    Put(index, static_cast<std::uint32_t>(colors_.size() - 1));
+}
+
+std::size_t voxel::VoxelGrid::ChunkColors::MemoryUsage() const {
+    return Words(bits_) * sizeof(std::uint64_t) + colors_.capacity() * sizeof(std::uint16_t);
+}
+
+void voxel::VoxelGrid::ChunkColors::Put(int index, std::uint32_t packed) {
+    const unsigned bit  = static_cast<unsigned>(index) * bits_;
+    std::uint64_t& word = words_[bit >> 6];
+    word                = (word & ~(std::uint64_t(Mask(bits_)) << (bit & 63))) | std::uint64_t(packed) << (bit & 63);
+}
+
+void voxel::VoxelGrid::ChunkColors::Widen(int bits) {
+    ChunkColors wide;
+    wide.words_ = std::make_unique<std::uint64_t[]>(Words(bits));
+    wide.bits_  = bits;
+    if (bits_ != 0) {
+        for (int index = 0; index < kChunkVolume; index++) {
+            const unsigned bit         = static_cast<unsigned>(index) * bits_;
+            const std::uint32_t packed = static_cast<std::uint32_t>(words_[bit >> 6] >> (bit & 63)) & Mask(bits_);
+            // Indices keep their value, cells holding colors get the color an index stood for
+            wide.Put(index, bits == 16 ? colors_[packed] : packed);
+        }
+    }
+    words_ = std::move(wide.words_);
+    bits_  = bits;
+    if (bits == 16) {
+        colors_.clear();
+        colors_.shrink_to_fit();
+    }
+}
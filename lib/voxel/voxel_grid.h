@@ -0,0 +1,146 @@
+#ifndef VOXEL_VOXEL_GRID
+#define VOXEL_VOXEL_GRID
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace voxel {
+
+// Sparse set of occupied cells. Cells are grouped into 32^3 chunks stored in a hash map keyed by chunk
+// coordinate; a chunk keeps one occupancy bit per cell and allocates per-cell colors only when some cell
+// in it gets a non-default color. Colors are bit-packed indices into the few colors the chunk uses.
+class VoxelGrid {
+public:
+    static constexpr int kChunkBits   = 5;
+    static constexpr int kChunkSize   = 1 << kChunkBits;
+    static constexpr int kChunkMask   = kChunkSize - 1;
+    static constexpr int kChunkVolume = kChunkSize * kChunkSize * kChunkSize;
+    static constexpr int kChunkWords  = kChunkVolume / 64;
+
+    // Palette index of every cell of a chunk. Cells hold 1, 2, 4 or 8 bit indices into the list of colors the
+    // chunk uses, widened as that list grows past 2, 4, 16 and 256 colors; beyond that they hold the colors
+    // themselves, 16 bits each. Nothing is allocated while every cell has color 0, and a chunk of a few colors
+    // costs about as much as its occupancy bits.
+    class ChunkColors {
+    public:
+        ChunkColors() = default;
+        ChunkColors(const ChunkColors& other);
+        ChunkColors(ChunkColors&&) = default;
+
+        ChunkColors& operator=(const ChunkColors& other);
+        ChunkColors& operator=(ChunkColors&&) = default;
+
+        // False while every cell has color 0
+        explicit operator bool() const { return bits_ != 0; }
+
+        std::uint16_t Get(int index) const {
+            if (bits_ == 0) {
+                return 0;
+            }
+            const unsigned bit         = static_cast<unsigned>(index) * bits_;
+            const std::uint32_t packed = static_cast<std::uint32_t>(words_[bit >> 6] >> (bit & 63)) & Mask(bits_);
+            return bits_ == 16 ? static_cast<std::uint16_t>(packed) : colors_[packed];
+        }
+        void Set(int index, std::uint16_t color);
+
+        // Heap bytes of the packed cells and the color list
+        std::size_t MemoryUsage() const;
+
+    private:
+        static std::uint32_t Mask(int bits) { return (std::uint32_t(1) << bits) - 1; }
+        static std::size_t Words(int bits) { return static_cast<std::size_t>(kChunkVolume) * bits / 64; }
+
+        void Put(int index, std::uint32_t packed);
+        // Repacks the cells with more bits each
+        void Widen(int bits);
+
+        std::unique_ptr<std::uint64_t[]> words_;
+        // Colors the indices refer to, color 0 first; empty once cells hold colors
+        std::vector<std::uint16_t> colors_;
+        int bits_ = 0;
+    };
+
+    struct Chunk {
+        // Bit (x | y << 5 | z << 10) is set when local cell (x, y, z) is occupied
+        std::array<std::uint64_t, kChunkWords> bits{};
+        ChunkColors colors;
+        std::uint32_t count = 0;
+
+        bool Test(int index) const { return (bits[index >> 6] >> (index & 63) & 1) != 0; }
+        std::uint16_t Color(int index) const { return colors.Get(index); }
+    };
+
+    struct ChunkKeyHash {
+        std::size_t operator()(const glm::ivec3& key) const {
+            return static_cast<std::size_t>(key.x) * 73856093u ^ static_cast<std::size_t>(key.y) * 19349663u ^
+                   static_cast<std::size_t>(key.z) * 83492791u;
+        }
+    };
+    using ChunkMap = std::unordered_map<glm::ivec3, std::unique_ptr<Chunk>, ChunkKeyHash>;
+
+    static glm::ivec3 ChunkOf(const glm::ivec3& cell) {
+        return glm::ivec3(cell.x >> kChunkBits, cell.y >> kChunkBits, cell.z >> kChunkBits);
+    }
+    static int LocalIndex(const glm::ivec3& cell) {
+        return (cell.x & kChunkMask) | (cell.y & kChunkMask) << kChunkBits | (cell.z & kChunkMask) << (2 * kChunkBits);
+    }
+    static glm::ivec3 LocalCell(int index) {
+        return glm::ivec3(index & kChunkMask, index >> kChunkBits & kChunkMask, index >> (2 * kChunkBits));
+    }
+
+    // Marks the cell occupied and sets its color. Returns true if the cell was empty before.
+    bool Set(const glm::ivec3& cell, std::uint16_t color = 0);
+    // Returns true if the cell was occupied
+    bool Erase(const glm::ivec3& cell);
+    bool Contains(const glm::ivec3& cell) const;
+    // Color of an occupied cell, 0 for empty cells
+    std::uint16_t Color(const glm::ivec3& cell) const;
+
+    void Clear();
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const ChunkMap& chunks() const { return chunks_; }
+    const Chunk* FindChunk(const glm::ivec3& key) const;
+    // Replaces the whole chunk at key, e.g. one built by another thread. Empty chunks are not stored.
+    void InsertChunk(const glm::ivec3& key, std::unique_ptr<Chunk> chunk);
+
+    // Bounds of the occupied cells, {min, max} inclusive. Meaningless for an empty grid.
+    std::pair<glm::ivec3, glm::ivec3> Bounds() const;
+
+    // Approximate heap footprint in bytes: chunk payloads, packed colors and hash map nodes
+    std::size_t MemoryUsage() const;
+
+    // Calls visit(cell, color) for every occupied cell, chunk by chunk
+    template <typename Visitor>
+    void ForEach(Visitor&& visit) const {
+        for (const auto& [key, chunk] : chunks_) {
+            ForEachInChunk(key, *chunk, visit);
+        }
+    }
+
+    template <typename Visitor>
+    static void ForEachInChunk(const glm::ivec3& key, const Chunk& chunk, Visitor&& visit) {
+        const glm::ivec3 origin = key * kChunkSize;
+        for (int word = 0; word < kChunkWords; word++) {
+            for (std::uint64_t bits = chunk.bits[word]; bits != 0; bits &= bits - 1) {
+                int index = word * 64 + std::countr_zero(bits);
+                visit(origin + LocalCell(index), chunk.Color(index));
+            }
+        }
+    }
+
+private:
+    ChunkMap chunks_;
+    std::size_t size_ = 0;
+};
+
+}  // namespace voxel
+
+#endif
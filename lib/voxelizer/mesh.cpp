@@ -0,0 +1,45 @@
+#include "mesh.h"
+
+#include <limits>
+
+#include "io/obj.h"
+
+namespace {
+
+// Default diffuse color of triangles outside any material, as most exporters write it
+const glm::vec3 kDefaultDiffuse(0.8f);
+
+}  // namespace
+
+std::pair<glm::vec3, glm::vec3> voxel::Mesh::Bounds() const {
+    glm::vec3 lo(std::numeric_limits<float>::max());
+    glm::vec3 hi(std::numeric_limits<float>::lowest());
+    for (const glm::vec3& vertex : vertices) {
+        lo = glm::min(lo, vertex);
+        hi = glm::max(hi, vertex);
+    }
+    return {lo, hi};
+}
+
+bool voxel::LoadObj(const std::filesystem::path& path, Mesh& mesh, unsigned threads) {
+    io::ObjOptions options;
+    options.threads         = threads;
+    options.uvs_and_normals = false;
+    io::ObjData obj;
+    if (!io::ReadObj(path, obj, options)) {
+        return false;
+    }
+    mesh.vertices           = std::move(obj.positions);
+    mesh.triangles          = std::move(obj.triangles);
+    mesh.vertex_colors      = std::move(obj.colors);
+    mesh.material_libraries = std::move(obj.material_libraries);
+    mesh.triangle_colors.clear();
+    if (!obj.triangle_materials.empty()) {
+        mesh.triangle_colors.reserve(mesh.triangles.size());
+        for (std::uint32_t material : obj.triangle_materials) {
+            mesh.triangle_colors.push_back(material == io::ObjData::kNone ? kDefaultDiffuse
+                                                                          : obj.materials[material].diffuse);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef VOXELIZER_MESH
+#define VOXELIZER_MESH
+
+#include <filesystem>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace voxel {
+
+// Indexed triangle soup: every triangle holds three indices into vertices
+struct Mesh {
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::uvec3> triangles;
+    // sRGB color of every vertex, empty when the mesh has none
+    std::vector<glm::vec3> vertex_colors;
+    // Diffuse material color of every triangle, empty when the mesh has no materials
+    std::vector<glm::vec3> triangle_colors;
+    // .mtl files the colors came from, which a cache of the mesh depends on as well
+    std::vector<std::filesystem::path> material_libraries;
+
+    bool HasColors() const { return !vertex_colors.empty() || !triangle_colors.empty(); }
+
+    // Axis-aligned bounds of all vertices, {min, max}
+    std::pair<glm::vec3, glm::vec3> Bounds() const;
+};
+
+// Reads the positions and triangles of a Wavefront .obj file with io::ReadObj on `threads` threads (0 means
+// all); texture and normal references are ignored. Vertex colors (`v x y z r g b`) and the Kd colors of
+// `usemtl` materials from `mtllib` files are kept.
+bool LoadObj(const std::filesystem::path& path, Mesh& mesh, unsigned threads = 0);
+
+}  // namespace voxel
+
+#endif
@@ -0,0 +1,189 @@
+#include "mesh_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr std::uint32_t kVersion = 2;
+
+// Size and modification time of the model, what its cache is checked against
+bool SourceStamp(const std::filesystem::path& model, std::uint64_t& size, std::int64_t& time) {
+    std::error_code error;
+    size = std::filesystem::file_size(model, error);
+    if (error) {
+        return false;
+    }
+    time = static_cast<std::int64_t>(std::filesystem::last_write_time(model, error).time_since_epoch().count());
+    return !error;
+}
+
+// Stamp of a .mtl file; kMeshCacheMissing when it cannot be read
+voxel::MeshCacheLibrary LibraryStamp(const std::filesystem::path& library) {
+    voxel::MeshCacheLibrary stamp{};
+    if (!SourceStamp(library, stamp.size, stamp.time)) {
+        stamp.size = voxel::kMeshCacheMissing;
+        stamp.time = 0;
+    }
+    return stamp;
+}
+
+template <typename T>
+void WriteArray(std::ofstream& file, const std::vector<T>& values) {
+    file.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+template <typename T>
+bool ReadArray(std::ifstream& file, std::vector<T>& values, std::uint64_t count) {
+    values.resize(count);
+    file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(count * sizeof(T)));
+    return file.good();
+}
+
+}  // namespace
+
+std::filesystem::path voxel::MeshCachePath(const std::filesystem::path& model) {
+    std::filesystem::path path = model;
+    path += kMeshCacheExtension;
+    return path;
+}
+
+bool voxel::WriteMeshCache(const std::filesystem::path& model, const Mesh& mesh, const TriangleBvh& bvh) {
+    MeshCacheHeader header{};
+    std::memcpy(header.magic, kMeshCacheMagic, sizeof(kMeshCacheMagic));
+    header.version = kVersion;
+    if (!mesh.vertex_colors.empty()) {
+        header.flags |= kMeshCacheVertexColors;
+    }
+    if (!mesh.triangle_colors.empty()) {
+        header.flags |= kMeshCacheTriangleColors;
+    }
+    if (!SourceStamp(model, header.source_size, header.source_time)) {
+        std::cerr << "Impossible to open " << model << '\n';
+        return false;
+    }
+    header.vertices  = mesh.vertices.size();
+    header.triangles = mesh.triangles.size();
+    header.nodes     = bvh.nodes().size();
+    header.libraries = mesh.material_libraries.size();
+
+    const std::filesystem::path path = MeshCachePath(model);
+    std::filesystem::path temporary  = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Impossible to open " << temporary << " for writing\n";
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const std::filesystem::path& library : mesh.material_libraries) {
+            const std::string name = library.string();
+            MeshCacheLibrary stamp = LibraryStamp(library);
+            stamp.path_length      = name.size();
+            file.write(reinterpret_cast<const char*>(&stamp), sizeof(stamp));
+            file.write(name.data(), static_cast<std::streamsize>(name.size()));
+        }
+        WriteArray(file, mesh.vertices);
+        WriteArray(file, mesh.triangles);
+        WriteArray(file, mesh.vertex_colors);
+        WriteArray(file, mesh.triangle_colors);
+        WriteArray(file, bvh.nodes());
+        WriteArray(file, bvh.order());
+        if (!file.good()) {
+            std::cerr << "Impossible to write " << temporary << '\n';
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::cerr << "Impossible to replace " << path << ": " << error.message() << '\n';
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+bool voxel::ReadMeshCache(const std::filesystem::path& model, Mesh& mesh, TriangleBvh& bvh) {
+    const std::filesystem::path path = MeshCachePath(model);
+    std::ifstream file(path, std::ios::binary);
+    std::uint64_t source_size = 0;
+    std::int64_t source_time  = 0;
+    if (!file.is_open() || !SourceStamp(model, source_size, source_time)) {
+        return false;
+    }
+    MeshCacheHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMeshCacheMagic, sizeof(kMeshCacheMagic)) != 0 || header.version != kVersion) {
+        std::cerr << path << " is not a version " << kVersion << " mesh cache\n";
+        return false;
+    }
+    if (header.source_size != source_size || header.source_time != source_time) {
+        return false;
+    }
+    std::error_code error;
+    const std::uint64_t file_size = std::filesystem::file_size(path, error);
+    if (error || header.libraries > file_size / sizeof(MeshCacheLibrary)) {
+        std::cerr << path << " is truncated\n";
+        return false;
+    }
+    mesh.material_libraries.clear();
+    for (std::uint64_t i = 0; i < header.libraries; i++) {
+        MeshCacheLibrary stored{};
+        if (!file.read(reinterpret_cast<char*>(&stored), sizeof(stored)) || stored.path_length > file_size) {
+            std::cerr << path << " is truncated\n";
+            return false;
+        }
+        std::string name(stored.path_length, '\0');
+        if (!file.read(name.data(), static_cast<std::streamsize>(name.size()))) {
+            std::cerr << path << " is truncated\n";
+            return false;
+        }
+        mesh.material_libraries.emplace_back(name);
+        const MeshCacheLibrary current = LibraryStamp(mesh.material_libraries.back());
+        if (current.size != stored.size || current.time != stored.time) {
+            return false;
+        }
+    }
+
+    // Check the size before allocating anything from the counts
+    const std::uint64_t vertex_colors   = (header.flags & kMeshCacheVertexColors) != 0 ? header.vertices : 0;
+    const std::uint64_t triangle_colors = (header.flags & kMeshCacheTriangleColors) != 0 ? header.triangles : 0;
+    const std::uint64_t vectors         = header.vertices + vertex_colors + triangle_colors;
+    const std::uint64_t per_triangle    = sizeof(glm::uvec3) + sizeof(std::uint32_t);
+    const std::uint64_t arrays          = vectors * sizeof(glm::vec3) + header.triangles * per_triangle;
+    const std::uint64_t records         = static_cast<std::uint64_t>(file.tellg());
+    const std::uint64_t expected        = records + arrays + header.nodes * sizeof(TriangleBvh::Node);
+    if (file_size != expected) {
+        std::cerr << path << " is truncated\n";
+        return false;
+    }
+
+    std::vector<TriangleBvh::Node> nodes;
+    std::vector<std::uint32_t> order;
+    if (!ReadArray(file, mesh.vertices, header.vertices) || !ReadArray(file, mesh.triangles, header.triangles) ||
+        !ReadArray(file, mesh.vertex_colors, vertex_colors) ||
+        !ReadArray(file, mesh.triangle_colors, triangle_colors) || !ReadArray(file, nodes, header.nodes) ||
+        !ReadArray(file, order, header.triangles)) {
+        std::cerr << path << " is truncated\n";
+        return false;
+    }
+    for (const glm::uvec3& triangle : mesh.triangles) {
+        if (std::max({triangle.x, triangle.y, triangle.z}) >= header.vertices) {
+            std::cerr << "Bad vertex index in " << path << '\n';
+            return false;
+        }
+    }
+    if (!bvh.Assign(std::move(nodes), std::move(order), mesh.triangles.size())) {
+        std::cerr << path << " holds a broken tree\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef VOXELIZER_MESH_CACHE
+#define VOXELIZER_MESH_CACHE
+
+#include <cstdint>
+#include <filesystem>
+
+#include "mesh.h"
+#include "triangle_bvh.h"
+
+namespace voxel {
+
+// Binary cache of a parsed model and its voxel::TriangleBvh, kept next to the model as model.obj.bvh. Neither
+// depends on the block size, so voxelizing the model again at another size reads them back instead of parsing
+// the model and building the tree. The header records the size and modification time of the model, and
+// `libraries` MeshCacheLibrary records after it those of every .mtl file the model names; a cache that does not
+// match them all is stale. The arrays follow the records in the order of the header counts.
+struct MeshCacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    // kMeshCacheVertexColors | kMeshCacheTriangleColors
+    std::uint32_t flags;
+    std::uint64_t source_size;
+    std::int64_t source_time;
+    std::uint64_t vertices;
+    std::uint64_t triangles;
+    std::uint64_t nodes;
+    std::uint64_t libraries;
+};
+static_assert(sizeof(MeshCacheHeader) == 64, "MeshCacheHeader is written as it is");
+
+// Stamp of a .mtl file, followed by the path_length bytes of its path. A missing file has size
+// kMeshCacheMissing, so that the cache goes stale once it appears.
+struct MeshCacheLibrary {
+    std::uint64_t size;
+    std::int64_t time;
+    std::uint64_t path_length;
+};
+static_assert(sizeof(MeshCacheLibrary) == 24, "MeshCacheLibrary is written as it is");
+
+inline constexpr char kMeshCacheMagic[8]                = {'3', 'D', '2', 'M', 'C', 'B', 'V', 'H'};
+inline constexpr char kMeshCacheExtension[]             = ".bvh";
+inline constexpr std::uint32_t kMeshCacheVertexColors   = 1;
+inline constexpr std::uint32_t kMeshCacheTriangleColors = 2;
+inline constexpr std::uint64_t kMeshCacheMissing        = ~std::uint64_t(0);
+
+// Cache file of a model: its path with kMeshCacheExtension appended
+std::filesystem::path MeshCachePath(const std::filesystem::path& model);
+
+// Writes the cache of model next to it, through a temporary file so that a concurrent reader never sees half
+// of it
+bool WriteMeshCache(const std::filesystem::path& model, const Mesh& mesh, const TriangleBvh& bvh);
+
+// Reads the cache of model, with the .mtl paths of mesh.material_libraries. False when it is missing, stale or
+// damaged; then the model has to be parsed.
+bool ReadMeshCache(const std::filesystem::path& model, Mesh& mesh, TriangleBvh& bvh);
+
+}  // namespace voxel
+
+#endif
@@ -0,0 +1,156 @@
+#include "solid_fill.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "util/parallel.h"
+
+namespace {
+
+// Column rows a task handles; triangles are binned by the rows they cover
+constexpr int kSlabRows = 8;
+// Columns tested at once along a row, a batch the compiler can vectorize
+constexpr int kBatch = 16;
+// Cells the BVH query around a slab reaches past its rows, far more than vertices move by rounding
+constexpr float kQueryMargin = 0.25f;
+
+// Twice the signed area of (a, b, p), always computed from the lexicographically smaller endpoint, so an edge
+// shared by two triangles yields exactly opposite values for them
+double EdgeFunction(const glm::dvec2& a, const glm::dvec2& b, const glm::dvec2& p) {
+    const bool swapped  = b.x < a.x || (b.x == a.x && b.y < a.y);
+    const glm::dvec2& s = swapped ? b : a;
+    const glm::dvec2& e = swapped ? a : b;
+    double value        = (e.x - s.x) * (p.y - s.y) - (e.y - s.y) * (p.x - s.x);
+    return swapped ? -value : value;
+}
+
+// Points exactly on an edge belong to the triangle for which the edge is a top or left edge; the other
+// triangle sharing the edge sees it reversed and leaves them out
+bool OwnsEdge(const glm::dvec2& a, const glm::dvec2& b) {
+    return b.y < a.y || (b.y == a.y && b.x < a.x);
+}
+
+}  // namespace
+
+voxel::ColumnCrossings::ColumnCrossings(const std::vector<glm::vec3>& points,
+                                        const std::vector<glm::uvec3>& triangles, int axis, const glm::ivec2& lo,
+                                        const glm::ivec2& hi, unsigned threads, const TriangleBvh* bvh,
+                                        const glm::vec3& lower, float block_size)
+    : axis_(axis)
+    , lo_(lo)
+    , columns_(glm::max(hi - lo + 1, glm::ivec2(0))) {
+    const int u_axis = axis == 0 ? 1 : 0;
+    const int v_axis = axis == 2 ? 1 : 2;
+    offsets_.assign(static_cast<std::size_t>(columns_.x) * columns_.y + 1, 0);
+    if (columns_.x == 0 || columns_.y == 0) {
+        return;
+    }
+
+    // Bin triangles by the slabs of rows whose centers their projection can contain, unless the BVH finds them
+    const int slabs = (columns_.y + kSlabRows - 1) / kSlabRows;
+    std::vector<std::vector<std::uint32_t>> bins(static_cast<std::size_t>(slabs));
+    for (std::size_t i = 0; bvh == nullptr && i < triangles.size(); i++) {
+        const glm::uvec3& triangle = triangles[i];
+        // Same double arithmetic as the row range of the slab task, so no row is lost between them
+        double v_lo = std::min({points[triangle.x][v_axis], points[triangle.y][v_axis], points[triangle.z][v_axis]});
+        double v_hi = std::max({points[triangle.x][v_axis], points[triangle.y][v_axis], points[triangle.z][v_axis]});
+        int first   = std::max(static_cast<int>(std::ceil(v_lo - 0.5)) - lo.y, 0);
+        int last    = std::min(static_cast<int>(std::floor(v_hi - 0.5)) - lo.y, columns_.y - 1);
+        for (int slab = first / kSlabRows; first <= last && slab <= last / kSlabRows; slab++) {
+            bins[static_cast<std::size_t>(slab)].push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+
+    // Every slab owns a contiguous range of columns: it collects, sorts and counts their crossings on its own
+    std::vector<std::vector<std::pair<std::uint32_t, Crossing>>> found(static_cast<std::size_t>(slabs));
+    util::ParallelTasks(
+        static_cast<std::size_t>(slabs),
+        [&](std::size_t slab, unsigned) {
+            const int row_begin = static_cast<int>(slab) * kSlabRows;
+            const int row_end   = std::min(row_begin + kSlabRows, columns_.y);
+            std::vector<std::pair<std::uint32_t, Crossing>>& out = found[slab];
+            if (bvh != nullptr) {
+                // Triangles reaching the rows of the slab, in index order like the bins
+                glm::vec3 box_lo(std::numeric_limits<float>::lowest());
+                glm::vec3 box_hi(std::numeric_limits<float>::max());
+                box_lo[v_axis] = lower[v_axis] + (lo.y + row_begin + 0.5f - kQueryMargin) * block_size;
+                box_hi[v_axis] = lower[v_axis] + (lo.y + row_end - 0.5f + kQueryMargin) * block_size;
+                bvh->ForEachOverlap(box_lo, box_hi, [&](std::uint32_t triangle) { bins[slab].push_back(triangle); });
+                std::sort(bins[slab].begin(), bins[slab].end());
+            }
+            for (std::uint32_t triangle_index : bins[slab]) {
+                const glm::uvec3& triangle = triangles[triangle_index];
+                glm::dvec2 a(points[triangle.x][u_axis], points[triangle.x][v_axis]);
+                glm::dvec2 b(points[triangle.y][u_axis], points[triangle.y][v_axis]);
+                glm::dvec2 c(points[triangle.z][u_axis], points[triangle.z][v_axis]);
+                glm::dvec3 depth(points[triangle.x][axis], points[triangle.y][axis], points[triangle.z][axis]);
+                // Counter-clockwise in the projection; triangles seen edge-on are never crossed
+                double area = EdgeFunction(a, b, c);
+                if (area == 0) {
+                    continue;
+                }
+                if (area < 0) {
+                    std::swap(b, c);
+                    std::swap(depth.y, depth.z);
+                    area = -area;
+                }
+                const bool own_ab = OwnsEdge(a, b);
+                const bool own_bc = OwnsEdge(b, c);
+                const bool own_ca = OwnsEdge(c, a);
+
+                const double u_lo = std::min({a.x, b.x, c.x});
+                const double u_hi = std::max({a.x, b.x, c.x});
+                const int u_first = std::max(static_cast<int>(std::ceil(u_lo - 0.5)), lo.x);
+                const int u_last  = std::min(static_cast<int>(std::floor(u_hi - 0.5)), lo.x + columns_.x - 1);
+                const double v_lo = std::min({a.y, b.y, c.y});
+                const double v_hi = std::max({a.y, b.y, c.y});
+                const int v_first = std::max(static_cast<int>(std::ceil(v_lo - 0.5)) - lo.y, row_begin);
+                const int v_last  = std::min(static_cast<int>(std::floor(v_hi - 0.5)) - lo.y, row_end - 1);
+                for (int row = v_first; row <= v_last; row++) {
+                    const double v = lo.y + row + 0.5;
+                    for (int batch = u_first; batch <= u_last; batch += kBatch) {
+                        const int count = std::min(kBatch, u_last - batch + 1);
+                        double w0[kBatch];
+                        double w1[kBatch];
+                        double w2[kBatch];
+                        for (int i = 0; i < count; i++) {
+                            const glm::dvec2 p(batch + i + 0.5, v);
+                            w0[i] = EdgeFunction(b, c, p);
+                            w1[i] = EdgeFunction(c, a, p);
+                            w2[i] = EdgeFunction(a, b, p);
+                        }
+                        for (int i = 0; i < count; i++) {
+                            if ((w0[i] > 0 || (w0[i] == 0 && own_bc)) && (w1[i] > 0 || (w1[i] == 0 && own_ca)) &&
+                                (w2[i] > 0 || (w2[i] == 0 && own_ab))) {
+                                const double d = (w0[i] * depth.x + w1[i] * depth.y + w2[i] * depth.z) / area;
+                                const auto column =
+                                    static_cast<std::uint32_t>(row * columns_.x + (batch + i - lo.x));
+                                out.push_back({column, Crossing{static_cast<float>(d), triangle_index}});
+                            }
+                        }
+                    }
+                }
+            }
+            std::sort(out.begin(), out.end(), [](const auto& x, const auto& y) {
+                return x.first != y.first ? x.first < y.first : x.second.depth < y.second.depth;
+            });
+            for (const auto& [column, crossing] : out) {
+                offsets_[column + 1]++;
+            }
+        },
+        threads);
+
+    for (std::size_t column = 0; column + 1 < offsets_.size(); column++) {
+        odd_columns_ += offsets_[column + 1] & 1;
+        offsets_[column + 1] += offsets_[column];
+    }
+    // Slabs are in column order, so their sorted crossings concatenate into the sorted whole
+    crossings_.reserve(offsets_.back());
+    for (const std::vector<std::pair<std::uint32_t, Crossing>>& slab : found) {
+        for (const auto& [column, crossing] : slab) {
+            crossings_.push_back(crossing);
+        }
+    }
+}
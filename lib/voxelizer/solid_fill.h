@@ -0,0 +1,56 @@
+#ifndef VOXELIZER_SOLID_FILL
+#define VOXELIZER_SOLID_FILL
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+#include "triangle_bvh.h"
+
+namespace voxel {
+
+// Where a ray through a column center crosses the mesh: the depth along the ray and the triangle crossed
+struct Crossing {
+    float depth;
+    std::uint32_t triangle;
+};
+
+// Crossings of the axis-parallel rays through the centers of a rectangle of grid columns, sorted by depth.
+// A column (u, v) spans the two other axes in increasing order, e.g. (y, z) for rays along x. Crossings are
+// found with exact edge functions evaluated in a fixed order per edge and a top-left rule for ties, so a ray
+// through an edge or vertex shared by triangles of a closed mesh crosses it exactly once and the crossing
+// count of a column is even for watertight meshes.
+class ColumnCrossings {
+public:
+    // points are in grid space, where cell (i, j, k) is the unit box at (i, j, k). Columns lo..hi are inclusive.
+    // Given a BVH over the mesh the points were made from by (vertex - lower) / block_size, every row of columns
+    // takes its triangles from it instead of a pass over all triangles.
+    ColumnCrossings(const std::vector<glm::vec3>& points, const std::vector<glm::uvec3>& triangles, int axis,
+                    const glm::ivec2& lo, const glm::ivec2& hi, unsigned threads = 0, const TriangleBvh* bvh = nullptr,
+                    const glm::vec3& lower = glm::vec3(0), float block_size = 1);
+
+    int axis() const { return axis_; }
+    // Columns with an odd crossing count: rays that enter a mesh which is not closed without leaving it
+    std::size_t odd_columns() const { return odd_columns_; }
+    std::size_t size() const { return crossings_.size(); }
+
+    std::span<const Crossing> Column(int u, int v) const {
+        const std::size_t column = static_cast<std::size_t>(v - lo_.y) * columns_.x + (u - lo_.x);
+        return std::span<const Crossing>(crossings_.data() + offsets_[column], offsets_[column + 1] - offsets_[column]);
+    }
+
+private:
+    int axis_;
+    glm::ivec2 lo_;
+    glm::ivec2 columns_;
+    // Crossings of column c are crossings_[offsets_[c], offsets_[c + 1])
+    std::vector<std::uint32_t> offsets_;
+    std::vector<Crossing> crossings_;
+    std::size_t odd_columns_ = 0;
+};
+
+}  // namespace voxel
+
+#endif
@@ -0,0 +1,414 @@
+#include "streaming.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "io/mapped_file.h"
+#include "io/obj.h"
+#include "io/xyz.h"
+
+namespace {
+
+// Bytes of the model parsed before their pages are released
+constexpr std::size_t kBatchSize = std::size_t(16) << 20;
+// Working memory per triangle of a slab being voxelized: the mesh vertices and indices, their grid space
+// copies, tile bins and a share of the resulting cells
+constexpr std::size_t kTriangleCost = 128;
+// Smallest write buffer of one slab, in triangles
+constexpr std::size_t kMinSlabBuffer = 64;
+
+// Triangle record of a slab file, world space corners
+struct SlabTriangle {
+    glm::vec3 corners[3];
+};
+
+// Directory of the scratch files of one run, removed with them however the voxelization ends. The directory
+// is always a new one: when base exists, e.g. left by another run, a numbered name next to it is taken, so
+// nothing the run did not write is ever removed.
+class ScratchDirectory {
+public:
+    explicit ScratchDirectory(const std::filesystem::path& base) {
+        std::error_code error;
+        if (!base.parent_path().empty()) {
+            std::filesystem::create_directories(base.parent_path(), error);
+        }
+        for (int attempt = 0; attempt < 1000 && !error; attempt++) {
+            std::filesystem::path path = base;
+            if (attempt != 0) {
+                path += '.';
+                path += std::to_string(attempt);
+            }
+            if (std::filesystem::create_directory(path, error)) {
+                path_    = path;
+                created_ = true;
+                return;
+            }
+        }
+    }
+    ScratchDirectory(const ScratchDirectory&) = delete;
+    ~ScratchDirectory() {
+        if (!created_) {
+            return;
+        }
+        std::error_code error;
+        for (const std::filesystem::path& file : files_) {
+            std::filesystem::remove(file, error);
+        }
+        // Only removed when empty
+        std::filesystem::remove(path_, error);
+    }
+
+    ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+
+    // Path of a scratch file of the run, removed with the directory
+    std::filesystem::path File(const std::string& name) {
+        files_.push_back(path_ / name);
+        return files_.back();
+    }
+
+    bool created() const { return created_; }
+    const std::filesystem::path& path() const { return path_; }
+
+private:
+    std::filesystem::path path_;
+    std::vector<std::filesystem::path> files_;
+    bool created_ = false;
+};
+
+// Buffered appends of triangles to a set of slab files. Files are opened only while a buffer is flushed,
+// so any number of slabs stays within the open file limit.
+class SlabWriter {
+public:
+    SlabWriter(std::vector<std::filesystem::path> paths, std::size_t buffer_bytes)
+        : paths_(std::move(paths))
+        , buffers_(paths_.size())
+        , capacity_(std::max(kMinSlabBuffer, buffer_bytes / sizeof(SlabTriangle))) {
+    }
+
+    void Append(std::size_t slab, const SlabTriangle& triangle) {
+        std::vector<SlabTriangle>& buffer = buffers_[slab];
+        if (buffer.empty()) {
+            buffer.reserve(capacity_);
+        }
+        buffer.push_back(triangle);
+        if (buffer.size() == capacity_) {
+            Flush(slab);
+        }
+    }
+
+    // Writes every buffer out; false if any write failed so far
+    bool Finish() {
+        for (std::size_t slab = 0; slab < buffers_.size(); slab++) {
+            Flush(slab);
+        }
+        return ok_;
+    }
+
+private:
+    void Flush(std::size_t slab) {
+        std::vector<SlabTriangle>& buffer = buffers_[slab];
+        if (buffer.empty()) {
+            return;
+        }
+        std::ofstream file(paths_[slab], std::ios::binary | std::ios::app);
+        file.write(reinterpret_cast<const char*>(buffer.data()),
+                   static_cast<std::streamsize>(buffer.size() * sizeof(SlabTriangle)));
+        if (!file) {
+            std::cerr << "Impossible to write " << paths_[slab] << '\n';
+            ok_ = false;
+        }
+        buffer.clear();
+    }
+
+    std::vector<std::filesystem::path> paths_;
+    std::vector<std::vector<SlabTriangle>> buffers_;
+    std::size_t capacity_;
+    bool ok_ = true;
+};
+
+// Calls visit(type, rest) for every record of the file, see io::ForEachObjRecord. The file is read in
+// batches of whole lines whose pages are released once they are parsed, so the resident part of the mapping
+// stays around kBatchSize. Prints the record visit failed on.
+template <typename Visitor>
+bool ForEachRecord(const io::MappedFile& file, const std::filesystem::path& path, Visitor&& visit) {
+    std::string_view text = file.view();
+    for (std::size_t begin = 0; begin < text.size();) {
+        std::size_t end = std::min(begin + kBatchSize, text.size());
+        end             = end == text.size() ? end : text.find('\n', end);
+        end             = end == std::string_view::npos ? text.size() : end + 1;
+        std::string_view error = io::ForEachObjRecord(text.substr(begin, end - begin), visit);
+        if (!error.empty()) {
+            std::cerr << "Bad record in " << path << ": " << error << '\n';
+            return false;
+        }
+        file.Release(begin, end);
+        begin = end;
+    }
+    return true;
+}
+
+// Grid space of the whole model, shared by the binning and every slab
+struct Grid {
+    glm::vec3 lower;
+    glm::ivec3 size;
+    float inv_block_size;
+
+    // Layers touched by the triangle, computed like the cell ranges of voxel::VoxelizeRegion
+    std::pair<int, int> Layers(const SlabTriangle& triangle) const {
+        float lo = std::numeric_limits<float>::max();
+        float hi = std::numeric_limits<float>::lowest();
+        for (const glm::vec3& corner : triangle.corners) {
+            float y = ((corner - lower) * inv_block_size).y;
+            lo      = std::min(lo, y);
+            hi      = std::max(hi, y);
+        }
+        return {std::clamp(static_cast<int>(std::floor(lo)), 0, size.y - 1),
+                std::clamp(static_cast<int>(std::floor(hi)), 0, size.y - 1)};
+    }
+};
+
+class SlabVoxelizer {
+public:
+    SlabVoxelizer(const Grid& grid, const voxel::StreamingOptions& options, ScratchDirectory& scratch,
+                  io::XYZWriter& writer, voxel::StreamingStats& stats)
+        : grid_(grid)
+        , options_(options)
+        , scratch_(scratch)
+        , writer_(writer)
+        , stats_(stats) {
+    }
+
+    // Voxelizes the layers [first, last] whose triangles are in path, then removes the file
+    bool Run(const std::filesystem::path& path, int first, int last) {
+        std::error_code error;
+        std::uintmax_t bytes = std::filesystem::exists(path, error) ? std::filesystem::file_size(path, error) : 0;
+        std::size_t count    = static_cast<std::size_t>(bytes / sizeof(SlabTriangle));
+        if (count == 0) {
+            std::filesystem::remove(path, error);
+            return true;
+        }
+        if (count * kTriangleCost > options_.memory_budget && first < last) {
+            return Split(path, first, last);
+        }
+
+        voxel::Mesh mesh;
+        {
+            std::vector<SlabTriangle> triangles(count);
+            std::ifstream file(path, std::ios::binary);
+            if (!file.read(reinterpret_cast<char*>(triangles.data()), static_cast<std::streamsize>(bytes))) {
+                std::cerr << "Impossible to read " << path << '\n';
+                return false;
+            }
+            mesh.vertices.reserve(3 * count);
+            mesh.triangles.reserve(count);
+            for (const SlabTriangle& triangle : triangles) {
+                auto base = static_cast<unsigned>(mesh.vertices.size());
+                mesh.vertices.insert(mesh.vertices.end(), triangle.corners, triangle.corners + 3);
+                mesh.triangles.emplace_back(base, base + 1, base + 2);
+            }
+        }
+        std::filesystem::remove(path, error);
+
+        // A BVH would be over the whole model, the slab mesh holds copies of its triangles
+        voxel::VoxelizeOptions voxelize = options_.voxelize;
+        voxelize.bvh                    = nullptr;
+        std::vector<glm::ivec3> cells =
+            voxel::VoxelizeRegion(mesh, grid_.lower, grid_.size, glm::ivec3(0, first, 0),
+                                  glm::ivec3(grid_.size.x - 1, last, grid_.size.z - 1), voxelize);
+        writer_.Write(cells);
+        stats_.slabs++;
+        stats_.largest_slab = std::max(stats_.largest_slab, count);
+        stats_.blocks += cells.size();
+        return true;
+    }
+
+private:
+    // Halves a slab over budget and voxelizes both halves
+    bool Split(const std::filesystem::path& path, int first, int last) {
+        const int middle = first + (last - first) / 2;
+        const std::string name                 = path.filename().string();
+        const std::filesystem::path lower_half = scratch_.File(name + ".0");
+        const std::filesystem::path upper_half = scratch_.File(name + ".1");
+        {
+            SlabWriter halves({lower_half, upper_half}, options_.memory_budget / 4);
+            std::ifstream file(path, std::ios::binary);
+            std::vector<SlabTriangle> batch(
+                std::max<std::size_t>(1, options_.memory_budget / 4 / sizeof(SlabTriangle)));
+            while (file) {
+                file.read(reinterpret_cast<char*>(batch.data()),
+                          static_cast<std::streamsize>(batch.size() * sizeof(SlabTriangle)));
+                std::size_t read = static_cast<std::size_t>(file.gcount()) / sizeof(SlabTriangle);
+                for (std::size_t i = 0; i < read; i++) {
+                    auto [lo, hi] = grid_.Layers(batch[i]);
+                    if (lo <= middle) {
+                        halves.Append(0, batch[i]);
+                    }
+                    if (hi > middle) {
+                        halves.Append(1, batch[i]);
+                    }
+                }
+            }
+            if (!halves.Finish()) {
+                return false;
+            }
+        }
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        return Run(lower_half, first, middle) && Run(upper_half, middle + 1, last);
+    }
+
+    const Grid& grid_;
+    const voxel::StreamingOptions& options_;
+    ScratchDirectory& scratch_;
+    io::XYZWriter& writer_;
+    voxel::StreamingStats& stats_;
+};
+
+}  // namespace
+
+bool voxel::VoxelizeObjStreaming(const std::filesystem::path& model, const std::filesystem::path& output,
+                                 const StreamingOptions& options, StreamingStats* stats) {
+    StreamingStats local_stats;
+    StreamingStats& result = stats != nullptr ? *stats : local_stats;
+    result                 = StreamingStats();
+    if (options.voxelize.block_size <= 0) {
+        return false;
+    }
+
+    io::MappedFile file(model);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::filesystem::path scratch_path = options.scratch.empty() ? output.parent_path() : options.scratch;
+    scratch_path /= output.filename();
+    scratch_path += ".slabs";
+    ScratchDirectory scratch(scratch_path);
+    if (!scratch.created()) {
+        std::cerr << "Impossible to create " << scratch_path << '\n';
+        return false;
+    }
+
+    // Pass 1: spill the vertices, measure the bounds and count the triangles
+    const std::filesystem::path vertex_path = scratch.File("vertices.bin");
+    glm::vec3 lo(std::numeric_limits<float>::max());
+    glm::vec3 hi(std::numeric_limits<float>::lowest());
+    {
+        std::ofstream vertices(vertex_path, std::ios::binary);
+        std::vector<glm::vec3> buffer;
+        buffer.reserve(kBatchSize / sizeof(glm::vec3));
+        bool parsed = ForEachRecord(file, model, [&](std::string_view type, std::string_view rest) {
+            if (type == "v") {
+                // Colors are not read: the streaming voxelizer does not color blocks
+                glm::vec3 vertex;
+                glm::vec3 color;
+                bool colored = false;
+                if (!io::ParseObjVertex(rest, vertex, color, colored)) {
+                    return false;
+                }
+                lo = glm::min(lo, vertex);
+                hi = glm::max(hi, vertex);
+                buffer.push_back(vertex);
+                if (buffer.size() == buffer.capacity()) {
+                    vertices.write(reinterpret_cast<const char*>(buffer.data()),
+                                   static_cast<std::streamsize>(buffer.size() * sizeof(glm::vec3)));
+                    buffer.clear();
+                }
+                result.vertices++;
+            } else if (type == "f") {
+                // Indices may refer to vertices further on, so faces are checked by the second pass
+                result.triangles += io::CountObjTriangles(rest);
+            }
+            return true;
+        });
+        vertices.write(reinterpret_cast<const char*>(buffer.data()),
+                       static_cast<std::streamsize>(buffer.size() * sizeof(glm::vec3)));
+        if (!parsed || !vertices) {
+            return false;
+        }
+    }
+
+    io::XYZWriter writer(output);
+    if (!writer.is_open()) {
+        return false;
+    }
+    if (result.triangles == 0) {
+        return writer.Close();
+    }
+
+    Grid grid;
+    grid.lower          = lo;
+    grid.size           = voxel::GridSize({lo, hi}, options.voxelize.block_size);
+    grid.inv_block_size = 1.0f / options.voxelize.block_size;
+
+    // Enough slabs for an even model to fit the budget slab by slab; uneven ones are split later
+    const std::size_t budget  = std::max<std::size_t>(1, options.memory_budget);
+    const std::size_t wanted  = result.triangles * kTriangleCost / budget + 1;
+    const int layers_per_slab = static_cast<int>((static_cast<std::size_t>(grid.size.y) + wanted - 1) / wanted);
+    const int slab_count      = (grid.size.y + layers_per_slab - 1) / layers_per_slab;
+    std::vector<std::filesystem::path> slab_paths;
+    for (int slab = 0; slab < slab_count; slab++) {
+        slab_paths.push_back(scratch.File("slab" + std::to_string(slab) + ".bin"));
+    }
+
+    // Pass 2: bin every triangle into the slabs its layers touch
+    {
+        io::MappedFile vertices(vertex_path, io::MappedFile::Access::kRandom);
+        if (!vertices.is_open()) {
+            return false;
+        }
+        auto vertex = [&](std::uint32_t index) {
+            glm::vec3 position;
+            std::memcpy(&position, vertices.data() + static_cast<std::size_t>(index) * sizeof(glm::vec3),
+                        sizeof(glm::vec3));
+            return position;
+        };
+        SlabWriter slabs(slab_paths, options.memory_budget / 4 / static_cast<std::size_t>(slab_count));
+        // Only positions matter here; vt and vn references are skipped as io::ReadObj skips them for the
+        // in-memory voxelizer
+        const io::ObjRecordCounts total = {result.vertices, 0, 0};
+        io::ObjRecordCounts seen;
+        std::vector<glm::uvec3> polygon;
+        bool binned = ForEachRecord(file, model, [&](std::string_view type, std::string_view rest) {
+            if (type == "v") {
+                seen.positions++;
+            } else if (type == "f") {
+                if (!io::ParseObjFace(rest, seen, total, false, polygon)) {
+                    return false;
+                }
+                for (std::size_t i = 2; i < polygon.size(); i++) {
+                    SlabTriangle triangle = {{vertex(polygon[0].x), vertex(polygon[i - 1].x), vertex(polygon[i].x)}};
+                    auto [first, last]    = grid.Layers(triangle);
+                    for (int slab = first / layers_per_slab; slab <= last / layers_per_slab; slab++) {
+                        slabs.Append(static_cast<std::size_t>(slab), triangle);
+                    }
+                }
+            }
+            return true;
+        });
+        if (!binned || !slabs.Finish()) {
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::remove(vertex_path, error);
+
+    SlabVoxelizer voxelizer(grid, options, scratch, writer, result);
+    for (int slab = 0; slab < slab_count; slab++) {
+        int first = slab * layers_per_slab;
+        int last  = std::min(first + layers_per_slab, grid.size.y) - 1;
+        if (!voxelizer.Run(slab_paths[static_cast<std::size_t>(slab)], first, last)) {
+            return false;
+        }
+    }
+    return writer.Close();
+}
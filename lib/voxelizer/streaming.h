@@ -0,0 +1,41 @@
+#ifndef VOXELIZER_STREAMING
+#define VOXELIZER_STREAMING
+
+#include <cstddef>
+#include <filesystem>
+
+#include "voxelizer.h"
+
+namespace voxel {
+
+struct StreamingOptions {
+    VoxelizeOptions voxelize;
+    // Working memory the voxelizer may use in bytes: slab write buffers and the slab being voxelized.
+    // Memory mapped pages of the input are not counted, they are dropped as soon as a batch is done.
+    std::size_t memory_budget = std::size_t(512) << 20;
+    // Directory for the temporary vertex and slab files; a directory next to the output when empty. They go
+    // into a new output.slabs subdirectory (numbered if that name is taken), removed when the run ends.
+    std::filesystem::path scratch;
+};
+
+struct StreamingStats {
+    std::size_t vertices  = 0;
+    std::size_t triangles = 0;
+    // Slabs voxelized, after splitting the ones over budget
+    std::size_t slabs = 0;
+    // Triangles of the largest slab voxelized at once
+    std::size_t largest_slab = 0;
+    std::size_t blocks       = 0;
+};
+
+// Voxelizes a Wavefront .obj that may not fit in memory into a .XYZ block list. The model is read twice from
+// a memory mapping in bounded batches: the first pass spills vertices to a scratch file and measures the
+// bounds, the second bins triangles into slabs of grid layers (Y) stored on disk. Slabs are then voxelized
+// one by one, split in half while they exceed the budget, and their blocks are appended to the output.
+// The blocks are the same as those of LoadObj + Voxelize, ordered by slab.
+bool VoxelizeObjStreaming(const std::filesystem::path& model, const std::filesystem::path& output,
+                          const StreamingOptions& options, StreamingStats* stats = nullptr);
+
+}  // namespace voxel
+
+#endif
@@ -0,0 +1,52 @@
+#include "triangle_box.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Projects the triangle and the box onto `axis` and checks whether the intervals are disjoint.
+// Triangle vertices are already relative to the box center.
+bool Separated(const glm::vec3& axis, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2,
+               const glm::vec3& half) {
+    float p0     = glm::dot(axis, v0);
+    float p1     = glm::dot(axis, v1);
+    float p2     = glm::dot(axis, v2);
+    float radius = half.x * std::fabs(axis.x) + half.y * std::fabs(axis.y) + half.z * std::fabs(axis.z);
+    return std::min({p0, p1, p2}) > radius || std::max({p0, p1, p2}) < -radius;
+}
+
+}  // namespace
+
+bool voxel::TriangleBoxOverlap(const glm::vec3& box_center, const glm::vec3& box_half, const glm::vec3& a,
+                               const glm::vec3& b, const glm::vec3& c) {
+    glm::vec3 v0 = a - box_center;
+    glm::vec3 v1 = b - box_center;
+    glm::vec3 v2 = c - box_center;
+
+    // Box face normals: plain bounds check
+    for (int axis = 0; axis < 3; axis++) {
+        if (std::min({v0[axis], v1[axis], v2[axis]}) > box_half[axis] ||
+            std::max({v0[axis], v1[axis], v2[axis]}) < -box_half[axis]) {
+            return false;
+        }
+    }
+
+    glm::vec3 edges[3] = {v1 - v0, v2 - v1, v0 - v2};
+
+    // Triangle plane
+    glm::vec3 normal = glm::cross(edges[0], edges[1]);
+    if (Separated(normal, v0, v1, v2, box_half)) {
+        return false;
+    }
+
+    // Cross products of the box axes with the triangle edges
+    for (const glm::vec3& edge : edges) {
+        if (Separated(glm::vec3(0, -edge.z, edge.y), v0, v1, v2, box_half) ||
+            Separated(glm::vec3(edge.z, 0, -edge.x), v0, v1, v2, box_half) ||
+            Separated(glm::vec3(-edge.y, edge.x, 0), v0, v1, v2, box_half)) {
+            return false;
+        }
+    }
+    return true;
+}
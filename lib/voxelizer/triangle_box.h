@@ -0,0 +1,15 @@
+#ifndef VOXELIZER_TRIANGLE_BOX
+#define VOXELIZER_TRIANGLE_BOX
+
+#include <glm/glm.hpp>
+
+namespace voxel {
+
+// Exact triangle / axis-aligned box overlap test (separating axis theorem, Akenine-Moller).
+// The box is given by its center and half size along every axis.
+bool TriangleBoxOverlap(const glm::vec3& box_center, const glm::vec3& box_half, const glm::vec3& a,
+                        const glm::vec3& b, const glm::vec3& c);
+
+}  // namespace voxel
+
+#endif
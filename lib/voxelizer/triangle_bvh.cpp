@@ -0,0 +1,324 @@
+#include "triangle_bvh.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "util/parallel.h"
+
+namespace {
+
+using Node = voxel::TriangleBvh::Node;
+
+constexpr int kBins = voxel::TriangleBvh::kBins;
+// Nodes with more triangles are split by the shared loop, fewer make a subtree built by a single thread
+constexpr std::uint32_t kSubtreeSize = 1 << 12;
+// Triangles binned by one thread when the binning of a node is spread over threads
+constexpr std::uint32_t kBinGrain = 1 << 14;
+
+struct Bounds {
+    glm::vec3 lo{std::numeric_limits<float>::max()};
+    glm::vec3 hi{std::numeric_limits<float>::lowest()};
+
+    void Grow(const glm::vec3& point) {
+        lo = glm::min(lo, point);
+        hi = glm::max(hi, point);
+    }
+    void Grow(const Bounds& other) {
+        lo = glm::min(lo, other.lo);
+        hi = glm::max(hi, other.hi);
+    }
+    // Half the surface area, the scale does not matter to the heuristic
+    float Area() const {
+        const glm::vec3 extent = glm::max(hi - lo, glm::vec3(0));
+        return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+    }
+};
+
+// Triangles [first, first + count) of the order array, to be made the node at index node
+struct Range {
+    std::uint32_t node;
+    std::uint32_t first;
+    std::uint32_t count;
+    std::uint32_t depth;
+};
+
+// Node bounds, centroid bounds and centroid bins along the three axes of a run of triangles
+struct Binning {
+    Bounds box;
+    Bounds centers;
+    Bounds bins[3][kBins];
+    std::uint32_t counts[3][kBins] = {};
+
+    void Merge(const Binning& other) {
+        box.Grow(other.box);
+        centers.Grow(other.centers);
+        for (int axis = 0; axis < 3; axis++) {
+            for (int bin = 0; bin < kBins; bin++) {
+                bins[axis][bin].Grow(other.bins[axis][bin]);
+                counts[axis][bin] += other.counts[axis][bin];
+            }
+        }
+    }
+};
+
+class Builder {
+public:
+    Builder(const std::vector<Bounds>& boxes, const std::vector<glm::vec3>& centers, std::vector<std::uint32_t>& order)
+        : boxes_(boxes)
+        , centers_(centers)
+        , order_(order) {}
+
+    // Splits range and its descendants into nodes. With a subtree size, ranges at or below it are not split but
+    // left in deferred. threads > 1 spreads the binning of large ranges. Returns the depth of the deepest leaf.
+    std::uint32_t Split(std::vector<Node>& nodes, const Range& range, unsigned threads, std::uint32_t subtree_size,
+                        std::vector<Range>* deferred) const {
+        std::uint32_t depth      = 0;
+        std::vector<Range> stack = {range};
+        while (!stack.empty()) {
+            const Range current = stack.back();
+            stack.pop_back();
+            if (deferred != nullptr && current.count <= subtree_size) {
+                deferred->push_back(current);
+                continue;
+            }
+            depth = std::max(depth, current.depth);
+            // Centroid bounds first: the bins divide them
+            Binning binning;
+            Bin(current, threads, binning, [&](std::uint32_t begin, std::uint32_t end, Binning& part) {
+                for (std::uint32_t i = begin; i < end; i++) {
+                    part.centers.Grow(centers_[order_[i]]);
+                }
+            });
+            const Bounds centers   = binning.centers;
+            const glm::vec3 extent = centers.hi - centers.lo;
+            const glm::vec3 scale(extent.x > 0 ? kBins / extent.x : 0, extent.y > 0 ? kBins / extent.y : 0,
+                                  extent.z > 0 ? kBins / extent.z : 0);
+            auto bin_of = [&](std::uint32_t triangle, int axis) {
+                const float position = (centers_[triangle][axis] - centers.lo[axis]) * scale[axis];
+                return std::min(static_cast<int>(position), kBins - 1);
+            };
+            binning = Binning();
+            Bin(current, threads, binning, [&](std::uint32_t begin, std::uint32_t end, Binning& part) {
+                for (std::uint32_t i = begin; i < end; i++) {
+                    const std::uint32_t triangle = order_[i];
+                    part.box.Grow(boxes_[triangle]);
+                    for (int axis = 0; axis < 3; axis++) {
+                        const int bin = bin_of(triangle, axis);
+                        part.bins[axis][bin].Grow(boxes_[triangle]);
+                        part.counts[axis][bin]++;
+                    }
+                }
+            });
+
+            Node& node = nodes[current.node];
+            node.lo    = binning.box.lo;
+            node.hi    = binning.box.hi;
+
+            // Cheapest split between two bins: triangles times area on both sides, swept from both ends
+            int best_axis   = -1;
+            int best_bin    = 0;
+            float best_cost = std::numeric_limits<float>::max();
+            for (int axis = 0; axis < 3; axis++) {
+                if (scale[axis] == 0) {
+                    continue;
+                }
+                float right_cost[kBins];
+                Bounds right;
+                std::uint32_t right_count = 0;
+                for (int bin = kBins - 1; bin > 0; bin--) {
+                    right.Grow(binning.bins[axis][bin]);
+                    right_count += binning.counts[axis][bin];
+                    right_cost[bin] = right_count == 0 ? -1 : right.Area() * static_cast<float>(right_count);
+                }
+                Bounds left;
+                std::uint32_t left_count = 0;
+                for (int bin = 0; bin + 1 < kBins; bin++) {
+                    left.Grow(binning.bins[axis][bin]);
+                    left_count += binning.counts[axis][bin];
+                    if (left_count == 0 || right_cost[bin + 1] < 0) {
+                        continue;
+                    }
+                    const float cost = left.Area() * static_cast<float>(left_count) + right_cost[bin + 1];
+                    if (cost < best_cost) {
+                        best_cost = cost;
+                        best_axis = axis;
+                        best_bin  = bin;
+                    }
+                }
+            }
+
+            // A leaf costs one intersection per triangle, a split one traversal step more than its children
+            const float area     = binning.box.Area();
+            const bool large     = current.count > voxel::TriangleBvh::kLeafSize;
+            std::uint32_t middle = current.first;
+            if (best_axis >= 0 && (large || best_cost + area < area * static_cast<float>(current.count))) {
+                auto begin = order_.begin() + current.first;
+                auto split = std::partition(begin, begin + current.count, [&](std::uint32_t triangle) {
+                    return bin_of(triangle, best_axis) <= best_bin;
+                });
+                middle     = static_cast<std::uint32_t>(split - order_.begin());
+            } else if (large) {
+                // Every centroid in one point: halve the run so that leaves stay small
+                middle = current.first + current.count / 2;
+            }
+            if (middle == current.first) {
+                node.first = current.first;
+                node.count = current.count;
+                continue;
+            }
+
+            const auto left = static_cast<std::uint32_t>(nodes.size());
+            nodes.emplace_back();
+            nodes.emplace_back();
+            nodes[current.node].first = left;
+            nodes[current.node].count = 0;
+            stack.push_back({left + 1, middle, current.first + current.count - middle, current.depth + 1});
+            stack.push_back({left, current.first, middle - current.first, current.depth + 1});
+        }
+        return depth;
+    }
+
+private:
+    // Runs body over the range in parts and merges the parts in order
+    template <typename Body>
+    void Bin(const Range& range, unsigned threads, Binning& result, const Body& body) const {
+        const std::size_t parts =
+            threads > 1 ? std::min<std::size_t>(threads, (range.count + kBinGrain - 1) / kBinGrain) : 1;
+        if (parts <= 1) {
+            body(range.first, range.first + range.count, result);
+            return;
+        }
+        std::vector<Binning> partial(parts);
+        util::ParallelTasks(
+            parts,
+            [&](std::size_t part, unsigned) {
+                const auto begin = static_cast<std::uint32_t>(range.first + range.count * part / parts);
+                const auto end   = static_cast<std::uint32_t>(range.first + range.count * (part + 1) / parts);
+                body(begin, end, partial[part]);
+            },
+            threads);
+        for (const Binning& part : partial) {
+            result.Merge(part);
+        }
+    }
+
+    const std::vector<Bounds>& boxes_;
+    const std::vector<glm::vec3>& centers_;
+    std::vector<std::uint32_t>& order_;
+};
+
+}  // namespace
+
+void voxel::TriangleBvh::Build(const Mesh& mesh, unsigned threads) {
+    nodes_.clear();
+    order_.clear();
+    depth_ = 0;
+    const std::size_t count = mesh.triangles.size();
+    if (count == 0) {
+        return;
+    }
+    threads = threads == 0 ? util::HardwareThreads() : threads;
+
+    std::vector<Bounds> boxes(count);
+    std::vector<glm::vec3> centers(count);
+    order_.resize(count);
+    util::ParallelFor(
+        0, count,
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                const glm::uvec3& triangle = mesh.triangles[i];
+                Bounds& box                = boxes[i];
+                box.Grow(mesh.vertices[triangle.x]);
+                box.Grow(mesh.vertices[triangle.y]);
+                box.Grow(mesh.vertices[triangle.z]);
+                centers[i] = (box.lo + box.hi) * 0.5f;
+                order_[i]  = static_cast<std::uint32_t>(i);
+            }
+        },
+        threads, 1 << 14);
+
+    // The top of the tree, then the subtrees below it on all threads
+    const Builder builder(boxes, centers, order_);
+    std::vector<Range> subtrees;
+    nodes_.reserve(2 * count / kLeafSize + 1);
+    nodes_.emplace_back();
+    std::uint32_t depth = builder.Split(nodes_, {0, 0, static_cast<std::uint32_t>(count), 1}, threads,
+                                        kSubtreeSize, &subtrees);
+
+    std::vector<std::vector<Node>> subtree_nodes(subtrees.size());
+    std::vector<std::uint32_t> subtree_depths(subtrees.size());
+    util::ParallelTasks(
+        subtrees.size(),
+        [&](std::size_t index, unsigned) {
+            Range range = subtrees[index];
+            range.node  = 0;
+            subtree_nodes[index].emplace_back();
+            subtree_depths[index] = builder.Split(subtree_nodes[index], range, 1, 0, nullptr);
+        },
+        threads);
+
+    // Subtree node i > 0 moves to base + i - 1, its root replaces the node left for it
+    for (std::size_t index = 0; index < subtrees.size(); index++) {
+        std::vector<Node>& local = subtree_nodes[index];
+        const auto base          = static_cast<std::uint32_t>(nodes_.size());
+        for (Node& node : local) {
+            if (node.count == 0) {
+                node.first = base + node.first - 1;
+            }
+        }
+        nodes_[subtrees[index].node] = local.front();
+        nodes_.insert(nodes_.end(), local.begin() + 1, local.end());
+        depth = std::max(depth, subtree_depths[index]);
+    }
+    depth_ = depth;
+}
+
+bool voxel::TriangleBvh::Assign(std::vector<Node> nodes, std::vector<std::uint32_t> order,
+                                std::size_t triangle_count) {
+    nodes_.clear();
+    order_.clear();
+    depth_ = 0;
+    if (order.size() != triangle_count || (nodes.empty() && triangle_count != 0)) {
+        return false;
+    }
+    // Walk the tree: children must lie after their parent and leaves must cover the order array exactly once
+    std::vector<bool> used(triangle_count, false);
+    std::size_t covered = 0;
+    std::size_t depth   = 0;
+    std::vector<std::pair<std::uint32_t, std::size_t>> stack;
+    if (!nodes.empty()) {
+        stack.emplace_back(0, 1);
+    }
+    while (!stack.empty()) {
+        const auto [index, level] = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[index];
+        depth            = std::max(depth, level);
+        if (node.count == 0) {
+            if (node.first <= index || node.first + std::size_t(1) >= nodes.size()) {
+                return false;
+            }
+            stack.emplace_back(node.first, level + 1);
+            stack.emplace_back(node.first + 1, level + 1);
+            continue;
+        }
+        if (node.first + std::size_t(node.count) > triangle_count) {
+            return false;
+        }
+        for (std::uint32_t i = node.first; i < node.first + node.count; i++) {
+            if (order[i] >= triangle_count || used[order[i]]) {
+                return false;
+            }
+            used[order[i]] = true;
+        }
+        covered += node.count;
+    }
+    if (covered != triangle_count) {
+        return false;
+    }
+    nodes_.swap(nodes);
+    order_.swap(order);
+    depth_ = depth;
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef VOXELIZER_TRIANGLE_BVH
+#define VOXELIZER_TRIANGLE_BVH
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "mesh.h"
+
+namespace voxel {
+
+// Bounding volume hierarchy over the triangles of a voxel::Mesh, in mesh space so that one tree serves every
+// block size. Splits minimize the surface area heuristic over kBins centroid bins per axis. The nodes of the
+// top levels are split one after another with their binning spread over the threads, smaller subtrees are
+// built on a thread each and spliced in; the tree does not depend on the thread count.
+class TriangleBvh {
+public:
+    static constexpr int kBins               = 16;
+    static constexpr std::uint32_t kLeafSize = 8;
+
+    // 32 bytes, two nodes to a cache line. Both children of a node are stored next to each other.
+    struct Node {
+        glm::vec3 lo{0};
+        // Leaves: first triangle in order(); inner nodes: index of the first child, the second one follows it
+        std::uint32_t first = 0;
+        glm::vec3 hi{0};
+        // Triangles under a leaf, 0 for inner nodes
+        std::uint32_t count = 0;
+    };
+    static_assert(sizeof(Node) == 32, "Nodes are written to mesh caches as they are");
+
+    TriangleBvh() = default;
+    explicit TriangleBvh(const Mesh& mesh, unsigned threads = 0) { Build(mesh, threads); }
+
+    void Build(const Mesh& mesh, unsigned threads = 0);
+    // Takes a tree read back from a mesh cache. False, leaving the tree empty, when the nodes do not form a
+    // tree over exactly triangle_count triangles.
+    bool Assign(std::vector<Node> nodes, std::vector<std::uint32_t> order, std::size_t triangle_count);
+
+    bool empty() const { return nodes_.empty(); }
+    const std::vector<Node>& nodes() const { return nodes_; }
+    // Triangle indices grouped by leaf
+    const std::vector<std::uint32_t>& order() const { return order_; }
+    // Nodes on the longest path from the root to a leaf
+    std::size_t depth() const { return depth_; }
+
+    // Calls visit(triangle) for the triangles of every leaf whose bounds overlap the box [lo, hi], a superset of
+    // the triangles that overlap it, in no particular order
+    template <typename Visit>
+    void ForEachOverlap(const glm::vec3& lo, const glm::vec3& hi, Visit&& visit) const {
+        if (nodes_.empty()) {
+            return;
+        }
+        std::vector<std::uint32_t> stack;
+        stack.reserve(depth_ + 1);
+        stack.push_back(0);
+        while (!stack.empty()) {
+            const Node& node = nodes_[stack.back()];
+            stack.pop_back();
+            if (glm::any(glm::lessThan(node.hi, lo)) || glm::any(glm::greaterThan(node.lo, hi))) {
+                continue;
+            }
+            if (node.count == 0) {
+                stack.push_back(node.first + 1);
+                stack.push_back(node.first);
+                continue;
+            }
+            for (std::uint32_t i = node.first; i < node.first + node.count; i++) {
+                visit(order_[i]);
+            }
+        }
+    }
+
+private:
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> order_;
+    std::size_t depth_ = 0;
+};
+
+}  // namespace voxel
+
+#endif
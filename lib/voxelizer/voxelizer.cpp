@@ -0,0 +1,360 @@
+#include "voxelizer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "solid_fill.h"
+#include "triangle_box.h"
+#include "util/parallel.h"
+
+namespace {
+
+// Cells the BVH query around a tile reaches past it, far more than vertices move by rounding
+constexpr float kQueryMargin = 0.25f;
+
+// Barycentric weights of the point of triangle (a, b, c) closest to p (Ericson, Real-Time Collision Detection 5.1.5)
+glm::vec3 ClosestBarycentric(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+    glm::vec3 ap = p - a;
+    float d1     = glm::dot(ab, ap);
+    float d2     = glm::dot(ac, ap);
+    if (d1 <= 0 && d2 <= 0) {
+        return {1, 0, 0};
+    }
+    glm::vec3 bp = p - b;
+    float d3     = glm::dot(ab, bp);
+    float d4     = glm::dot(ac, bp);
+    if (d3 >= 0 && d4 <= d3) {
+        return {0, 1, 0};
+    }
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+        float v = d1 / (d1 - d3);
+        return {1 - v, v, 0};
+    }
+    glm::vec3 cp = p - c;
+    float d5     = glm::dot(ab, cp);
+    float d6     = glm::dot(ac, cp);
+    if (d6 >= 0 && d5 <= d6) {
+        return {0, 0, 1};
+    }
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+        float w = d2 / (d2 - d6);
+        return {1 - w, 0, w};
+    }
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return {0, 1 - w, w};
+    }
+    float denominator = va + vb + vc;
+    if (denominator <= 0) {
+        // Degenerate triangle
+        return glm::vec3(1.0f / 3);
+    }
+    float v = vb / denominator;
+    float w = vc / denominator;
+    return {1 - v - w, v, w};
+}
+
+}  // namespace
+
+glm::ivec3 voxel::GridSize(const std::pair<glm::vec3, glm::vec3>& bounds, float block_size) {
+    return glm::max(glm::ivec3(1), glm::ivec3(glm::ceil((bounds.second - bounds.first) * (1.0f / block_size))));
+}
+
+std::vector<glm::ivec3> voxel::Voxelize(const Mesh& mesh, const VoxelizeOptions& options,
+                                        std::vector<std::uint16_t>* colors) {
+    if (colors != nullptr) {
+        colors->clear();
+    }
+    if (mesh.triangles.empty() || options.block_size <= 0) {
+        return {};
+    }
+    const std::pair<glm::vec3, glm::vec3> bounds = mesh.Bounds();
+    const glm::ivec3 size                        = GridSize(bounds, options.block_size);
+    return VoxelizeRegion(mesh, bounds.first, size, glm::ivec3(0), size - 1, options, colors);
+}
+
+std::vector<glm::ivec3> voxel::VoxelizeRegion(const Mesh& mesh, const glm::vec3& lower, const glm::ivec3& grid_size,
+                                              const glm::ivec3& region_lo, const glm::ivec3& region_hi,
+                                              const VoxelizeOptions& options, std::vector<std::uint16_t>* colors) {
+    if (colors != nullptr) {
+        colors->clear();
+    }
+    if (mesh.triangles.empty() || options.block_size <= 0 || options.tile_size <= 0 ||
+        glm::any(glm::lessThan(region_hi, region_lo))) {
+        return {};
+    }
+    unsigned threads = options.threads == 0 ? util::HardwareThreads() : options.threads;
+    const bool color = colors != nullptr && options.palette != nullptr && !options.palette->empty() &&
+                       mesh.HasColors();
+
+    // Move the mesh into grid space, where every cell is a unit box
+    const float inv_block_size = 1.0f / options.block_size;
+    const glm::ivec3 dims      = region_hi - region_lo + 1;
+    std::vector<glm::vec3> points(mesh.vertices.size());
+    util::ParallelFor(
+        0, points.size(),
+        [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                points[i] = (mesh.vertices[i] - lower) * inv_block_size;
+            }
+        },
+        threads, 1 << 14);
+
+    const int tile              = options.tile_size;
+    const glm::ivec3 tiles      = (dims + tile - 1) / tile;
+    const std::size_t tile_count = static_cast<std::size_t>(tiles.x) * tiles.y * tiles.z;
+
+    // Cells of the triangle bounds inside the region, relative to region_lo; empty (lo > hi) when it misses
+    auto cell_range = [&](const glm::uvec3& triangle) {
+        glm::vec3 lo = glm::min(glm::min(points[triangle.x], points[triangle.y]), points[triangle.z]);
+        glm::vec3 hi = glm::max(glm::max(points[triangle.x], points[triangle.y]), points[triangle.z]);
+        // Points on the upper grid bound belong to the last cell
+        glm::ivec3 first = glm::clamp(glm::ivec3(glm::floor(lo)), glm::ivec3(0), grid_size - 1) - region_lo;
+        glm::ivec3 last  = glm::clamp(glm::ivec3(glm::floor(hi)), glm::ivec3(0), grid_size - 1) - region_lo;
+        if (glm::any(glm::lessThan(last, glm::ivec3(0))) || glm::any(glm::greaterThan(first, dims - 1))) {
+            return std::make_pair(glm::ivec3(1), glm::ivec3(0));
+        }
+        return std::make_pair(glm::max(first, glm::ivec3(0)), glm::min(last, dims - 1));
+    };
+
+    // Mesh color where the triangle comes closest to a point in grid space: interpolated vertex colors, or
+    // else the triangle material
+    auto sample_color = [&](std::uint32_t triangle_index, const glm::vec3& point) -> glm::vec3 {
+        if (mesh.vertex_colors.empty()) {
+            return mesh.triangle_colors[triangle_index];
+        }
+        const glm::uvec3& triangle = mesh.triangles[triangle_index];
+        const glm::vec3 weights =
+            ClosestBarycentric(point, points[triangle.x], points[triangle.y], points[triangle.z]);
+        return weights.x * mesh.vertex_colors[triangle.x] + weights.y * mesh.vertex_colors[triangle.y] +
+               weights.z * mesh.vertex_colors[triangle.z];
+    };
+
+    // Bin triangles into every tile their bounds touch. Each worker fills its own bins so binning needs
+    // no locks, and bins are read back in worker order, which keeps the triangle order stable. With a BVH
+    // every tile looks its triangles up instead.
+    const std::size_t triangle_count = mesh.triangles.size();
+    const std::size_t bin_sets       = options.bvh == nullptr ? std::min<std::size_t>(threads, triangle_count) : 0;
+    std::vector<std::vector<std::vector<std::uint32_t>>> bins(bin_sets);
+    util::ParallelTasks(
+        bin_sets,
+        [&](std::size_t set, unsigned) {
+            bins[set].resize(tile_count);
+            std::size_t begin = triangle_count * set / bin_sets;
+            std::size_t end   = triangle_count * (set + 1) / bin_sets;
+            for (std::size_t i = begin; i < end; i++) {
+                auto [lo, hi] = cell_range(mesh.triangles[i]);
+                if (glm::any(glm::lessThan(hi, lo))) {
+                    continue;
+                }
+                glm::ivec3 tile_lo = lo / tile;
+                glm::ivec3 tile_hi = hi / tile;
+                for (int z = tile_lo.z; z <= tile_hi.z; z++) {
+                    for (int y = tile_lo.y; y <= tile_hi.y; y++) {
+                        for (int x = tile_lo.x; x <= tile_hi.x; x++) {
+                            bins[set][(static_cast<std::size_t>(z) * tiles.y + y) * tiles.x + x].push_back(
+                                static_cast<std::uint32_t>(i));
+                        }
+                    }
+                }
+            }
+        },
+        threads);
+
+    // Solid fills cast rays along x through every column of the region, and along y and z as well when some x
+    // ray enters the mesh without leaving it
+    std::vector<ColumnCrossings> crossings;
+    if (options.solid) {
+        crossings.emplace_back(points, mesh.triangles, 0, glm::ivec2(region_lo.y, region_lo.z),
+                               glm::ivec2(region_hi.y, region_hi.z), threads, options.bvh, lower, options.block_size);
+        if (crossings[0].odd_columns() > 0) {
+            crossings.emplace_back(points, mesh.triangles, 1, glm::ivec2(region_lo.x, region_lo.z),
+                                   glm::ivec2(region_hi.x, region_hi.z), threads, options.bvh, lower,
+                                   options.block_size);
+            crossings.emplace_back(points, mesh.triangles, 2, glm::ivec2(region_lo.x, region_lo.y),
+                                   glm::ivec2(region_hi.x, region_hi.y), threads, options.bvh, lower,
+                                   options.block_size);
+        }
+    }
+
+    // Voxelize tile by tile into a local bit mask, so no cell is tested twice and no cell is emitted twice
+    std::vector<std::vector<glm::ivec3>> tile_cells(tile_count);
+    std::vector<std::vector<std::uint16_t>> tile_colors(color ? tile_count : 0);
+    util::ParallelTasks(
+        tile_count,
+        [&](std::size_t index, unsigned) {
+            const glm::ivec3 tile_origin(static_cast<int>(index % tiles.x) * tile,
+                                         static_cast<int>(index / tiles.x % tiles.y) * tile,
+                                         static_cast<int>(index / tiles.x / tiles.y) * tile);
+            const glm::ivec3 tile_last = glm::min(tile_origin + tile, dims) - 1;
+            const glm::ivec3 extent    = tile_last - tile_origin + 1;
+            const std::size_t volume = static_cast<std::size_t>(extent.x) * extent.y * extent.z;
+            std::vector<std::uint64_t> mask((volume + 63) / 64);
+            // First triangle through every cell, only kept when coloring
+            std::vector<std::uint32_t> owner(color ? volume : 0);
+            bool any = false;
+
+            auto add_triangle = [&](std::uint32_t triangle_index) {
+                const glm::uvec3& triangle = mesh.triangles[triangle_index];
+                auto [lo, hi]              = cell_range(triangle);
+                lo                         = glm::max(lo, tile_origin);
+                hi                         = glm::min(hi, tile_last);
+                for (int z = lo.z; z <= hi.z; z++) {
+                    for (int y = lo.y; y <= hi.y; y++) {
+                        for (int x = lo.x; x <= hi.x; x++) {
+                            glm::ivec3 local = glm::ivec3(x, y, z) - tile_origin;
+                            std::size_t bit =
+                                (static_cast<std::size_t>(local.z) * extent.y + local.y) * extent.x + local.x;
+                            if ((mask[bit / 64] >> (bit % 64) & 1) != 0) {
+                                continue;
+                            }
+                            glm::vec3 center = glm::vec3(region_lo + glm::ivec3(x, y, z)) + 0.5f;
+                            if (TriangleBoxOverlap(center, glm::vec3(0.5f), points[triangle.x], points[triangle.y],
+                                                   points[triangle.z])) {
+                                mask[bit / 64] |= std::uint64_t(1) << (bit % 64);
+                                any = true;
+                                if (color) {
+                                    owner[bit] = triangle_index;
+                                }
+                            }
+                        }
+                    }
+                }
+            };
+            for (const std::vector<std::vector<std::uint32_t>>& set : bins) {
+                for (std::uint32_t triangle_index : set[index]) {
+                    add_triangle(triangle_index);
+                }
+            }
+            if (options.bvh != nullptr) {
+                // Triangles reaching the tile. Triangles beyond the grid are clamped into its border cells, so at
+                // the border the query box has no bound. Colors come from the first triangle through a cell, so
+                // then they are taken in index order like the bins.
+                const glm::ivec3 first = region_lo + tile_origin;
+                const glm::ivec3 last  = region_lo + tile_last;
+                glm::vec3 box_lo       = lower + (glm::vec3(first) - kQueryMargin) * options.block_size;
+                glm::vec3 box_hi       = lower + (glm::vec3(last + 1) + kQueryMargin) * options.block_size;
+                for (int axis = 0; axis < 3; axis++) {
+                    if (first[axis] <= 0) {
+                        box_lo[axis] = std::numeric_limits<float>::lowest();
+                    }
+                    if (last[axis] >= grid_size[axis] - 1) {
+                        box_hi[axis] = std::numeric_limits<float>::max();
+                    }
+                }
+                std::vector<std::uint32_t> found;
+                options.bvh->ForEachOverlap(box_lo, box_hi,
+                                            [&](std::uint32_t triangle) { found.push_back(triangle); });
+                if (color) {
+                    std::sort(found.begin(), found.end());
+                }
+                for (std::uint32_t triangle_index : found) {
+                    add_triangle(triangle_index);
+                }
+            }
+            if (!crossings.empty()) {
+                // Axes whose rays put every cell center inside, axes that abstain, and the triangle the first inside
+                // vote entered through. When voting, a ray that crosses the surface an odd number of times passed
+                // through a hole and abstains.
+                std::vector<std::uint8_t> votes(volume, 0);
+                std::vector<std::uint8_t> abstained(crossings.size() > 1 ? volume : 0, 0);
+                std::vector<std::uint32_t> entry(color ? volume : 0);
+                for (const ColumnCrossings& axis_crossings : crossings) {
+                    const int axis   = axis_crossings.axis();
+                    const int u_axis = axis == 0 ? 1 : 0;
+                    const int v_axis = axis == 2 ? 1 : 2;
+                    for (int v = tile_origin[v_axis]; v <= tile_last[v_axis]; v++) {
+                        for (int u = tile_origin[u_axis]; u <= tile_last[u_axis]; u++) {
+                            std::span<const Crossing> column =
+                                axis_crossings.Column(region_lo[u_axis] + u, region_lo[v_axis] + v);
+                            const bool abstain = !abstained.empty() && column.size() % 2 == 1;
+                            // Walk the column from the crossings in front of the tile
+                            auto crossed = std::lower_bound(
+                                column.begin(), column.end(),
+                                static_cast<float>(region_lo[axis] + tile_origin[axis]) + 0.5f,
+                                [](const Crossing& crossing, float depth) { return crossing.depth < depth; });
+                            std::size_t k = static_cast<std::size_t>(crossed - column.begin());
+                            glm::ivec3 local;
+                            local[u_axis] = u - tile_origin[u_axis];
+                            local[v_axis] = v - tile_origin[v_axis];
+                            for (int t = tile_origin[axis]; t <= tile_last[axis]; t++) {
+                                const float center = static_cast<float>(region_lo[axis] + t) + 0.5f;
+                                while (k < column.size() && column[k].depth < center) {
+                                    k++;
+                                }
+                                if ((k & 1) == 0 && !abstain) {
+                                    continue;
+                                }
+                                local[axis] = t - tile_origin[axis];
+                                std::size_t bit =
+                                    (static_cast<std::size_t>(local.z) * extent.y + local.y) * extent.x + local.x;
+                                if (abstain) {
+                                    abstained[bit]++;
+                                } else if (votes[bit]++ == 0 && color) {
+                                    entry[bit] = column[k - 1].triangle;
+                                }
+                            }
+                        }
+                    }
+                }
+                // Filled on a strict majority of the voting axes
+                const int axes = static_cast<int>(crossings.size());
+                for (std::size_t bit = 0; bit < volume; bit++) {
+                    const int voters = abstained.empty() ? axes : axes - abstained[bit];
+                    if (2 * votes[bit] <= voters || (mask[bit / 64] >> (bit % 64) & 1) != 0) {
+                        continue;
+                    }
+                    mask[bit / 64] |= std::uint64_t(1) << (bit % 64);
+                    any = true;
+                    if (color) {
+                        owner[bit] = entry[bit];
+                    }
+                }
+            }
+            if (!any) {
+                return;
+            }
+
+            // Tile cells are relative to region_lo until they are emitted
+            const glm::ivec3 cell_origin   = region_lo + tile_origin;
+            std::vector<glm::ivec3>& cells = tile_cells[index];
+            for (std::size_t word = 0; word < mask.size(); word++) {
+                for (std::uint64_t bits = mask[word]; bits != 0; bits &= bits - 1) {
+                    std::size_t bit = word * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+                    cells.push_back(cell_origin + glm::ivec3(static_cast<int>(bit % extent.x),
+                                                             static_cast<int>(bit / extent.x % extent.y),
+                                                             static_cast<int>(bit / extent.x / extent.y)));
+                    if (color) {
+                        glm::vec3 sample = sample_color(owner[bit], glm::vec3(cells.back()) + 0.5f);
+                        tile_colors[index].push_back(options.palette->Map(sample, cells.back()));
+                    }
+                }
+            }
+        },
+        threads);
+
+    std::size_t total = 0;
+    for (const std::vector<glm::ivec3>& cells : tile_cells) {
+        total += cells.size();
+    }
+    std::vector<glm::ivec3> result;
+    result.reserve(total);
+    for (const std::vector<glm::ivec3>& cells : tile_cells) {
+        result.insert(result.end(), cells.begin(), cells.end());
+    }
+    if (color) {
+        colors->reserve(total);
+        for (const std::vector<std::uint16_t>& cell_colors : tile_colors) {
+            colors->insert(colors->end(), cell_colors.begin(), cell_colors.end());
+        }
+    }
+    return result;
+}
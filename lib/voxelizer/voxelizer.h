@@ -0,0 +1,55 @@
+#ifndef VOXELIZER_VOXELIZER
+#define VOXELIZER_VOXELIZER
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "mesh.h"
+#include "triangle_bvh.h"
+#include "voxel/block_palette.h"
+
+namespace voxel {
+
+struct VoxelizeOptions {
+    // Edge of one block in mesh units
+    float block_size = 1.0f;
+    // Worker threads, 0 means one per hardware thread
+    unsigned threads = 0;
+    // Edge of one spatial tile in blocks; every tile is voxelized by a single thread
+    int tile_size = 32;
+    // Blocks to color cells with; every cell takes the color of the first triangle through it, sampled at the
+    // point closest to the cell center
+    const BlockPalette* palette = nullptr;
+    // Also fill the interior: cells whose center lies behind an odd number of crossings of the ray along x. When
+    // some x ray crosses the surface an odd number of times the mesh is not closed; then rays along all three
+    // axes vote, rays through a hole abstain and a strict majority fills the cell. Interior cells take the color
+    // of the triangle their ray entered through.
+    bool solid = false;
+    // BVH over the triangles of the mesh, e.g. read back with ReadMeshCache. Tiles and solid fill rays then take
+    // their triangles from it instead of binning the whole mesh; the cells and colors stay the same.
+    const TriangleBvh* bvh = nullptr;
+};
+
+// Returns every cell the mesh surface passes through. Cell (i, j, k) covers the box
+// [min + (i, j, k) * block_size, min + (i + 1, j + 1, k + 1) * block_size), where min is the lower
+// corner of the mesh bounds. Cells are grouped by tile and the order does not depend on the thread count.
+// When colors is given and both the mesh and options.palette have colors, it receives the palette index of
+// every cell; otherwise it is left empty.
+std::vector<glm::ivec3> Voxelize(const Mesh& mesh, const VoxelizeOptions& options,
+                                 std::vector<std::uint16_t>* colors = nullptr);
+
+// Cells along every axis of the grid Voxelize uses for a mesh with the given bounds
+glm::ivec3 GridSize(const std::pair<glm::vec3, glm::vec3>& bounds, float block_size);
+
+// Voxelize restricted to the cells [region_lo, region_hi] of a grid of grid_size cells whose cell (0, 0, 0)
+// starts at lower. Voxelizing regions that partition the grid yields exactly the cells of Voxelize, so a
+// mesh can be processed piece by piece with every piece holding only the triangles that touch its region.
+// That does not hold for solid fills, whose rays have to see the whole mesh.
+std::vector<glm::ivec3> VoxelizeRegion(const Mesh& mesh, const glm::vec3& lower, const glm::ivec3& grid_size,
+                                       const glm::ivec3& region_lo, const glm::ivec3& region_hi,
+                                       const VoxelizeOptions& options, std::vector<std::uint16_t>* colors = nullptr);
+
+}  // namespace voxel
+
+#endif
@@ -0,0 +1,28 @@
+#version 330 core
+
+// Input vertex data: one word per vertex, laid out as in lib/voxel/packed_vertex.h
+//   bits 0..17 corner inside the chunk (6 bits per axis), 18..20 face, 21..31 palette index
+layout(location = 0) in uint packedVertex;
+
+// Output data ; will be interpolated for each fragment.
+out vec3 fragmentColor;
+// Values that stay constant for the whole mesh.
+uniform mat4 MVP;
+// World position of the first cell of the chunk being drawn
+uniform vec3 ChunkOrigin;
+// One texel per palette index
+uniform sampler1D Palette;
+
+// Brightness of the faces +X, -X, +Y, -Y, +Z, -Z, the same as the greedy mesher bakes into float colors
+const float faceShade[6] = float[6](0.8, 0.8, 1.0, 0.5, 0.65, 0.65);
+
+void main(){
+
+	// Corners are counted from the low corner of cell 0, while blocks are centered on their cells
+	vec3 corner = vec3(packedVertex & 63u, (packedVertex >> 6) & 63u, (packedVertex >> 12) & 63u);
+	gl_Position =  MVP * vec4(ChunkOrigin + corner - 0.5, 1);
+
+	uint face  = (packedVertex >> 18) & 7u;
+	uint index = packedVertex >> 21;
+	fragmentColor = texelFetch(Palette, int(index), 0).rgb * faceShade[face];
+}
@@ -0,0 +1,53 @@
+// Include standard headers
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+#include "io/blocks.h"
+#include "schematic/layer_plan.h"
+
+// Writes the layer by layer build plan of a .XYZ / .XYZB block list
+int main(int argc, char **argv) {
+    if (argc < 3 || argc > 4) {
+        std::cout <<
+            R"(ERROR: Missing arguments
+usage:
+    layerplan path\to\file.XYZ path\to\plan.txt [path\to\plan.bin])";
+        return -2;
+    }
+
+    std::filesystem::path blocks_input(argv[1]);
+    if (!std::filesystem::exists(blocks_input) || std::filesystem::is_directory(blocks_input) ||
+        !io::IsBlockList(blocks_input)) {
+        std::cout << "ERROR: WRONG FILE PATH " << blocks_input << '\n';
+        return -2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    voxel::VoxelGrid blocks;
+    if (!io::LoadBlocks(blocks_input, blocks)) {
+        return -1;
+    }
+    auto loaded = std::chrono::steady_clock::now();
+
+    std::ofstream text(argv[2], std::ios::binary);
+    std::unique_ptr<std::ofstream> binary;
+    if (argc == 4) {
+        binary = std::make_unique<std::ofstream>(argv[3], std::ios::binary);
+    }
+    if (!text.is_open() || (binary && !binary->is_open())) {
+        std::cout << "ERROR: CAN NOT WRITE THE PLAN\n";
+        return -1;
+    }
+    if (!schematic::WriteLayerPlans(blocks, &text, binary.get())) {
+        return -1;
+    }
+
+    using std::chrono::duration;
+    std::cout << blocks.size() << " blocks\n"
+              << "load: " << duration<double>(loaded - start).count() << " s\n"
+              << "plan: " << duration<double>(std::chrono::steady_clock::now() - loaded).count() << " s\n";
+    return 0;
+}
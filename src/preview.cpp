@@ -0,0 +1,192 @@
+// Include standard headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Include GLEW
+#include "GL/glew.h"
+
+// Include GLM
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "shader.hpp"
+
+#include "figures/mesh_model.h"
+#include "io/blocks.h"
+#include "io/png.h"
+#include "render/offscreen.h"
+#include "voxel/greedy_mesher.h"
+#include "voxel/voxel_grid.h"
+
+static const std::filesystem::path PROJECT_DIR(PROJECT_SOURCE_DIR);
+
+namespace {
+
+constexpr float kFovDegrees = 45;
+
+// Camera looking at the whole grid from the given direction, with near and far planes fitted to it
+glm::mat4 FitCamera(const voxel::VoxelGrid& grid, float azimuth_degrees, float elevation_degrees) {
+    auto [lo, hi]    = grid.Bounds();
+    glm::vec3 center = (glm::vec3(lo) + glm::vec3(hi)) * 0.5f;
+    float radius     = glm::length(glm::vec3(hi - lo) + 1.0f) * 0.5f;
+    float distance   = radius / std::sin(glm::radians(kFovDegrees) / 2) * 1.05f;
+    float azimuth    = glm::radians(azimuth_degrees);
+    float elevation  = glm::radians(elevation_degrees);
+
+    glm::vec3 direction(std::cos(elevation) * std::cos(azimuth), std::sin(elevation),
+                        std::cos(elevation) * std::sin(azimuth));
+    glm::mat4 view = glm::lookAt(center + distance * direction, center, glm::vec3(0, 1, 0));
+    glm::mat4 projection =
+        glm::perspective(glm::radians(kFovDegrees), 1.0f, std::max(0.1f, distance - radius), distance + radius);
+    return projection * view;
+}
+
+}  // namespace
+
+// Renders preview images of .XYZ / .XYZB block lists without a window. Shaders and GL objects are created
+// once for all models, and every image is read back while the next one renders.
+int main(int argc, char **argv) {
+    std::filesystem::path output_dir;
+    std::vector<std::filesystem::path> inputs;
+    int size   = 256;
+    int views  = 4;
+    int layers = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg == "--size" && i + 1 < argc) {
+            size = std::atoi(argv[++i]);
+        } else if (arg == "--views" && i + 1 < argc) {
+            views = std::atoi(argv[++i]);
+        } else if (arg == "--layers" && i + 1 < argc) {
+            layers = std::atoi(argv[++i]);
+        } else if (arg.starts_with("--")) {
+            std::cout << "ERROR: UNKNOWN FLAG " << arg << '\n';
+            return -2;
+        } else if (output_dir.empty()) {
+            output_dir = arg;
+        } else {
+            inputs.emplace_back(arg);
+        }
+    }
+    if (inputs.empty() || size <= 0 || views < 0 || layers < 0) {
+        std::cout <<
+            R"(ERROR: Missing arguments
+usage:
+    preview output\dir path\to\file.XYZ [more .XYZ / .XYZB files] [--size N] [--views N] [--layers N]
+        --size N      width and height of every image, 256 by default
+        --views N     images from N directions around the model, 4 by default
+        --layers N    images of the model built up to N evenly spaced heights, as the layer plan builds it)";
+        return -2;
+    }
+    // Images are named after the input file, extension included, so a.XYZ and a.XYZB do not overwrite each other;
+    // inputs of the same name from different directories would
+    std::vector<std::string> names;
+    for (const std::filesystem::path &input : inputs) {
+        names.push_back(input.filename().string());
+    }
+    std::sort(names.begin(), names.end());
+    if (auto same = std::adjacent_find(names.begin(), names.end()); same != names.end()) {
+        std::cout << "ERROR: TWO INPUTS NAMED " << *same << " WOULD WRITE THE SAME IMAGES\n";
+        return -2;
+    }
+    std::filesystem::create_directories(output_dir);
+
+    auto start = std::chrono::steady_clock::now();
+    render::OffscreenContext context;
+    if (!context.Create()) {
+        std::cout << "ERROR: CAN NOT CREATE AN OPENGL CONTEXT\n";
+        return -1;
+    }
+    GLuint program_id = LoadShaders(PROJECT_DIR / "shaders/vertex shaders/TransformVertexShader.glsl",
+                                    PROJECT_DIR / "shaders/fragment shaders/ColorFragmentShader.glsl");
+    GLuint matrix_id  = glGetUniformLocation(program_id, "MVP");
+
+    std::chrono::duration<double> setup_time = std::chrono::steady_clock::now() - start;
+    std::cout << "context: " << context.backend() << ", set up in " << setup_time.count() * 1000 << " ms\n";
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glClearColor(0.0f, 0.0f, 0.5f, 0.0f);
+
+    render::OffscreenTarget target(size, size);
+    figure::MeshModel mesh;
+    const voxel::MeshOptions mesh_options;
+    // Paths of the images whose readback is in flight, oldest first
+    std::deque<std::filesystem::path> pending;
+    std::vector<std::uint8_t> pixels;
+    std::size_t images = 0;
+    int failures       = 0;
+
+    auto finish_oldest = [&] {
+        if (!target.FinishReadback(pixels) || !io::WritePng(pending.front(), size, size, 3, pixels.data(), true)) {
+            failures++;
+        }
+        pending.pop_front();
+    };
+    auto render_image = [&](const glm::mat4 &mvp, const std::filesystem::path &path) {
+        target.Bind();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glUseProgram(program_id);
+        glUniformMatrix4fv(matrix_id, 1, GL_FALSE, &mvp[0][0]);
+        mesh.Draw();
+        // Free a pixel buffer by finishing the oldest readback, whose image rendered one image ago
+        if (target.pending() == render::OffscreenTarget::kReadbacks) {
+            finish_oldest();
+        }
+        target.StartReadback();
+        pending.push_back(path);
+        images++;
+    };
+
+    for (const std::filesystem::path &input : inputs) {
+        auto model_start = std::chrono::steady_clock::now();
+        voxel::VoxelGrid blocks;
+        if (!io::IsBlockList(input) || !io::LoadBlocks(input, blocks) || blocks.empty()) {
+            std::cout << "ERROR: CAN NOT READ " << input << '\n';
+            failures++;
+            continue;
+        }
+        const std::string name        = input.filename().string();
+        const std::size_t first_image = images;
+
+        // Upload orphans the buffers, so the previous model can still be drawing from them
+        mesh.Upload(voxel::MeshGrid(blocks, mesh_options));
+        for (int view = 0; view < views; view++) {
+            render_image(FitCamera(blocks, 45.0f + 360.0f * view / views, 30.0f),
+                         output_dir / (name + "_view" + std::to_string(view) + ".png"));
+        }
+
+        // Every layer image keeps the camera of the full model, so the model grows in place
+        auto [lo, hi] = blocks.Bounds();
+        glm::mat4 mvp = FitCamera(blocks, 45.0f, 30.0f);
+        for (int layer = 0; layer < layers; layer++) {
+            const int top = lo.y + (hi.y - lo.y + 1) * (layer + 1) / layers - 1;
+            voxel::VoxelGrid built;
+            blocks.ForEach([&](const glm::ivec3 &cell, std::uint16_t color) {
+                if (cell.y <= top) {
+                    built.Set(cell, color);
+                }
+            });
+            mesh.Upload(voxel::MeshGrid(built, mesh_options));
+            render_image(mvp, output_dir / (name + "_layer" + std::to_string(layer) + ".png"));
+        }
+
+        std::chrono::duration<double> model_time = std::chrono::steady_clock::now() - model_start;
+        std::cout << name << ": " << blocks.size() << " blocks, " << images - first_image << " images in "
+                  << model_time.count() * 1000 << " ms\n";
+    }
+    while (!pending.empty()) {
+        finish_oldest();
+    }
+
+    glDeleteProgram(program_id);
+    std::chrono::duration<double> total_time = std::chrono::steady_clock::now() - start;
+    std::cout << images << " images from " << inputs.size() << " models in " << total_time.count() << " s\n";
+    return failures == 0 ? 0 : -1;
+}
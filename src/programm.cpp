@@ -1,8 +1,16 @@
 // Include standard headers
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <deque>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <random>
+#include <shared_mutex>
+#include <string>
 #include <vector>
 
 // Include GLEW
@@ -18,7 +26,30 @@
 #include "shader.hpp"
 
 // figures
+#include "figures/chunk_meshes.h"
 #include "figures/cube.h"
+#include "figures/cube_instances.h"
+#include "figures/mesh_model.h"
+#include "figures/palette_texture.h"
+
+// culling
+#include "render/buffer_arena.h"
+#include "render/chunk_bvh.h"
+#include "render/frustum.h"
+#include "render/gpu_timer.h"
+#include "render/lod_selector.h"
+
+// scene
+#include "io/blocks.h"
+#include "voxel/async_mesher.h"
+#include "voxel/block_editor.h"
+#include "voxel/block_palette.h"
+#include "voxel/raycast.h"
+#include "voxel/lod_octree.h"
+#include "voxel/voxel_grid.h"
+
+// instrumentation
+#include "util/trace.h"
 
 static const std::filesystem::path PROJECT_DIR(PROJECT_SOURCE_DIR);
 
@@ -108,6 +139,8 @@ int main(int argc, char **argv) {
     constexpr int kHeight            = 600;
     constexpr float kCamDegrees      = 45;
     constexpr float kRotationRadians = glm::radians(1.0f);
+    // Blocks past the far plane are not drawn, so they can not be picked either
+    constexpr float kPickDistance = 100;
     // const float kCosRot = std::cos(kRotationRadians);
     // const float kSinRot = std::sin(kRotationRadians);
 
@@ -187,44 +220,192 @@ int main(int argc, char **argv) {
 
     glm::vec3 Axis;
 
-    int cnt;
-    std::vector<figure::Cube> blocks;
+    voxel::VoxelGrid blocks;
 
     if (argc == 1) {
         std::cout <<
             R"(ERROR: Missing .XYZ file
 usage:
-    3D2MC.exe path\to\file.XYZ)";
+    3D2MC.exe path\to\file.XYZ [--mesh | --instanced | --lod] [--no-cull] [--upload-budget KiB] [--trace file]
+              [--palette default|path\to\palette.txt]
+    3D2MC.exe path\to\file.XYZB [--mesh | --instanced | --lod] [--no-cull] [--upload-budget KiB] [--trace file]
+        --mesh               draw face-culled greedy meshes instead of a cube per block, built in the background
+        --instanced          draw all blocks as instances of one cube with a single draw call
+        --lod                draw greedy meshes of an octree of downsampled levels, coarser with distance
+        --no-cull            submit every chunk instead of only the chunks inside the view frustum
+        --upload-budget KiB  most mesh data uploaded per frame with --mesh, 4096 KiB by default
+        --trace file         record stage timings and write them as a Chrome trace to file and per frame to
+                             the same name with a .csv extension
+        --palette            colors of the block palette indices of a colored .XYZ file (written by voxelize
+                             --palette) in --mesh and --lod, from a palette file or the sixteen concrete colors
+keys:
+    B / X / C                add / remove / recolor the block at the point the camera looks at (not with --lod)
+    right click              print the block under the cursor; until the next click B / X / C act on it instead,
+                             B adding a block on the face under the cursor)";
         return -2;
-    } else {
+    }
+
+    enum class RenderMode { kCubes, kInstanced, kMesh, kLod };
+    RenderMode render_mode    = RenderMode::kCubes;
+    bool frustum_culling      = true;
+    std::size_t upload_budget = 4096 * 1024;
+    std::filesystem::path trace_output;
+    voxel::BlockPalette palette;
+    for (int i = 2; i < argc; i++) {
+        if (std::string(argv[i]) == "--mesh") {
+            render_mode = RenderMode::kMesh;
+        } else if (std::string(argv[i]) == "--instanced") {
+            render_mode = RenderMode::kInstanced;
+        } else if (std::string(argv[i]) == "--lod") {
+            render_mode = RenderMode::kLod;
+        } else if (std::string(argv[i]) == "--no-cull") {
+            frustum_culling = false;
+        } else if (std::string(argv[i]) == "--upload-budget" && i + 1 < argc) {
+            upload_budget = std::strtoul(argv[++i], nullptr, 10) * 1024;
+        } else if (std::string(argv[i]) == "--trace" && i + 1 < argc) {
+            trace_output = argv[++i];
+        } else if (std::string(argv[i]) == "--palette" && i + 1 < argc) {
+            std::string source(argv[++i]);
+            if (source == "default") {
+                palette = voxel::BlockPalette::Default();
+            } else if (!palette.Load(source)) {
+                return -2;
+            }
+        } else {
+            std::cout << "ERROR: UNKNOWN FLAG " << argv[i] << '\n';
+            return -2;
+        }
+    }
+    // Without --trace every probe is one acquire load of a flag that stays false, a plain load on x86
+    if (!trace_output.empty()) {
+        util::TraceEnable();
+        util::TraceThreadName("render");
+    }
+
+    {
+        util::TraceScope trace_load("load");
         std::filesystem::path blocks_input(argv[1]);
         if (!std::filesystem::exists(blocks_input) || std::filesystem::is_directory(blocks_input) ||
-            blocks_input.extension() != ".XYZ") {
+            !io::IsBlockList(blocks_input)) {
             std::cout << "ERROR: WRONG FILE PATH " << blocks_input << '\n';
             return -2;
         }
-        std::ifstream file;
-        file.open(blocks_input);
-        file >> cnt;
-        blocks.resize(cnt);
-        for (int i = 0; i < cnt; i++) {
-            float x, y, z;
-            file >> x >> y >> z;
-            blocks[i] = *new figure::Cube(x, y, z);
+        std::size_t duplicates = 0;
+        if (!io::LoadBlocks(blocks_input, blocks, 0, &duplicates)) {
+            std::cout << "ERROR: CAN NOT READ " << blocks_input << '\n';
+            return -2;
+        }
+        std::cout << blocks.size() << " blocks in " << blocks.chunks().size() << " chunks, "
+                  << blocks.MemoryUsage() / 1024 << " KiB\n";
+        if (duplicates > 0) {
+            std::cout << duplicates << " repeated blocks dropped\n";
+        }
+    }
+
+    // Chunks are the unit of culling: GPU data is laid out chunk by chunk in BVH order
+    render::ChunkBvh chunk_bvh(blocks);
+    std::vector<figure::DrawRange> chunk_ranges;
+
+    // Colors of edited blocks; index 0 is the color of loaded blocks unless they come with a palette
+    voxel::MeshOptions mesh_options;
+    mesh_options.palette = {glm::vec3(0.583f, 0.771f, 0.014f), glm::vec3(0.8f, 0.2f, 0.2f),
+                            glm::vec3(0.2f, 0.4f, 0.9f), glm::vec3(0.9f, 0.9f, 0.9f)};
+    if (!palette.empty()) {
+        mesh_options.palette = palette.Colors();
+    }
+
+    // Every block shares the GL buffers of one unit cube and differs only by its translation
+    figure::Cube cube;
+    std::unique_ptr<figure::MeshModel> mesh;
+    std::unique_ptr<figure::ChunkMeshes> chunk_meshes;
+    std::unique_ptr<figure::PaletteTexture> palette_texture;
+    // Workers read the blocks while the render thread edits them
+    std::shared_mutex blocks_mutex;
+    std::unique_ptr<voxel::AsyncMesher> mesher;
+    std::deque<voxel::ChunkMeshResult> ready_meshes;
+    voxel::MeshStats mesh_stats;
+    bool mesh_reported = false;
+    std::unique_ptr<figure::CubeInstances> instances;
+    std::unique_ptr<voxel::LodOctree> lod;
+    std::unique_ptr<render::LodSelector> lod_selector;
+    if (render_mode == RenderMode::kInstanced) {
+        instances = std::make_unique<figure::CubeInstances>();
+        instances->Upload(figure::CubeInstances::Offsets(blocks, chunk_bvh.keys(), chunk_ranges));
+        // The offset is applied in the shader, so every block shares the same MVP
+        glDeleteProgram(programID);
+        programID = LoadShaders(PROJECT_DIR / "shaders/vertex shaders/InstancedVertexShader.glsl",
+                                PROJECT_DIR / "shaders/fragment shaders/ColorFragmentShader.glsl");
+    }
+    if (render_mode == RenderMode::kMesh) {
+        // One mesh per chunk, built off the render thread, so neither loading nor an edit stalls a frame.
+        // Vertices are packed into one word each; the shader finds colors in the palette texture.
+        voxel::MeshOptions packed_options = mesh_options;
+        packed_options.packed             = true;
+        chunk_meshes                      = std::make_unique<figure::ChunkMeshes>();
+        palette_texture                   = std::make_unique<figure::PaletteTexture>(mesh_options.palette);
+        mesher                            = std::make_unique<voxel::AsyncMesher>(blocks, blocks_mutex, packed_options);
+        mesher->Request(chunk_bvh.keys());
+        glDeleteProgram(programID);
+        programID = LoadShaders(PROJECT_DIR / "shaders/vertex shaders/PackedVertexShader.glsl",
+                                PROJECT_DIR / "shaders/fragment shaders/ColorFragmentShader.glsl");
+    }
+
+    if (render_mode == RenderMode::kLod) {
+        // Node ranges take the place of chunk ranges: the selected nodes are drawn instead of the visible chunks
+        auto start = std::chrono::steady_clock::now();
+        lod        = std::make_unique<voxel::LodOctree>(blocks);
+        std::chrono::duration<double> build_time = std::chrono::steady_clock::now() - start;
+        voxel::MeshStats stats;
+        std::vector<std::size_t> node_indices;
+        voxel::BlockMesh block_mesh = voxel::MeshLod(*lod, mesh_options, &node_indices, &stats);
+        mesh                        = std::make_unique<figure::MeshModel>(block_mesh);
+        for (std::size_t i = 0; i + 1 < node_indices.size(); i++) {
+            chunk_ranges.push_back({static_cast<GLint>(node_indices[i]),
+                                    static_cast<GLsizei>(node_indices[i + 1] - node_indices[i])});
         }
-        file.close();
+        lod_selector = std::make_unique<render::LodSelector>(*lod);
+        std::cout << "lod: " << lod->levels() << " levels, " << lod->nodes().size() << " nodes, "
+                  << lod->MemoryUsage() / 1024 << " KiB over the base grid, built in " << build_time.count() * 1000
+                  << " ms, meshed in " << stats.seconds * 1000 << " ms\n";
     }
+    render::LodParams lod_params;
+    lod_params.pixel_scale = static_cast<float>(viewportHeight) / (2 * std::tan(glm::radians(kCamDegrees) / 2));
 
     // Get a handle for our "MVP" uniform
     // Only during the initialisation
     GLuint MatrixID = glGetUniformLocation(programID, "MVP");
+    GLint OriginID  = glGetUniformLocation(programID, "ChunkOrigin");
+    GLint PaletteID = glGetUniformLocation(programID, "Palette");
 
     glfwGetCursorPos(window, &mouse_position_x_end, &mouse_position_y_end);
     glfwSetKeyCallback(window, key_callback);
 
+    voxel::BlockEditor editor(blocks);
+    std::uint16_t edit_color = 1;
+    bool edit_keys_down[3]   = {false, false, false};
+
+    // Picking walks the grid with a DDA from the cursor, skipping missing chunks
+    voxel::Raycaster raycaster(blocks);
+    voxel::Ray pick_ray;
+    voxel::RayHit pick;
+    bool picking         = false;
+    bool pick_click_down = false;
+
+    std::vector<std::uint32_t> visible_chunks;
+    std::vector<figure::DrawRange> draw_ranges;
+    render::CullStats cull_stats;
+    int cull_frames     = 0;
+    double stats_second = glfwGetTime();
+    double mesh_start   = glfwGetTime();
+    render::GpuTimer gpu_draw_timer("gpu_draw_ms");
+
     // Check if the ESC key was pressed or the window was closed
     while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS && glfwWindowShouldClose(window) == 0) {
-        glfwPollEvents();
+        util::TraceFrame();
+        {
+            util::TraceScope trace_poll("poll_events");
+            glfwPollEvents();
+        }
 
         front = camera_center - vec4to3(camera_position);
         side  = vectorMultiply(front, head);
@@ -265,29 +446,221 @@ usage:
             camera_position -= glm::normalize(head) / 10.0f;
             camera_center -= vec4to3(glm::normalize(head)) / 10.0f;
         }
+
         glm::mat4 view = glm::lookAt(vec4to3(camera_position),  // Камера находится в мировых
                                                                 // координатах (4,3,3)
                                      camera_center,  // И направлена в начало координат
                                      vec4to3(head)   // "Голова" находится сверху
         );
 
+        const bool pick_click = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
+        if (pick_click && !pick_click_down) {
+            util::TraceScope trace_pick("pick");
+            glm::ivec2 window_size;
+            glfwGetWindowSize(window, &window_size.x, &window_size.y);
+            pick_ray = voxel::CursorRay(glm::dvec2(mouse_position_x_end, mouse_position_y_end), window_size,
+                                        projection_matrix, view);
+            picking  = true;
+            voxel::RaycastStats pick_stats;
+            auto start = std::chrono::steady_clock::now();
+            if (raycaster.Cast(pick_ray, kPickDistance, pick, &pick_stats)) {
+                std::cout << "pick: block " << pick.cell.x << ' ' << pick.cell.y << ' ' << pick.cell.z << ", color "
+                          << pick.color;
+                if (pick.color < palette.blocks().size()) {
+                    std::cout << " (" << palette.blocks()[pick.color].name << ')';
+                }
+                std::cout << ", face " << pick.normal.x << ' ' << pick.normal.y << ' ' << pick.normal.z << " at "
+                          << pick.distance;
+            } else {
+                std::cout << "pick: no block under the cursor";
+            }
+            std::chrono::duration<double> pick_time = std::chrono::steady_clock::now() - start;
+            std::cout << "; " << pick_stats.cells << " cells in " << pick_stats.chunks_walked << " chunks, "
+                      << pick_stats.chunks_skipped << " empty chunks skipped in " << pick_time.count() * 1e6
+                      << " us\n";
+        }
+        pick_click_down = pick_click;
+
+        // Edits act once per key press on the picked block, or else on the cell under the point the camera
+        // looks at
+        const int edit_keys[3] = {GLFW_KEY_B, GLFW_KEY_X, GLFW_KEY_C};
+        const bool on_pick     = picking && pick.hit;
+        const glm::ivec3 target(on_pick ? pick.cell : glm::ivec3(glm::round(camera_center)));
+        const glm::ivec3 add_target(on_pick ? pick.cell + pick.normal : target);
+        std::unique_lock<std::shared_mutex> blocks_lock(blocks_mutex, std::defer_lock);
+        for (int i = 0; i < 3; i++) {
+            bool down = glfwGetKey(window, edit_keys[i]) == GLFW_PRESS;
+            if (!down || edit_keys_down[i]) {
+                edit_keys_down[i] = down;
+                continue;
+            }
+            edit_keys_down[i] = true;
+            if (lod) {
+                std::cout << "edit: blocks can not be edited with --lod\n";
+                continue;
+            }
+            blocks_lock.lock();
+            if (i == 0) {
+                editor.Add(add_target, edit_color);
+            } else if (i == 1) {
+                editor.Remove(target);
+            } else {
+                const std::size_t edit_colors = std::max<std::size_t>(mesh_options.palette.size() - 1, 1);
+                edit_color                    = static_cast<std::uint16_t>(edit_color % edit_colors + 1);
+                editor.Recolor(target, edit_color);
+            }
+            blocks_lock.unlock();
+        }
+        if (editor.dirty()) {
+            util::TraceScope trace_edit("edit");
+            auto start                         = std::chrono::steady_clock::now();
+            std::vector<glm::ivec3> dirty_keys = editor.TakeDirtyChunks();
+            chunk_bvh.Update(blocks, dirty_keys);
+            // The picked block may be gone or covered now: pick again along the same ray
+            raycaster.Update();
+            if (picking) {
+                raycaster.Cast(pick_ray, kPickDistance, pick);
+            }
+            if (mesher) {
+                mesher->Request(dirty_keys);
+            }
+            if (instances) {
+                // Instances are laid out in chunk order, so the offsets after the edit all move
+                instances->Upload(figure::CubeInstances::Offsets(blocks, chunk_bvh.keys(), chunk_ranges));
+            }
+            std::chrono::duration<double> edit_time = std::chrono::steady_clock::now() - start;
+            std::cout << "edit: " << dirty_keys.size() << " chunks queued in " << edit_time.count() * 1000
+                      << " ms\n";
+        }
+
+        // Upload finished meshes up to the byte budget, but at least one per frame so large meshes still land
+        if (mesher) {
+            util::TraceScope trace_upload("upload");
+            mesher->Poll(ready_meshes);
+            std::size_t uploaded = 0;
+            while (!ready_meshes.empty()) {
+                const voxel::ChunkMeshResult &result = ready_meshes.front();
+                if (mesher->Current(result)) {
+                    std::size_t size = figure::ChunkMeshes::UploadSize(result.mesh);
+                    if (uploaded != 0 && uploaded + size > upload_budget) {
+                        break;
+                    }
+                    uploaded += chunk_meshes->Upload(result.key, result.mesh);
+                    mesh_stats.blocks += result.stats.blocks;
+                    mesh_stats.visible_faces += result.stats.visible_faces;
+                    mesh_stats.quads += result.stats.quads;
+                }
+                ready_meshes.pop_front();
+            }
+            util::TraceCounter("upload_bytes", static_cast<double>(uploaded));
+            util::TraceCounter("meshes_pending", static_cast<double>(mesher->in_flight() + ready_meshes.size()));
+            if (!mesh_reported && mesher->in_flight() == 0 && ready_meshes.empty()) {
+                std::cout << "mesh: " << mesh_stats.visible_faces << " visible faces merged into " << mesh_stats.quads
+                          << " quads in " << chunk_meshes->size() << " chunk meshes, built and uploaded in "
+                          << (glfwGetTime() - mesh_start) * 1000 << " ms\n";
+                for (const render::ArenaStats &arena : {chunk_meshes->vertex_stats(), chunk_meshes->index_stats()}) {
+                    std::cout << "arena: " << arena.used / 1024 << " of " << arena.capacity / 1024 << " KiB in "
+                              << arena.allocations << " ranges, " << arena.free_ranges << " free ranges, "
+                              << arena.Fragmentation() * 100 << "% fragmented, " << arena.relocations
+                              << " relocations\n";
+                }
+                mesh_reported = true;
+            }
+        }
+
         // Clear the screen. It's not mentioned before Tutorial 02, but it can
         // cause flickering, so it's there nonetheless.
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         glm::mat4 MVP = projection_matrix * view;
-        for (int i = 0; i < cnt; i++) {
-            glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &(MVP * blocks[i].model())[0][0]);
+
+        // A default frustum has no planes and keeps everything
+        render::Frustum frustum = frustum_culling ? render::Frustum(MVP) : render::Frustum();
+        {
+            util::TraceScope trace_cull("cull");
+            if (lod_selector) {
+                lod_selector->Select(frustum, vec4to3(camera_position), lod_params, visible_chunks, &cull_stats);
+                std::sort(visible_chunks.begin(), visible_chunks.end());
+            } else {
+                chunk_bvh.Cull(frustum, visible_chunks, &cull_stats);
+            }
+        }
+        util::TraceCounter("visible_chunks", static_cast<double>(visible_chunks.size()));
+        // Visible ids are increasing, so neighbouring chunks merge into one draw call
+        draw_ranges.clear();
+        for (std::uint32_t chunk : visible_chunks) {
+            if (chunk_ranges.empty()) {
+                break;
+            }
+            const figure::DrawRange &range = chunk_ranges[chunk];
+            if (!draw_ranges.empty() && draw_ranges.back().first + draw_ranges.back().count == range.first) {
+                draw_ranges.back().count += range.count;
+            } else {
+                draw_ranges.push_back(range);
+            }
+        }
+
+        {
+            util::TraceScope trace_draw("draw");
+            gpu_draw_timer.Begin();
             // Use our shader
             glUseProgram(programID);
-            // Draw cube...
-            blocks[i].Draw();
+            if (instances) {
+                glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
+                instances->Draw(draw_ranges);
+            } else if (mesh) {
+                glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
+                mesh->Draw(draw_ranges);
+            } else if (chunk_meshes) {
+                glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
+                palette_texture->Bind(0);
+                glUniform1i(PaletteID, 0);
+                chunk_meshes->Draw(visible_chunks, chunk_bvh.keys(), OriginID);
+            } else {
+                for (std::uint32_t chunk : visible_chunks) {
+                    const glm::ivec3 &key = chunk_bvh.keys()[chunk];
+                    auto draw_cube        = [&](const glm::ivec3 &cell, std::uint16_t) {
+                        glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &glm::translate(MVP, glm::vec3(cell))[0][0]);
+                        // Draw cube...
+                        cube.Draw();
+                    };
+                    voxel::VoxelGrid::ForEachInChunk(key, *blocks.FindChunk(key), draw_cube);
+                }
+            }
+            gpu_draw_timer.End();
+        }
+
+        // Culling cost and result, averaged over about a second
+        cull_frames++;
+        if (glfwGetTime() - stats_second >= 1.0) {
+            std::string title = "3D2MC | cull " + std::to_string(cull_stats.seconds * 1e6 / cull_frames) +
+                                " us/frame | " + std::to_string(cull_stats.chunks_visible / cull_frames) + "/" +
+                                std::to_string(lod ? lod->nodes().size() : chunk_bvh.size()) + " chunks | " +
+                                std::to_string(cull_stats.blocks_visible / cull_frames) + " blocks";
+            if (mesher) {
+                title += " | " + std::to_string(mesher->in_flight() + ready_meshes.size()) + " meshes pending";
+            }
+            glfwSetWindowTitle(window, title.c_str());
+            cull_stats   = render::CullStats();
+            cull_frames  = 0;
+            stats_second = glfwGetTime();
         }
 
         // Swap buffers
+        util::TraceScope trace_swap("swap");
         glfwSwapBuffers(window);
     }
 
+    if (!trace_output.empty()) {
+        // The workers must be idle before their trace buffers are read
+        mesher.reset();
+        std::filesystem::path frames_output = trace_output;
+        frames_output.replace_extension(".csv");
+        if (util::WriteChromeTrace(trace_output) && util::WriteFrameCsv(frames_output)) {
+            std::cout << "trace written to " << trace_output.string() << " and " << frames_output.string() << '\n';
+        }
+    }
+
     // Close OpenGL window and terminate GLFW
     glfwTerminate();
 
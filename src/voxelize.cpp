@@ -0,0 +1,173 @@
+// Include standard headers
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "io/xyz.h"
+#include "voxel/block_palette.h"
+#include "voxel/hollow.h"
+#include "voxelizer/mesh.h"
+#include "voxelizer/mesh_cache.h"
+#include "voxelizer/streaming.h"
+#include "voxelizer/voxelizer.h"
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cout <<
+            R"(ERROR: Missing arguments
+usage:
+    voxelize path\to\model.obj path\to\file.XYZ [--size block_size] [--threads count] [--memory MiB [--scratch dir]]
+             [--palette default|path\to\palette.txt [--dither amount]] [--solid] [--hollow thickness] [--cache]
+        --memory     stream the model from disk through slab files, using about this much working memory
+        --scratch    directory for the temporary slab files, next to the output by default
+        --palette    color blocks from vertex or material colors with the nearest block of a palette of
+                     "name r g b" lines, or of the sixteen concrete colors
+        --dither     ordered dither amplitude in RGB units (0..1), 0 by default
+        --solid      fill the interior of the model as well, not only its surface
+        --hollow     keep only the blocks within this distance of the outside, a wall of the given thickness;
+                     implies --solid, since every block of a surface is already that close
+        --cache      keep the parsed model and its BVH in model.obj.bvh and read them from there while the model
+                     and its .mtl files are unchanged, so that voxelizing it again at another size skips parsing)";
+        return -2;
+    }
+
+    std::filesystem::path model_input(argv[1]);
+    std::filesystem::path blocks_output(argv[2]);
+    voxel::VoxelizeOptions options;
+    voxel::StreamingOptions streaming;
+    voxel::BlockPalette palette;
+    voxel::HollowOptions hollow;
+    bool hollowed = false;
+    bool stream   = false;
+    bool cache    = false;
+    for (int i = 3; i < argc; i += 2) {
+        std::string flag(argv[i]);
+        if (flag == "--solid") {
+            options.solid = true;
+            i--;
+        } else if (flag == "--cache") {
+            cache = true;
+            i--;
+        } else if (i + 1 == argc) {
+            std::cout << "ERROR: MISSING VALUE OF " << flag << '\n';
+            return -2;
+        } else if (flag == "--size") {
+            options.block_size = std::stof(argv[i + 1]);
+        } else if (flag == "--threads") {
+            options.threads = static_cast<unsigned>(std::stoul(argv[i + 1]));
+        } else if (flag == "--memory") {
+            streaming.memory_budget = static_cast<std::size_t>(std::stoull(argv[i + 1])) << 20;
+            stream                  = true;
+        } else if (flag == "--hollow") {
+            hollow.thickness = std::stoi(argv[i + 1]);
+            hollowed         = true;
+        } else if (flag == "--scratch") {
+            streaming.scratch = argv[i + 1];
+        } else if (flag == "--palette") {
+            if (std::string(argv[i + 1]) == "default") {
+                palette.Assign(voxel::BlockPalette::Default().blocks());
+            } else if (!palette.Load(argv[i + 1])) {
+                return -1;
+            }
+            options.palette = &palette;
+        } else if (flag == "--dither") {
+            palette.set_dither(std::stof(argv[i + 1]));
+        } else {
+            std::cout << "ERROR: UNKNOWN FLAG " << flag << '\n';
+            return -2;
+        }
+    }
+    if (blocks_output.extension() != ".XYZ") {
+        std::cout << "ERROR: WRONG FILE PATH " << blocks_output << '\n';
+        return -2;
+    }
+    if (hollowed && hollow.thickness < 1) {
+        std::cout << "ERROR: WRONG WALL THICKNESS " << hollow.thickness << '\n';
+        return -2;
+    }
+    if (stream && (options.palette != nullptr || options.solid || hollowed || cache)) {
+        std::cout << "ERROR: --palette, --solid, --hollow AND --cache CAN NOT BE USED WITH --memory\n";
+        return -2;
+    }
+    // A wall is carved out of the filled model
+    options.solid = options.solid || hollowed;
+
+    auto start = std::chrono::steady_clock::now();
+    if (stream) {
+        streaming.voxelize = options;
+        voxel::StreamingStats stats;
+        if (!voxel::VoxelizeObjStreaming(model_input, blocks_output, streaming, &stats)) {
+            return -1;
+        }
+        std::cout << stats.triangles << " triangles -> " << stats.blocks << " blocks\n"
+                  << stats.slabs << " slabs, largest " << stats.largest_slab << " triangles\n"
+                  << "total:    " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                  << " s\n";
+        return 0;
+    }
+
+    voxel::Mesh mesh;
+    voxel::TriangleBvh bvh;
+    const bool cached = cache && voxel::ReadMeshCache(model_input, mesh, bvh);
+    if (!cached && !voxel::LoadObj(model_input, mesh, options.threads)) {
+        return -1;
+    }
+    auto loaded = std::chrono::steady_clock::now();
+    if (cache && !cached) {
+        bvh.Build(mesh, options.threads);
+        if (voxel::WriteMeshCache(model_input, mesh, bvh)) {
+            std::cout << "BVH of " << bvh.nodes().size() << " nodes cached in " << voxel::MeshCachePath(model_input)
+                      << '\n';
+        }
+    } else if (cached) {
+        std::cout << "model and BVH read from " << voxel::MeshCachePath(model_input) << '\n';
+    }
+    if (cache) {
+        options.bvh = &bvh;
+    }
+    auto built = std::chrono::steady_clock::now();
+    std::vector<std::uint16_t> colors;
+    std::vector<glm::ivec3> blocks = voxel::Voxelize(mesh, options, &colors);
+    auto voxelized = std::chrono::steady_clock::now();
+    if (hollowed) {
+        voxel::VoxelGrid grid;
+        for (std::size_t i = 0; i < blocks.size(); i++) {
+            grid.Set(blocks[i], colors.empty() ? 0 : colors[i]);
+        }
+        hollow.threads = options.threads;
+        voxel::HollowStats stats;
+        voxel::VoxelGrid shell = voxel::Hollow(grid, hollow, &stats);
+        blocks.clear();
+        std::vector<std::uint16_t> shell_colors;
+        shell.ForEach([&](const glm::ivec3& cell, std::uint16_t color) {
+            blocks.push_back(cell);
+            shell_colors.push_back(color);
+        });
+        if (!colors.empty()) {
+            colors = std::move(shell_colors);
+        }
+        std::cout << stats.kept << " blocks kept in the walls, " << stats.removed << " removed\n";
+    }
+    auto hollowed_at = std::chrono::steady_clock::now();
+    if (options.palette != nullptr && !mesh.HasColors()) {
+        std::cout << "model has no vertex or material colors, blocks are left uncolored\n";
+    }
+    if (!io::WriteXYZ(blocks_output, blocks, colors)) {
+        return -1;
+    }
+    auto written = std::chrono::steady_clock::now();
+
+    using std::chrono::duration;
+    std::cout << mesh.triangles.size() << " triangles -> " << blocks.size() << " blocks\n"
+              << "load:     " << duration<double>(loaded - start).count() << " s\n";
+    if (cache && !cached) {
+        std::cout << "bvh:      " << duration<double>(built - loaded).count() << " s\n";
+    }
+    std::cout << "voxelize: " << duration<double>(voxelized - built).count() << " s\n";
+    if (hollowed) {
+        std::cout << "hollow:   " << duration<double>(hollowed_at - voxelized).count() << " s\n";
+    }
+    std::cout << "write:    " << duration<double>(written - hollowed_at).count() << " s\n";
+    return 0;
+}
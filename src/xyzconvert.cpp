@@ -0,0 +1,102 @@
+// Include standard headers
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "io/block_file.h"
+#include "io/blocks.h"
+#include "io/xyz.h"
+#include "schematic/sponge_schematic.h"
+#include "voxel/block_palette.h"
+#include "voxel/morton.h"
+
+// Converts between .XYZ text block lists and .XYZB binary block files, picking the direction from the extensions,
+// and exports either of them as a Sponge .schem schematic
+int main(int argc, char **argv) {
+    if (argc != 3 && argc != 5) {
+        std::cout <<
+            R"(ERROR: Missing arguments
+usage:
+    xyzconvert path\to\file.XYZ path\to\file.XYZB
+    xyzconvert path\to\file.XYZB path\to\file.XYZ
+    xyzconvert path\to\file.XYZ[B] path\to\file.schem [--palette default|path\to\palette.txt]
+        --palette    block names of the palette indices of a colored .XYZ file, the sixteen concrete
+                     colors by default; uncolored blocks are the first block of the palette
+)";
+        return -2;
+    }
+
+    std::filesystem::path input(argv[1]);
+    std::filesystem::path output(argv[2]);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<glm::ivec3> blocks;
+
+    if (output.extension() == ".schem") {
+        voxel::BlockPalette palette = voxel::BlockPalette::Default();
+        if (argc == 5) {
+            if (std::string(argv[3]) != "--palette") {
+                std::cout << "ERROR: UNKNOWN FLAG " << argv[3] << '\n';
+                return -2;
+            }
+            if (std::string(argv[4]) != "default" && !palette.Load(argv[4])) {
+                return -1;
+            }
+        }
+        voxel::VoxelGrid grid;
+        if (!io::IsBlockList(input) || !io::LoadBlocks(input, grid)) {
+            std::cout << "ERROR: CAN NOT READ " << input << '\n';
+            return -1;
+        }
+        auto loaded = std::chrono::steady_clock::now();
+        schematic::SchematicStats stats;
+        if (!schematic::WriteSpongeSchematic(grid, palette, output, schematic::SchematicOptions(), &stats)) {
+            return -1;
+        }
+        using std::chrono::duration;
+        std::cout << grid.size() << " blocks in " << stats.size.x << "x" << stats.size.y << "x" << stats.size.z
+                  << ", " << stats.palette << " palette entries, " << stats.block_data_bytes / 1024 << " KiB -> "
+                  << stats.file_bytes / 1024 << " KiB\n"
+                  << "load:  " << duration<double>(loaded - start).count() << " s\n"
+                  << "write: " << duration<double>(std::chrono::steady_clock::now() - loaded).count() << " s\n";
+        return 0;
+    }
+    if (argc != 3) {
+        std::cout << "ERROR: --palette IS ONLY USED FOR .schem OUTPUT\n";
+        return -2;
+    }
+
+    if (input.extension() == ".XYZ" && output.extension() == io::kBlockFileExtension) {
+        if (!io::ReadXYZ(input, blocks)) {
+            return -1;
+        }
+        // Binary files are written in Morton order, without repeated blocks
+        const std::size_t duplicates = voxel::SortMorton(blocks);
+        if (!io::WriteBlockFile(output, blocks)) {
+            return -1;
+        }
+        if (duplicates > 0) {
+            std::cout << duplicates << " repeated blocks dropped\n";
+        }
+    } else if (input.extension() == io::kBlockFileExtension && output.extension() == ".XYZ") {
+        io::BlockFile file;
+        if (!file.Open(input)) {
+            return -1;
+        }
+        blocks.reserve(file.size());
+        for (std::size_t i = 0; i < file.size(); i++) {
+            blocks.push_back(file[i]);
+        }
+        if (!io::WriteXYZ(output, blocks)) {
+            return -1;
+        }
+    } else {
+        std::cout << "ERROR: WRONG FILE PATH " << input << " -> " << output << '\n';
+        return -2;
+    }
+
+    std::cout << blocks.size() << " blocks converted in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s\n";
+    return 0;
+}